@@ -0,0 +1,209 @@
+/**************************************************************************//**
+ *
+ * @file		Amplifier.c
+ * @brief		LM4811 audio amplifier on the base board
+ * @version		1.0
+ *
+ * The amplifier has no way to read its gain back, so the task homes it by
+ * clocking it all the way down before the first change and after every
+ * shutdown. After a shutdown it homes and restores the gain straight away,
+ * with the amplifier still shut down, so the next sound never hears the
+ * gain move. Clock edges are spaced by task delays rather than busy waits.
+ *
+******************************************************************************/
+
+// Includes
+#include "LPC17xx_GPIO.h"
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Queue.h"
+#include "FreeRTOS_Semaphore.h"
+
+#include "Amplifier.h"
+#include "WavPlayer.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define AMPLIFIER_CLK_PORT		0
+#define AMPLIFIER_CLK_PIN		(1<<27)
+#define AMPLIFIER_UPDN_PORT		0
+#define AMPLIFIER_UPDN_PIN		(1<<28)
+#define AMPLIFIER_SHDN_PORT		2
+#define AMPLIFIER_SHDN_PIN		(1<<13)						// High = shut down
+
+#define AMPLIFIER_DEFAULT_GAIN	11							// 0 dB, the steps are 3 dB apart
+#define AMPLIFIER_UNKNOWN		0xFF						// Gain not known until homed
+#define AMPLIFIER_EDGE_TICKS	1							// Ticks between clock edges
+#define AMPLIFIER_POLL_TICKS	(100 / portTICK_RATE_MS)	// How often the output is checked for silence
+#define AMPLIFIER_IDLE_TICKS	(2000 / portTICK_RATE_MS)	// Silence before the amplifier is shut down
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static xSemaphoreHandle WakeSemaphore = 0;				// Wakes the task for a gain change
+static volatile uint8_t Target = AMPLIFIER_DEFAULT_GAIN;	// Gain asked for
+static uint8_t Position = AMPLIFIER_UNKNOWN;			// Gain the amplifier is at, only moved by the task
+static volatile uint8_t Shutdown = 0;
+static volatile uint8_t Homing = 0;						// Shut down with the gain being restored
+static volatile uint8_t WakePending = 0;				// Woken while homing, released once the gain is back
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// One gain step up or down
+static void Amplifier_Step(uint8_t Up)
+{
+	if (Up)
+		GPIO_SetValue(AMPLIFIER_UPDN_PORT, AMPLIFIER_UPDN_PIN);
+	else
+		GPIO_ClearValue(AMPLIFIER_UPDN_PORT, AMPLIFIER_UPDN_PIN);
+	vTaskDelay(AMPLIFIER_EDGE_TICKS);
+
+	// The gain moves on the rising edge
+	GPIO_SetValue(AMPLIFIER_CLK_PORT, AMPLIFIER_CLK_PIN);
+	vTaskDelay(AMPLIFIER_EDGE_TICKS);
+	GPIO_ClearValue(AMPLIFIER_CLK_PORT, AMPLIFIER_CLK_PIN);
+}
+
+// Walk the gain towards Target, starting from the bottom if it is not known
+static void Amplifier_Track(void)
+{
+	uint8_t i;
+
+	if (Position == AMPLIFIER_UNKNOWN)
+	{
+		for (i = 0; i < AMPLIFIER_STEPS; ++i)
+			Amplifier_Step(0);
+		Position = 0;
+	}
+
+	while (Position != Target)
+	{
+		if (Position < Target)
+		{
+			Amplifier_Step(1);
+			++Position;
+		}
+		else
+		{
+			Amplifier_Step(0);
+			--Position;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Amplifier_Init(void)
+{
+	GPIO_SetDir(AMPLIFIER_CLK_PORT, AMPLIFIER_CLK_PIN, 1);
+	GPIO_SetDir(AMPLIFIER_UPDN_PORT, AMPLIFIER_UPDN_PIN, 1);
+	GPIO_SetDir(AMPLIFIER_SHDN_PORT, AMPLIFIER_SHDN_PIN, 1);
+
+	GPIO_ClearValue(AMPLIFIER_CLK_PORT, AMPLIFIER_CLK_PIN);
+	GPIO_ClearValue(AMPLIFIER_UPDN_PORT, AMPLIFIER_UPDN_PIN);
+	GPIO_ClearValue(AMPLIFIER_SHDN_PORT, AMPLIFIER_SHDN_PIN);
+
+	vSemaphoreCreateBinary(WakeSemaphore);
+	xSemaphoreTake(WakeSemaphore, 0);
+}
+
+// Ask for a new gain step; the task moves the amplifier there in the background
+void Amplifier_SetGain(uint8_t Step)
+{
+	if (Step >= AMPLIFIER_STEPS)
+		Step = AMPLIFIER_STEPS - 1;
+	Target = Step;
+	xSemaphoreGive(WakeSemaphore);
+}
+
+uint8_t Amplifier_GetGain(void)
+{
+	return Target;
+}
+
+// Bring the amplifier out of shutdown. Only writes the pin, so it is safe from
+// interrupts and never holds up the sample path. Within the few tens of ms
+// after a shutdown while the task restores the gain, the task releases it instead.
+void Amplifier_Wake(void)
+{
+	if (Shutdown)
+	{
+		if (Homing)
+		{
+			WakePending = 1;
+		}
+		else
+		{
+			GPIO_ClearValue(AMPLIFIER_SHDN_PORT, AMPLIFIER_SHDN_PIN);
+			Shutdown = 0;
+		}
+	}
+}
+
+uint8_t Amplifier_IsShutdown(void)
+{
+	return Shutdown;
+}
+
+/******************************************************************************
+ * Description:	Low priority amplifier task. Steps the gain to the level
+ *				asked for and shuts the amplifier down once the output has
+ *				been silent for a while.
+ *****************************************************************************/
+void Amplifier_Task(void *pvParameters)
+{
+	portTickType LastAudible;
+
+	(void)pvParameters;
+
+	LastAudible = xTaskGetTickCount();
+
+	for(;;)
+	{
+		xSemaphoreTake(WakeSemaphore, AMPLIFIER_POLL_TICKS);
+
+		if (WavPlayer_IsAudible())
+		{
+			LastAudible = xTaskGetTickCount();
+			Amplifier_Wake();
+		}
+		else if ((Shutdown == 0) && ((xTaskGetTickCount() - LastAudible) >= AMPLIFIER_IDLE_TICKS))
+		{
+			// Checked again with interrupts off, so a sound starting now is not cut off
+			taskENTER_CRITICAL();
+				if (WavPlayer_IsAudible() == 0)
+				{
+					GPIO_SetValue(AMPLIFIER_SHDN_PORT, AMPLIFIER_SHDN_PIN);
+					Shutdown = 1;
+					Homing = 1;
+				}
+			taskEXIT_CRITICAL();
+
+			// The gain is not guaranteed to survive a shutdown: home it now, while
+			// the output is off, rather than under the next sound
+			if (Homing)
+			{
+				Position = AMPLIFIER_UNKNOWN;
+				Amplifier_Track();
+
+				taskENTER_CRITICAL();
+					Homing = 0;
+					if (WakePending)
+					{
+						WakePending = 0;
+						GPIO_ClearValue(AMPLIFIER_SHDN_PORT, AMPLIFIER_SHDN_PIN);
+						Shutdown = 0;
+					}
+				taskEXIT_CRITICAL();
+			}
+		}
+
+		// Gain changes asked for while shut down are made there too
+		Amplifier_Track();
+	}
+}
@@ -0,0 +1,34 @@
+/**************************************************************************//**
+ *
+ * @file		Amplifier.h
+ * @brief		Header file for the LM4811 audio amplifier on the base board
+ * @version		1.0
+ *
+ * The LM4811 has a 16 step digital gain, moved one step per clock edge in the
+ * direction set by UP/DN, and an active high shutdown pin. The gain is only
+ * ever changed by Amplifier_Task, so callers never wait on the clock pulses.
+ *
+******************************************************************************/
+
+#ifndef AMPLIFIER_H
+#define AMPLIFIER_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define AMPLIFIER_STEPS			16			// Gain steps, 0 (quietest) to AMPLIFIER_STEPS - 1
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Amplifier_Init(void);
+void Amplifier_SetGain(uint8_t Step);
+uint8_t Amplifier_GetGain(void);
+void Amplifier_Wake(void);
+uint8_t Amplifier_IsShutdown(void);
+void Amplifier_Task(void *pvParameters);
+
+#endif // AMPLIFIER_H
@@ -0,0 +1,150 @@
+/**************************************************************************//**
+ *
+ * @file		AudioMixer.c
+ * @brief		Block-wise software mixer used by WavPlayer
+ * @version		1.0
+ *
+ * Work is done voice by voice over a whole block, so the per-sample cost is a
+ * multiply-accumulate plus the interpolation; the sum is saturated once at the
+ * end instead of wrapping when several loud voices line up.
+ *
+******************************************************************************/
+
+// Includes
+#include "AudioMixer.h"
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Move the voice on by one source sample, returning 0 once its source has ended
+static uint8_t AudioMixer_Advance(AudioMixer_Voice_t *Voice)
+{
+	if (Voice->Index == Voice->Count)
+	{
+		Voice->Count = (uint8_t)Voice->Fill(Voice->Context, Voice->Buffer, AUDIOMIXER_VOICE_BUFFER);
+		Voice->Index = 0;
+		// Chain straight on to the next source, keeping the phase so there is no gap
+		if ((Voice->Count == 0) && (Voice->Next != 0) && Voice->Next(Voice->Context, &Voice->Rate))
+			Voice->Count = (uint8_t)Voice->Fill(Voice->Context, Voice->Buffer, AUDIOMIXER_VOICE_BUFFER);
+		if (Voice->Count == 0)
+			return 0;
+	}
+
+	Voice->Previous = Voice->Current;
+	Voice->Current = Voice->Buffer[Voice->Index++];
+	return 1;
+}
+
+// Add Count resampled samples of one voice into the accumulator
+static void AudioMixer_AddVoice(AudioMixer_t *Mixer, AudioMixer_Voice_t *Voice, uint32_t Count)
+{
+	int32_t Sample;
+	uint32_t Fraction;
+	uint32_t i;
+
+	for (i = 0; i < Count; ++i)
+	{
+		// Phase counts in output-rate units, so the long-run rate is exact
+		while (Voice->Phase >= Mixer->Rate)
+		{
+			Voice->Phase -= Mixer->Rate;
+			if (!AudioMixer_Advance(Voice))
+			{
+				Voice->Active = 0;
+				return;
+			}
+		}
+
+		Fraction = (Voice->Phase * Mixer->Reciprocal) >> 16;
+		Sample = Voice->Previous + ((((int32_t)Voice->Current - Voice->Previous) * (int32_t)Fraction) >> 8);
+		Mixer->Accumulator[i] += (int16_t)(((Sample - 128) * (int32_t)Voice->Gain) >> 8);
+
+		Voice->Phase += Voice->Rate;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void AudioMixer_Init(AudioMixer_t *Mixer, uint32_t Rate)
+{
+	uint8_t i;
+
+	for (i = 0; i < AUDIOMIXER_VOICES; ++i)
+		Mixer->Voices[i].Active = 0;
+	Mixer->Rate = Rate;
+	Mixer->Reciprocal = (1UL << 24) / Rate;
+}
+
+// Start a voice, replacing whatever it was playing
+void AudioMixer_Start(AudioMixer_t *Mixer, uint8_t Voice, AudioMixer_Fill_t Fill, void *Context, uint32_t Rate, uint16_t Gain)
+{
+	AudioMixer_Voice_t *New = &Mixer->Voices[Voice];
+
+	New->Fill = Fill;
+	New->Next = 0;
+	New->Context = Context;
+	New->Rate = Rate;
+	New->Gain = (Gain > AUDIOMIXER_MAX_GAIN) ? AUDIOMIXER_MAX_GAIN : Gain;
+	New->Index = 0;
+	New->Count = 0;
+	New->Current = 128;
+	// Two source samples are taken before the first output, filling Previous and Current
+	New->Phase = 2 * Mixer->Rate;
+	New->Active = 1;
+}
+
+// Give a started voice a source to chain on to when it ends
+void AudioMixer_SetNext(AudioMixer_t *Mixer, uint8_t Voice, AudioMixer_Next_t Next)
+{
+	Mixer->Voices[Voice].Next = Next;
+}
+
+void AudioMixer_Stop(AudioMixer_t *Mixer, uint8_t Voice)
+{
+	Mixer->Voices[Voice].Active = 0;
+}
+
+void AudioMixer_SetGain(AudioMixer_t *Mixer, uint8_t Voice, uint16_t Gain)
+{
+	Mixer->Voices[Voice].Gain = (Gain > AUDIOMIXER_MAX_GAIN) ? AUDIOMIXER_MAX_GAIN : Gain;
+}
+
+uint8_t AudioMixer_ActiveVoices(const AudioMixer_t *Mixer)
+{
+	uint8_t Active = 0;
+	uint8_t i;
+
+	for (i = 0; i < AUDIOMIXER_VOICES; ++i)
+		Active += Mixer->Voices[i].Active;
+	return Active;
+}
+
+// Mix Count (at most AUDIOMIXER_BLOCK) samples of every active voice, silence if there are none
+void AudioMixer_Mix(AudioMixer_t *Mixer, uint8_t *Samples, uint32_t Count)
+{
+	int32_t Sum;
+	uint32_t i;
+	uint8_t v;
+
+	for (i = 0; i < Count; ++i)
+		Mixer->Accumulator[i] = 0;
+
+	for (v = 0; v < AUDIOMIXER_VOICES; ++v)
+	{
+		if (Mixer->Voices[v].Active)
+			AudioMixer_AddVoice(Mixer, &Mixer->Voices[v], Count);
+	}
+
+	// Saturate back to unsigned 8-bit
+	for (i = 0; i < Count; ++i)
+	{
+		Sum = Mixer->Accumulator[i] + 128;
+		if (Sum < 0)
+			Sum = 0;
+		else if (Sum > 255)
+			Sum = 255;
+		Samples[i] = (uint8_t)Sum;
+	}
+}
@@ -0,0 +1,68 @@
+/**************************************************************************//**
+ *
+ * @file		AudioMixer.h
+ * @brief		Header file for the block-wise software mixer used by WavPlayer
+ * @version		1.0
+ *
+ * Mixes up to AUDIOMIXER_VOICES sources into one unsigned 8-bit stream at a
+ * fixed output rate. Each voice pulls its samples through a fill callback at
+ * its own rate and is resampled (linear interpolation) to the output rate.
+ * Only the audio task calls into the mixer, so it needs no locking.
+ *
+******************************************************************************/
+
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define AUDIOMIXER_VOICES		4				// Voices mixed at once
+#define AUDIOMIXER_BLOCK		64				// Most samples mixed per call
+#define AUDIOMIXER_VOICE_BUFFER	32				// Source samples fetched per fill callback
+#define AUDIOMIXER_UNITY		256				// Gain that leaves a voice unchanged
+#define AUDIOMIXER_MAX_GAIN		(4 * AUDIOMIXER_UNITY)	// Every voice at full scale still fits the accumulator
+
+// Fill Samples with up to Count unsigned 8-bit samples, returning fewer only once the source has ended
+typedef uint32_t (*AudioMixer_Fill_t)(void *Context, uint8_t *Samples, uint32_t Count);
+
+// Called when the source has ended: return 1 (with the new source Rate) to carry straight on
+typedef uint8_t (*AudioMixer_Next_t)(void *Context, uint32_t *Rate);
+
+typedef struct {
+	AudioMixer_Fill_t Fill;
+	AudioMixer_Next_t Next;			// Optional, 0 if the voice just stops at the end
+	void *Context;
+	uint32_t Rate;					// Source samples per second
+	uint32_t Phase;					// Position between Previous and Current, in output-rate units
+	uint8_t Buffer[AUDIOMIXER_VOICE_BUFFER];
+	uint8_t Index;					// Next sample to take from Buffer
+	uint8_t Count;					// Samples held in Buffer
+	uint8_t Previous;
+	uint8_t Current;
+	uint16_t Gain;					// AUDIOMIXER_UNITY = unchanged, up to AUDIOMIXER_MAX_GAIN
+	volatile uint8_t Active;		// Cleared by the mixer once the source has ended
+} AudioMixer_Voice_t;
+
+typedef struct {
+	AudioMixer_Voice_t Voices[AUDIOMIXER_VOICES];
+	int16_t Accumulator[AUDIOMIXER_BLOCK];	// Signed sum of the voices about the mid-point
+	uint32_t Rate;					// Output samples per second
+	uint32_t Reciprocal;			// 2^24 / Rate, turns Phase into an 8-bit fraction
+} AudioMixer_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void AudioMixer_Init(AudioMixer_t *Mixer, uint32_t Rate);
+void AudioMixer_Start(AudioMixer_t *Mixer, uint8_t Voice, AudioMixer_Fill_t Fill, void *Context, uint32_t Rate, uint16_t Gain);
+void AudioMixer_SetNext(AudioMixer_t *Mixer, uint8_t Voice, AudioMixer_Next_t Next);
+void AudioMixer_Stop(AudioMixer_t *Mixer, uint8_t Voice);
+void AudioMixer_SetGain(AudioMixer_t *Mixer, uint8_t Voice, uint16_t Gain);
+uint8_t AudioMixer_ActiveVoices(const AudioMixer_t *Mixer);
+void AudioMixer_Mix(AudioMixer_t *Mixer, uint8_t *Samples, uint32_t Count);
+
+#endif // AUDIOMIXER_H
@@ -0,0 +1,58 @@
+/**************************************************************************//**
+ *
+ * @file		AudioRing.c
+ * @brief		Lock-free sample ring between the audio task and ISR
+ * @version		1.0
+ *
+******************************************************************************/
+
+// Includes
+#include "AudioRing.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+// Only call while the consumer is stopped
+void AudioRing_Reset(AudioRing_t *Ring)
+{
+	Ring->Head = 0;
+	Ring->Tail = 0;
+	AudioRing_ResetStats(Ring);
+}
+
+// Producer side. Copies as many samples as fit and returns how many that was.
+uint32_t AudioRing_Write(AudioRing_t *Ring, const uint8_t *Samples, uint32_t Count)
+{
+	uint32_t Head = Ring->Head;
+	uint32_t Space = AUDIORING_SIZE - (Head - Ring->Tail);
+	uint32_t i;
+
+	if (Count > Space)
+		Count = Space;
+
+	for (i = 0; i < Count; ++i)
+		Ring->Buffer[(Head + i) & AUDIORING_MASK] = Samples[i];
+
+	// Publish the samples before the consumer can see the new head
+	AUDIORING_BARRIER();
+	Ring->Head = Head + Count;
+
+	if ((Head + Count) - Ring->Tail > Ring->HighWater)
+		Ring->HighWater = (Head + Count) - Ring->Tail;
+	return Count;
+}
+
+void AudioRing_GetStats(const AudioRing_t *Ring, AudioRing_Stats_t *Stats)
+{
+	Stats->Level = AudioRing_Level(Ring);
+	Stats->Underruns = Ring->Underruns;
+	Stats->HighWater = Ring->HighWater;
+	Stats->LowWater = Ring->LowWater;
+}
+
+void AudioRing_ResetStats(AudioRing_t *Ring)
+{
+	Ring->Underruns = 0;
+	Ring->HighWater = 0;
+	Ring->LowWater = AUDIORING_SIZE;
+}
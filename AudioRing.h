@@ -0,0 +1,78 @@
+/**************************************************************************//**
+ *
+ * @file		AudioRing.h
+ * @brief		Header file for the lock-free sample ring between the audio task and ISR
+ * @version		1.0
+ *
+ * Single producer (the audio task) and single consumer (the sample interrupt).
+ * Head is only written by the producer and Tail only by the consumer, so no
+ * locking is needed; the indices run freely and are masked on access.
+ *
+******************************************************************************/
+
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define AUDIORING_SIZE			1024						// Samples, must be a power of two
+#define AUDIORING_MASK			(AUDIORING_SIZE - 1)
+#define AUDIORING_BARRIER()		__asm volatile ("" ::: "memory")	// Keep sample stores ahead of the index store
+
+typedef struct {
+	uint8_t Buffer[AUDIORING_SIZE];
+	volatile uint32_t Head;			// Next slot to write, only moved by the producer
+	volatile uint32_t Tail;			// Next slot to read, only moved by the consumer
+	volatile uint32_t Underruns;	// Samples the consumer wanted but the ring was empty
+	volatile uint32_t HighWater;	// Highest fill level after a write
+	volatile uint32_t LowWater;		// Lowest fill level after a read
+} AudioRing_t;
+
+typedef struct {
+	uint32_t Level;
+	uint32_t Underruns;
+	uint32_t HighWater;
+	uint32_t LowWater;
+} AudioRing_Stats_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void AudioRing_Reset(AudioRing_t *Ring);
+uint32_t AudioRing_Write(AudioRing_t *Ring, const uint8_t *Samples, uint32_t Count);
+void AudioRing_GetStats(const AudioRing_t *Ring, AudioRing_Stats_t *Stats);
+void AudioRing_ResetStats(AudioRing_t *Ring);
+
+static inline uint32_t AudioRing_Level(const AudioRing_t *Ring)
+{
+	return Ring->Head - Ring->Tail;
+}
+
+static inline uint32_t AudioRing_Space(const AudioRing_t *Ring)
+{
+	return AUDIORING_SIZE - (Ring->Head - Ring->Tail);
+}
+
+// Consumer side, called from the sample interrupt. Returns 0 if the ring is empty.
+static inline uint8_t AudioRing_Pop(AudioRing_t *Ring, uint8_t *Sample)
+{
+	uint32_t Tail = Ring->Tail;
+	uint32_t Level = Ring->Head - Tail;
+
+	if (Level == 0)
+		return 0;
+
+	*Sample = Ring->Buffer[Tail & AUDIORING_MASK];
+	AUDIORING_BARRIER();
+	Ring->Tail = Tail + 1;
+
+	if (Level - 1 < Ring->LowWater)
+		Ring->LowWater = Level - 1;
+	return 1;
+}
+
+#endif // AUDIORING_H
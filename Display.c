@@ -0,0 +1,280 @@
+/**************************************************************************//**
+ *
+ * @file		Display.c
+ * @brief		Display server that owns the OLED
+ * @version		1.0
+ *
+ * Display_Task is the only code that touches the framebuffer or talks to the
+ * OLED. It takes whatever messages are waiting, at most a queue's worth, draws
+ * them and flushes once, so the latency of a message is bounded by one batch
+ * of drawing plus one flush. Every message is timed from post to the end of
+ * the flush that sent it.
+ *
+ * A shadow copy of the characters on each line means only the cells that
+ * differ are drawn at all; a clock or progress bar rewriting its whole line
+ * usually changes one or two.
+ *
+******************************************************************************/
+
+// Includes
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Queue.h"
+
+#include "OLED.h"
+#include "Display.h"
+#include "Framebuffer.h"
+#include "IsrProfile.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define DISPLAY_POST_TICKS		(10 / portTICK_RATE_MS)		// Longest a task waits for room in the queue
+#define DISPLAY_LINE_Y(Line)	((Line) * FRAMEBUFFER_CHAR_HEIGHT)	// Page aligned, so cells are copied whole
+#define DISPLAY_CYCLES_PER_US	(configCPU_CLOCK_HZ / 1000000UL)
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static xQueueHandle Queue = 0;
+static char Shadow[DISPLAY_LINES][DISPLAY_COLUMNS];	// What each character cell shows
+static Display_Stats_t Stats;
+static Display_Stats_t Totals;						// Every window already reported
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Fold one window's figures into a running total
+static void Display_Add(Display_Stats_t *Sum, const Display_Stats_t *Window)
+{
+	Sum->Drawn += Window->Drawn;
+	Sum->Dropped += Window->Dropped;
+	Sum->Late += Window->Late;
+	if (Window->LatencyMax > Sum->LatencyMax)
+		Sum->LatencyMax = Window->LatencyMax;
+	Sum->LatencyTotal += Window->LatencyTotal;
+	Sum->Flushes += Window->Flushes;
+	Sum->Bytes += Window->Bytes;
+	Sum->Transactions += Window->Transactions;
+	Sum->BytesSaved += Window->BytesSaved;
+	Sum->CellsDrawn += Window->CellsDrawn;
+	Sum->CellsSkipped += Window->CellsSkipped;
+	Sum->DrawCycles += Window->DrawCycles;
+}
+
+// Fill in a message, copying at most DISPLAY_COLUMNS characters of Text
+static void Display_Build(Display_Message_t *Message, uint8_t Type, uint8_t Line, uint8_t Column, const char *Text)
+{
+	uint8_t Length = 0;
+
+	while ((Column + Length < DISPLAY_COLUMNS) && (Text[Length] != '\0'))
+	{
+		Message->Text[Length] = Text[Length];
+		++Length;
+	}
+
+	Message->Type = Type;
+	Message->Line = Line;
+	Message->Column = Column;
+	Message->Length = Length;
+	Message->Posted = IsrProfile_Now();
+}
+
+static uint8_t Display_Post(uint8_t Type, uint8_t Line, uint8_t Column, const char *Text)
+{
+	Display_Message_t Message;
+
+	Display_Build(&Message, Type, Line, Column, Text);
+	if (xQueueSendToBack(Queue, &Message, DISPLAY_POST_TICKS) == pdTRUE)
+		return 1;
+
+	taskENTER_CRITICAL();
+		++Stats.Dropped;
+	taskEXIT_CRITICAL();
+	return 0;
+}
+
+static uint8_t Display_PostFromISR(uint8_t Type, uint8_t Line, uint8_t Column, const char *Text)
+{
+	Display_Message_t Message;
+	portBASE_TYPE HigherPriorityTaskWoken = pdFALSE;
+	uint8_t Ret = 1;
+
+	Display_Build(&Message, Type, Line, Column, Text);
+	if (xQueueSendToBackFromISR(Queue, &Message, &HigherPriorityTaskWoken) != pdTRUE)
+	{
+		++Stats.Dropped;
+		Ret = 0;
+	}
+	portEND_SWITCHING_ISR(HigherPriorityTaskWoken);
+	return Ret;
+}
+
+// Draw one character cell unless it already shows Character. Returns 1 if drawn.
+static uint8_t Display_Cell(uint8_t Line, uint8_t Column, char Character)
+{
+	if (Shadow[Line][Column] == Character)
+		return 0;
+
+	Shadow[Line][Column] = Character;
+	Framebuffer_Char(Column * FRAMEBUFFER_CHAR_WIDTH, DISPLAY_LINE_Y(Line), (uint8_t)Character, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+	return 1;
+}
+
+// Returns the number of cells that had to be drawn
+static uint8_t Display_Draw(const Display_Message_t *Message)
+{
+	uint8_t Line = Message->Line % DISPLAY_LINES;
+	uint8_t Drawn = 0;
+	uint8_t i;
+
+	for (i = 0; i < Message->Length; ++i)
+		Drawn += Display_Cell(Line, Message->Column + i, Message->Text[i]);
+
+	if (Message->Type == DISPLAY_LINE)
+	{
+		for (i = Message->Column + Message->Length; i < DISPLAY_COLUMNS; ++i)
+			Drawn += Display_Cell(Line, i, ' ');
+	}
+	return Drawn;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Sets up the framebuffer with a blank screen. Call after OLED_Init.
+void Display_Init(void)
+{
+	uint8_t Line;
+	uint8_t Column;
+
+	// A blank screen is all spaces
+	for (Line = 0; Line < DISPLAY_LINES; ++Line)
+	{
+		for (Column = 0; Column < DISPLAY_COLUMNS; ++Column)
+			Shadow[Line][Column] = ' ';
+	}
+
+	Framebuffer_Init();
+	Framebuffer_Clear(OLED_COLOR_WHITE);
+	Queue = xQueueCreate(DISPLAY_QUEUE_LENGTH, sizeof(Display_Message_t));
+}
+
+// Show Text on Line, blanking the rest of it. Returns 0 if the message was dropped.
+uint8_t Display_PutLine(uint8_t Line, const char *Text)
+{
+	return Display_Post(DISPLAY_LINE, Line, 0, Text);
+}
+
+// Show Text on Line starting at character Column, leaving the rest of the line alone
+uint8_t Display_PutField(uint8_t Line, uint8_t Column, const char *Text)
+{
+	return Display_Post(DISPLAY_FIELD, Line, Column, Text);
+}
+
+uint8_t Display_PutLineFromISR(uint8_t Line, const char *Text)
+{
+	return Display_PostFromISR(DISPLAY_LINE, Line, 0, Text);
+}
+
+uint8_t Display_PutFieldFromISR(uint8_t Line, uint8_t Column, const char *Text)
+{
+	return Display_PostFromISR(DISPLAY_FIELD, Line, Column, Text);
+}
+
+// Copy out the figures since the last report and start again
+void Display_Report(Display_Stats_t *Report)
+{
+	taskENTER_CRITICAL();
+		*Report = Stats;
+		Display_Add(&Totals, &Stats);
+		Stats.Drawn = 0;
+		Stats.Dropped = 0;
+		Stats.Late = 0;
+		Stats.LatencyMax = 0;
+		Stats.LatencyTotal = 0;
+		Stats.Flushes = 0;
+		Stats.Bytes = 0;
+		Stats.Transactions = 0;
+		Stats.BytesSaved = 0;
+		Stats.CellsDrawn = 0;
+		Stats.CellsSkipped = 0;
+		Stats.DrawCycles = 0;
+	taskEXIT_CRITICAL();
+}
+
+// Copy out the figures since start up, the window not yet reported included
+void Display_Totals(Display_Stats_t *Report)
+{
+	taskENTER_CRITICAL();
+		*Report = Totals;
+		Display_Add(Report, &Stats);
+	taskEXIT_CRITICAL();
+}
+
+/******************************************************************************
+ * Description:	Draws posted messages and sends the result to the OLED. Sleeps
+ *				until something is posted, then drains up to a queue's worth
+ *				of messages before flushing once.
+ *****************************************************************************/
+void Display_Task(void *pvParameters)
+{
+	Display_Message_t Message;
+	Framebuffer_Stats_t Bus;
+	uint32_t Posted[DISPLAY_QUEUE_LENGTH];
+	uint32_t Latency;
+	uint32_t Now;
+	uint32_t DrawStart;
+	uint32_t DrawCycles;
+	uint16_t Cells;
+	uint16_t Drawn;
+	uint8_t Count;
+	uint8_t i;
+
+	(void)pvParameters;
+
+	for(;;)
+	{
+		xQueueReceive(Queue, &Message, portMAX_DELAY);
+
+		Count = 0;
+		Cells = 0;
+		Drawn = 0;
+		DrawCycles = 0;
+		do
+		{
+			Cells += (Message.Type == DISPLAY_LINE) ? (DISPLAY_COLUMNS - Message.Column) : Message.Length;
+			DrawStart = IsrProfile_Now();
+			Drawn += Display_Draw(&Message);
+			DrawCycles += IsrProfile_Now() - DrawStart;
+			Posted[Count++] = Message.Posted;
+		} while ((Count < DISPLAY_QUEUE_LENGTH) && (xQueueReceive(Queue, &Message, 0) == pdTRUE));
+
+		Framebuffer_Flush();
+		Now = IsrProfile_Now();
+		Framebuffer_GetStats(&Bus);
+		Framebuffer_ResetStats();
+
+		taskENTER_CRITICAL();
+			for (i = 0; i < Count; ++i)
+			{
+				Latency = (Now - Posted[i]) / DISPLAY_CYCLES_PER_US;
+				Stats.LatencyTotal += Latency;
+				if (Latency > Stats.LatencyMax)
+					Stats.LatencyMax = Latency;
+				if (Latency > DISPLAY_LATENCY_BOUND)
+					++Stats.Late;
+			}
+			Stats.Drawn += Count;
+			Stats.Flushes += Bus.Flushes;
+			Stats.Bytes += Bus.Bytes;
+			Stats.Transactions += Bus.Transactions;
+			Stats.BytesSaved += Bus.BytesSaved;
+			Stats.CellsDrawn += Drawn;
+			Stats.CellsSkipped += Cells - Drawn;
+			Stats.DrawCycles += DrawCycles;
+		taskEXIT_CRITICAL();
+	}
+}
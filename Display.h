@@ -0,0 +1,70 @@
+/**************************************************************************//**
+ *
+ * @file		Display.h
+ * @brief		Header file for the display server that owns the OLED
+ * @version		1.0
+ *
+ * Tasks and interrupts never draw on the OLED themselves. They post a fixed
+ * size message, either a whole text line or a field within one, and
+ * Display_Task draws it into the framebuffer and flushes the change. Posting
+ * never waits on the SPI, so a high priority task or an ISR cannot be held up
+ * by whoever is using the bus.
+ *
+******************************************************************************/
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+// Includes
+#include "FreeRTOS.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define DISPLAY_LINES			8							// Text lines on the OLED, one per display page
+#define DISPLAY_COLUMNS			16							// Characters per line
+#define DISPLAY_QUEUE_LENGTH	16							// Messages waiting to be drawn
+#define DISPLAY_LATENCY_BOUND	20000						// Post to pixels, us; anything slower counts as Late
+
+typedef enum {
+	DISPLAY_LINE,				// Replace the whole line, padding with spaces
+	DISPLAY_FIELD				// Overwrite only the characters given, from Column on
+} Display_MessageType_t;
+
+typedef struct {
+	uint8_t Type;				// Display_MessageType_t
+	uint8_t Line;
+	uint8_t Column;
+	uint8_t Length;
+	uint32_t Posted;			// Cycle count when posted, for the latency figures
+	char Text[DISPLAY_COLUMNS];	// Not terminated
+} Display_Message_t;
+
+typedef struct {
+	uint32_t Drawn;				// Messages drawn
+	uint32_t Dropped;			// Messages lost to a full queue
+	uint32_t Late;				// Messages that took longer than DISPLAY_LATENCY_BOUND
+	uint32_t LatencyMax;		// us
+	uint32_t LatencyTotal;		// us, over all messages drawn
+	uint32_t Flushes;			// Framebuffer flushes that sent something
+	uint32_t Bytes;				// SPI bytes sent to the OLED
+	uint32_t Transactions;		// SPI bursts sent to the OLED
+	uint32_t BytesSaved;		// SPI bytes not sent by splitting bursts at unchanged columns
+	uint32_t CellsDrawn;		// Character cells that changed and were drawn
+	uint32_t CellsSkipped;		// Character cells posted that already showed the right character
+	uint32_t DrawCycles;		// CPU cycles spent drawing the cells that changed
+} Display_Stats_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Display_Init(void);
+uint8_t Display_PutLine(uint8_t Line, const char *Text);
+uint8_t Display_PutField(uint8_t Line, uint8_t Column, const char *Text);
+uint8_t Display_PutLineFromISR(uint8_t Line, const char *Text);
+uint8_t Display_PutFieldFromISR(uint8_t Line, uint8_t Column, const char *Text);
+void Display_Report(Display_Stats_t *Report);
+void Display_Totals(Display_Stats_t *Report);
+void Display_Task(void *pvParameters);
+
+#endif // DISPLAY_H
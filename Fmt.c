@@ -0,0 +1,119 @@
+/**************************************************************************//**
+ *
+ * @file		Fmt.c
+ * @brief		Fixed-width number and text formatting
+ * @version		1.0
+ *
+ * Every number goes through Fmt_Number: the digits are produced least
+ * significant first into a scratch buffer, then copied out behind the padding
+ * and sign, with the decimal point dropped in on the way. The Cortex-M3 has a
+ * hardware divide, so a digit costs one divide and one multiply-subtract.
+ *
+******************************************************************************/
+
+// Includes
+#include "Fmt.h"
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Write the decimal digits of Value into Digits, least significant first.
+// Returns how many there are, at least one.
+static uint8_t Fmt_Digits(char *Digits, uint32_t Value)
+{
+	uint8_t Count = 0;
+	uint32_t Next;
+
+	do
+	{
+		Next = Value / 10;
+		Digits[Count++] = (char)('0' + (Value - (Next * 10)));
+		Value = Next;
+	} while (Value != 0);
+
+	return Count;
+}
+
+// Magnitude with at least MinDigits digits, the last Point of them after a
+// decimal point, in a field of Width padded on the left with Pad
+static char* Fmt_Number(char *Out, uint32_t Magnitude, uint8_t Negative, uint8_t MinDigits, uint8_t Point, uint8_t Width, char Pad)
+{
+	char Digits[FMT_MAX_DIGITS];
+	uint8_t Count = Fmt_Digits(Digits, Magnitude);
+	uint8_t Length;
+	uint8_t i;
+
+	while (Count < MinDigits)
+		Digits[Count++] = '0';
+
+	Length = Count + Negative + ((Point != 0) ? 1 : 0);
+	if (Width == 0)
+		Width = Length;
+
+	if (Length > Width)
+	{
+		for (i = 0; i < Width; ++i)
+			*Out++ = '*';
+		return Out;
+	}
+
+	// Zeros go between the sign and the digits, spaces in front of both
+	if ((Pad == '0') && Negative)
+		*Out++ = '-';
+	for (i = Length; i < Width; ++i)
+		*Out++ = Pad;
+	if ((Pad != '0') && Negative)
+		*Out++ = '-';
+
+	while (Count != 0)
+	{
+		if (Count == Point)
+			*Out++ = '.';
+		*Out++ = Digits[--Count];
+	}
+	return Out;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Value right aligned in Width characters, padded with Pad (' ' or '0')
+char* Fmt_Unsigned(char *Out, uint32_t Value, uint8_t Width, char Pad)
+{
+	return Fmt_Number(Out, Value, 0, 1, 0, Width, Pad);
+}
+
+// Value right aligned in Width characters, with a '-' if it is negative
+char* Fmt_Signed(char *Out, int32_t Value, uint8_t Width)
+{
+	if (Value < 0)
+		return Fmt_Number(Out, 0U - (uint32_t)Value, 1, 1, 0, Width, ' ');
+	return Fmt_Number(Out, (uint32_t)Value, 0, 1, 0, Width, ' ');
+}
+
+// Value in units of 10^-Decimals, e.g. 123 with one decimal shows as 12.3
+char* Fmt_Fixed(char *Out, int32_t Value, uint8_t Decimals, uint8_t Width)
+{
+	if (Decimals > FMT_MAX_DECIMALS)
+		Decimals = FMT_MAX_DECIMALS;
+
+	// At least one digit in front of the point, so a half is 0.5 not .5
+	if (Value < 0)
+		return Fmt_Number(Out, 0U - (uint32_t)Value, 1, Decimals + 1, Decimals, Width, ' ');
+	return Fmt_Number(Out, (uint32_t)Value, 0, Decimals + 1, Decimals, Width, ' ');
+}
+
+// Text left aligned in Width characters, padded with spaces and cut short if
+// it is longer
+char* Fmt_Text(char *Out, const char *Text, uint8_t Width)
+{
+	uint8_t i = 0;
+
+	while ((Text[i] != '\0') && ((Width == 0) || (i < Width)))
+		*Out++ = Text[i++];
+	for (; i < Width; ++i)
+		*Out++ = ' ';
+	return Out;
+}
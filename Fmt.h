@@ -0,0 +1,41 @@
+/**************************************************************************//**
+ *
+ * @file		Fmt.h
+ * @brief		Header file for fixed-width number and text formatting
+ * @version		1.0
+ *
+ * A small stand-in for sprintf when building display lines. Each function
+ * writes one field at Out and returns where the next field starts, so a line
+ * is built by chaining calls and terminated by the caller. Nothing is
+ * allocated, the stack use is a ten byte scratch buffer, and the work is
+ * bounded by the field width or ten digits, so all of them are safe to call
+ * from an interrupt.
+ *
+ * A Width of 0 uses as many characters as the value needs. Otherwise the
+ * field is exactly Width characters, right aligned for numbers and left
+ * aligned for text; a number too wide for its field is shown as '*'s rather
+ * than pushing the rest of the line along.
+ *
+******************************************************************************/
+
+#ifndef FMT_H
+#define FMT_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define FMT_MAX_DIGITS			10			// Digits in the largest uint32_t
+#define FMT_MAX_DECIMALS		9			// Most digits after the point Fmt_Fixed will show
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+char* Fmt_Unsigned(char *Out, uint32_t Value, uint8_t Width, char Pad);
+char* Fmt_Signed(char *Out, int32_t Value, uint8_t Width);
+char* Fmt_Fixed(char *Out, int32_t Value, uint8_t Decimals, uint8_t Width);
+char* Fmt_Text(char *Out, const char *Text, uint8_t Width);
+
+#endif // FMT_H
@@ -0,0 +1,133 @@
+/**************************************************************************//**
+ *
+ * @file		Font5x7.c
+ * @brief		5x7 pixel font for the OLED framebuffer
+ * @version		1.0
+ *
+ * The glyphs are listed once, in FONT5X7_GLYPHS, and expanded into both the
+ * plain five column table and the pre-rendered six column cells, so the two
+ * can never disagree.
+ *
+******************************************************************************/
+
+// Includes
+#include "Font5x7.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+
+// Printable ASCII and a solid block, five columns per character with bit 0 at the top
+#define FONT5X7_GLYPHS(G) \
+	G(0x00, 0x00, 0x00, 0x00, 0x00)	/* 0x20 ' ' */ \
+	G(0x00, 0x00, 0x5F, 0x00, 0x00)	/* 0x21 '!' */ \
+	G(0x00, 0x07, 0x00, 0x07, 0x00)	/* 0x22 '"' */ \
+	G(0x14, 0x7F, 0x14, 0x7F, 0x14)	/* 0x23 '#' */ \
+	G(0x24, 0x2A, 0x7F, 0x2A, 0x12)	/* 0x24 '$' */ \
+	G(0x23, 0x13, 0x08, 0x64, 0x62)	/* 0x25 '%' */ \
+	G(0x36, 0x49, 0x55, 0x22, 0x50)	/* 0x26 '&' */ \
+	G(0x00, 0x05, 0x03, 0x00, 0x00)	/* 0x27 'quote' */ \
+	G(0x00, 0x1C, 0x22, 0x41, 0x00)	/* 0x28 '(' */ \
+	G(0x00, 0x41, 0x22, 0x1C, 0x00)	/* 0x29 ')' */ \
+	G(0x14, 0x08, 0x3E, 0x08, 0x14)	/* 0x2A '*' */ \
+	G(0x08, 0x08, 0x3E, 0x08, 0x08)	/* 0x2B '+' */ \
+	G(0x00, 0x50, 0x30, 0x00, 0x00)	/* 0x2C ',' */ \
+	G(0x08, 0x08, 0x08, 0x08, 0x08)	/* 0x2D '-' */ \
+	G(0x00, 0x60, 0x60, 0x00, 0x00)	/* 0x2E '.' */ \
+	G(0x20, 0x10, 0x08, 0x04, 0x02)	/* 0x2F '/' */ \
+	G(0x3E, 0x51, 0x49, 0x45, 0x3E)	/* 0x30 '0' */ \
+	G(0x00, 0x42, 0x7F, 0x40, 0x00)	/* 0x31 '1' */ \
+	G(0x42, 0x61, 0x51, 0x49, 0x46)	/* 0x32 '2' */ \
+	G(0x21, 0x41, 0x45, 0x4B, 0x31)	/* 0x33 '3' */ \
+	G(0x18, 0x14, 0x12, 0x7F, 0x10)	/* 0x34 '4' */ \
+	G(0x27, 0x45, 0x45, 0x45, 0x39)	/* 0x35 '5' */ \
+	G(0x3C, 0x4A, 0x49, 0x49, 0x30)	/* 0x36 '6' */ \
+	G(0x01, 0x71, 0x09, 0x05, 0x03)	/* 0x37 '7' */ \
+	G(0x36, 0x49, 0x49, 0x49, 0x36)	/* 0x38 '8' */ \
+	G(0x06, 0x49, 0x49, 0x29, 0x1E)	/* 0x39 '9' */ \
+	G(0x00, 0x36, 0x36, 0x00, 0x00)	/* 0x3A ':' */ \
+	G(0x00, 0x56, 0x36, 0x00, 0x00)	/* 0x3B ';' */ \
+	G(0x08, 0x14, 0x22, 0x41, 0x00)	/* 0x3C '<' */ \
+	G(0x14, 0x14, 0x14, 0x14, 0x14)	/* 0x3D '=' */ \
+	G(0x00, 0x41, 0x22, 0x14, 0x08)	/* 0x3E '>' */ \
+	G(0x02, 0x01, 0x51, 0x09, 0x06)	/* 0x3F '?' */ \
+	G(0x32, 0x49, 0x79, 0x41, 0x3E)	/* 0x40 '@' */ \
+	G(0x7E, 0x11, 0x11, 0x11, 0x7E)	/* 0x41 'A' */ \
+	G(0x7F, 0x49, 0x49, 0x49, 0x36)	/* 0x42 'B' */ \
+	G(0x3E, 0x41, 0x41, 0x41, 0x22)	/* 0x43 'C' */ \
+	G(0x7F, 0x41, 0x41, 0x22, 0x1C)	/* 0x44 'D' */ \
+	G(0x7F, 0x49, 0x49, 0x49, 0x41)	/* 0x45 'E' */ \
+	G(0x7F, 0x09, 0x09, 0x09, 0x01)	/* 0x46 'F' */ \
+	G(0x3E, 0x41, 0x49, 0x49, 0x7A)	/* 0x47 'G' */ \
+	G(0x7F, 0x08, 0x08, 0x08, 0x7F)	/* 0x48 'H' */ \
+	G(0x00, 0x41, 0x7F, 0x41, 0x00)	/* 0x49 'I' */ \
+	G(0x20, 0x40, 0x41, 0x3F, 0x01)	/* 0x4A 'J' */ \
+	G(0x7F, 0x08, 0x14, 0x22, 0x41)	/* 0x4B 'K' */ \
+	G(0x7F, 0x40, 0x40, 0x40, 0x40)	/* 0x4C 'L' */ \
+	G(0x7F, 0x02, 0x0C, 0x02, 0x7F)	/* 0x4D 'M' */ \
+	G(0x7F, 0x04, 0x08, 0x10, 0x7F)	/* 0x4E 'N' */ \
+	G(0x3E, 0x41, 0x41, 0x41, 0x3E)	/* 0x4F 'O' */ \
+	G(0x7F, 0x09, 0x09, 0x09, 0x06)	/* 0x50 'P' */ \
+	G(0x3E, 0x41, 0x51, 0x21, 0x5E)	/* 0x51 'Q' */ \
+	G(0x7F, 0x09, 0x19, 0x29, 0x46)	/* 0x52 'R' */ \
+	G(0x46, 0x49, 0x49, 0x49, 0x31)	/* 0x53 'S' */ \
+	G(0x01, 0x01, 0x7F, 0x01, 0x01)	/* 0x54 'T' */ \
+	G(0x3F, 0x40, 0x40, 0x40, 0x3F)	/* 0x55 'U' */ \
+	G(0x1F, 0x20, 0x40, 0x20, 0x1F)	/* 0x56 'V' */ \
+	G(0x3F, 0x40, 0x38, 0x40, 0x3F)	/* 0x57 'W' */ \
+	G(0x63, 0x14, 0x08, 0x14, 0x63)	/* 0x58 'X' */ \
+	G(0x07, 0x08, 0x70, 0x08, 0x07)	/* 0x59 'Y' */ \
+	G(0x61, 0x51, 0x49, 0x45, 0x43)	/* 0x5A 'Z' */ \
+	G(0x00, 0x7F, 0x41, 0x41, 0x00)	/* 0x5B '[' */ \
+	G(0x02, 0x04, 0x08, 0x10, 0x20)	/* 0x5C 'backslash' */ \
+	G(0x00, 0x41, 0x41, 0x7F, 0x00)	/* 0x5D ']' */ \
+	G(0x04, 0x02, 0x01, 0x02, 0x04)	/* 0x5E '^' */ \
+	G(0x40, 0x40, 0x40, 0x40, 0x40)	/* 0x5F '_' */ \
+	G(0x00, 0x01, 0x02, 0x04, 0x00)	/* 0x60 '`' */ \
+	G(0x20, 0x54, 0x54, 0x54, 0x78)	/* 0x61 'a' */ \
+	G(0x7F, 0x48, 0x44, 0x44, 0x38)	/* 0x62 'b' */ \
+	G(0x38, 0x44, 0x44, 0x44, 0x20)	/* 0x63 'c' */ \
+	G(0x38, 0x44, 0x44, 0x48, 0x7F)	/* 0x64 'd' */ \
+	G(0x38, 0x54, 0x54, 0x54, 0x18)	/* 0x65 'e' */ \
+	G(0x08, 0x7E, 0x09, 0x01, 0x02)	/* 0x66 'f' */ \
+	G(0x0C, 0x52, 0x52, 0x52, 0x3E)	/* 0x67 'g' */ \
+	G(0x7F, 0x08, 0x04, 0x04, 0x78)	/* 0x68 'h' */ \
+	G(0x00, 0x44, 0x7D, 0x40, 0x00)	/* 0x69 'i' */ \
+	G(0x20, 0x40, 0x44, 0x3D, 0x00)	/* 0x6A 'j' */ \
+	G(0x7F, 0x10, 0x28, 0x44, 0x00)	/* 0x6B 'k' */ \
+	G(0x00, 0x41, 0x7F, 0x40, 0x00)	/* 0x6C 'l' */ \
+	G(0x7C, 0x04, 0x18, 0x04, 0x78)	/* 0x6D 'm' */ \
+	G(0x7C, 0x08, 0x04, 0x04, 0x78)	/* 0x6E 'n' */ \
+	G(0x38, 0x44, 0x44, 0x44, 0x38)	/* 0x6F 'o' */ \
+	G(0x7C, 0x14, 0x14, 0x14, 0x08)	/* 0x70 'p' */ \
+	G(0x08, 0x14, 0x14, 0x18, 0x7C)	/* 0x71 'q' */ \
+	G(0x7C, 0x08, 0x04, 0x04, 0x08)	/* 0x72 'r' */ \
+	G(0x48, 0x54, 0x54, 0x54, 0x20)	/* 0x73 's' */ \
+	G(0x04, 0x3F, 0x44, 0x40, 0x20)	/* 0x74 't' */ \
+	G(0x3C, 0x40, 0x40, 0x20, 0x7C)	/* 0x75 'u' */ \
+	G(0x1C, 0x20, 0x40, 0x20, 0x1C)	/* 0x76 'v' */ \
+	G(0x3C, 0x40, 0x30, 0x40, 0x3C)	/* 0x77 'w' */ \
+	G(0x44, 0x28, 0x10, 0x28, 0x44)	/* 0x78 'x' */ \
+	G(0x0C, 0x50, 0x50, 0x50, 0x3C)	/* 0x79 'y' */ \
+	G(0x44, 0x64, 0x54, 0x4C, 0x44)	/* 0x7A 'z' */ \
+	G(0x00, 0x08, 0x36, 0x41, 0x00)	/* 0x7B '{' */ \
+	G(0x00, 0x00, 0x7F, 0x00, 0x00)	/* 0x7C '|' */ \
+	G(0x00, 0x41, 0x36, 0x08, 0x00)	/* 0x7D '}' */ \
+	G(0x08, 0x04, 0x08, 0x10, 0x08)	/* 0x7E '~' */ \
+	G(0x7F, 0x7F, 0x7F, 0x7F, 0x7F)	/* 0x7F solid block */
+
+#define FONT5X7_PLAIN(a, b, c, d, e)		{a, b, c, d, e},
+
+// Dark text on a lit background: set bits are unlit, plus the lit gap column
+#define FONT5X7_CELL(a, b, c, d, e)		{(uint8_t)~(a), (uint8_t)~(b), (uint8_t)~(c), (uint8_t)~(d), (uint8_t)~(e), 0xFF},
+
+//------------------------------------------------------------------------------
+
+// Public variables
+const uint8_t Font5x7[FONT5X7_COUNT][FONT5X7_WIDTH] = {
+	FONT5X7_GLYPHS(FONT5X7_PLAIN)
+};
+
+const uint8_t Font5x7Cells[FONT5X7_COUNT][FONT5X7_CELL_WIDTH] = {
+	FONT5X7_GLYPHS(FONT5X7_CELL)
+};
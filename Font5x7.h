@@ -0,0 +1,29 @@
+/**************************************************************************//**
+ *
+ * @file		Font5x7.h
+ * @brief		Header file for the 5x7 pixel font used by the OLED framebuffer
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef FONT5X7_H
+#define FONT5X7_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define FONT5X7_WIDTH			5			// Columns per character
+#define FONT5X7_CELL_WIDTH		6			// Columns per pre-rendered cell, gap included
+#define FONT5X7_FIRST			0x20		// ' ', the first character in the table
+#define FONT5X7_COUNT			96			// ' ' to '~', then a solid block at 0x7F
+
+//------------------------------------------------------------------------------
+
+// Public variables
+extern const uint8_t Font5x7[FONT5X7_COUNT][FONT5X7_WIDTH];
+extern const uint8_t Font5x7Cells[FONT5X7_COUNT][FONT5X7_CELL_WIDTH];	// Black on white, one page high
+
+#endif // FONT5X7_H
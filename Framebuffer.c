@@ -0,0 +1,300 @@
+/**************************************************************************//**
+ *
+ * @file		Framebuffer.c
+ * @brief		RAM framebuffer in front of the 96x64 OLED
+ * @version		1.0
+ *
+ * The display controller is page addressed: each byte written sets eight
+ * pixels of one column, bit 0 at the top. The framebuffer keeps the same
+ * layout, so a dirty span goes out as it is, after a three byte page and
+ * column address. Only the display task (see Display.c) draws or flushes, so
+ * none of this needs interrupts masked.
+ *
+******************************************************************************/
+
+// Includes
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Semaphore.h"
+
+#include "OLED.h"
+#include "Framebuffer.h"
+#include "Font5x7.h"
+#include "Spi.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define FRAMEBUFFER_X_OFFSET	18							// First visible column of the controller
+#define FRAMEBUFFER_CLEAN		0xFF						// DirtyStart of a page with nothing to send
+#define FRAMEBUFFER_ADDRESS		3							// Bytes of page and column address before each burst
+#define FRAMEBUFFER_WORDS		((FRAMEBUFFER_WIDTH + 31) / 32)
+#define FRAMEBUFFER_PRIORITY	1							// Below the 7 segment display on the SPI
+#define FRAMEBUFFER_BYTE_RATE	8000						// SPI bytes per second before giving way
+#define FRAMEBUFFER_DEADLINE	(50 / portTICK_RATE_MS)		// Each span should be on the wire by then
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static uint8_t Pixels[FRAMEBUFFER_PAGES][FRAMEBUFFER_WIDTH];
+static uint8_t DirtyStart[FRAMEBUFFER_PAGES];		// First changed column of each page
+static uint8_t DirtyEnd[FRAMEBUFFER_PAGES];			// One past the last changed column
+static uint32_t DirtyColumns[FRAMEBUFFER_PAGES][FRAMEBUFFER_WORDS];	// One bit per changed column
+static uint8_t Dirty = 0;					// Some page has something to send
+static Framebuffer_Stats_t Stats;
+static Spi_Client_t *Client = 0;
+static xSemaphoreHandle SpanDone = 0;				// Given by the SPI driver after each span
+
+// Chip select on P0.6, data/command on P2.7
+static const Spi_Device_t Oled = {0, (1<<6), 2, (1<<7)};
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Store the masked bits of one byte, marking the column dirty if it changes
+static void Framebuffer_Write(uint8_t Page, uint8_t Column, uint8_t Mask, uint8_t Value)
+{
+	uint8_t Old = Pixels[Page][Column];
+	uint8_t New = (uint8_t)((Old & ~Mask) | (Value & Mask));
+
+	if (New == Old)
+		return;
+
+	Pixels[Page][Column] = New;
+	DirtyColumns[Page][Column >> 5] |= 1UL << (Column & 31);
+	if ((DirtyStart[Page] == FRAMEBUFFER_CLEAN) || (Column < DirtyStart[Page]))
+		DirtyStart[Page] = Column;
+	if (Column >= DirtyEnd[Page])
+		DirtyEnd[Page] = Column + 1;
+	Dirty = 1;
+}
+
+// Draw eight pixels of one column starting at any row; Bits set are Lit
+static void Framebuffer_Column(uint8_t X, uint8_t Y, uint8_t Bits, uint8_t Foreground, uint8_t Background)
+{
+	uint8_t Page = Y >> 3;
+	uint8_t Shift = Y & 7;
+	uint8_t Lit;
+
+	Lit = ((Foreground == OLED_COLOR_WHITE) ? Bits : 0) | ((Background == OLED_COLOR_WHITE) ? (uint8_t)~Bits : 0);
+
+	Framebuffer_Write(Page, X, (uint8_t)(0xFF << Shift), (uint8_t)(Lit << Shift));
+	if ((Shift != 0) && (Page + 1 < FRAMEBUFFER_PAGES))
+		Framebuffer_Write(Page + 1, X, (uint8_t)(0xFF >> (8 - Shift)), (uint8_t)(Lit >> (8 - Shift)));
+}
+
+// Copy a whole pre-rendered cell into one page, marking its columns dirty if it differs
+static void Framebuffer_Cell(uint8_t Page, uint8_t X, const uint8_t *Cell)
+{
+	uint8_t *Target = &Pixels[Page][X];
+	uint8_t i;
+
+	if (memcmp(Target, Cell, FONT5X7_CELL_WIDTH) == 0)
+		return;
+
+	memcpy(Target, Cell, FONT5X7_CELL_WIDTH);
+	for (i = X; i < X + FONT5X7_CELL_WIDTH; ++i)
+		DirtyColumns[Page][i >> 5] |= 1UL << (i & 31);
+	if ((DirtyStart[Page] == FRAMEBUFFER_CLEAN) || (X < DirtyStart[Page]))
+		DirtyStart[Page] = X;
+	if (X + FONT5X7_CELL_WIDTH > DirtyEnd[Page])
+		DirtyEnd[Page] = X + FONT5X7_CELL_WIDTH;
+	Dirty = 1;
+}
+
+static uint8_t Framebuffer_IsDirty(uint8_t Page, uint8_t Column)
+{
+	return (DirtyColumns[Page][Column >> 5] >> (Column & 31)) & 1;
+}
+
+// Send one page span: the address as commands, then the pixels as data, in one
+// burst. The task sleeps while the DMA sends it.
+static void Framebuffer_SendSpan(uint8_t Page, uint8_t Column, const uint8_t *Data, uint8_t Length)
+{
+	Spi_Transaction_t Transaction;
+	uint8_t Address[FRAMEBUFFER_ADDRESS];
+	uint8_t Controller = Column + FRAMEBUFFER_X_OFFSET;
+
+	Address[0] = 0xB0 | Page;					// Page address
+	Address[1] = 0x00 | (Controller & 0x0F);	// Column, low nibble
+	Address[2] = 0x10 | (Controller >> 4);		// Column, high nibble
+
+	Transaction.Client = Client;
+	Transaction.Deadline = FRAMEBUFFER_DEADLINE;
+	Transaction.Device = &Oled;
+	Transaction.Command = Address;
+	Transaction.CommandLength = sizeof(Address);
+	Transaction.Data = Data;
+	Transaction.DataLength = Length;
+	Transaction.Done = SpanDone;
+	Spi_Transfer(&Transaction);
+
+	Stats.Bytes += sizeof(Address) + Length;
+	++Stats.Transactions;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Call after OLED_Init has set the controller up. The first flush repaints the whole display.
+void Framebuffer_Init(void)
+{
+	uint8_t Page;
+	uint8_t Word;
+
+	Client = Spi_AddClient("OLED", FRAMEBUFFER_PRIORITY, FRAMEBUFFER_BYTE_RATE);
+	vSemaphoreCreateBinary(SpanDone);
+	xSemaphoreTake(SpanDone, 0);
+
+	for (Page = 0; Page < FRAMEBUFFER_PAGES; ++Page)
+	{
+		DirtyStart[Page] = 0;
+		DirtyEnd[Page] = FRAMEBUFFER_WIDTH;
+		for (Word = 0; Word < FRAMEBUFFER_WORDS; ++Word)
+			DirtyColumns[Page][Word] = 0xFFFFFFFF;
+	}
+	Dirty = 1;
+	Framebuffer_ResetStats();
+}
+
+void Framebuffer_Clear(uint8_t Color)
+{
+	Framebuffer_Fill(0, 0, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT, Color);
+}
+
+void Framebuffer_Fill(uint8_t X, uint8_t Y, uint8_t Width, uint8_t Height, uint8_t Color)
+{
+	uint8_t Value = (Color == OLED_COLOR_WHITE) ? 0xFF : 0x00;
+	uint8_t Page;
+	uint8_t Column;
+	uint8_t Mask;
+	uint16_t Top;
+	uint16_t Bottom;
+
+	if ((X >= FRAMEBUFFER_WIDTH) || (Y >= FRAMEBUFFER_HEIGHT))
+		return;
+	if (X + Width > FRAMEBUFFER_WIDTH)
+		Width = FRAMEBUFFER_WIDTH - X;
+	if (Y + Height > FRAMEBUFFER_HEIGHT)
+		Height = FRAMEBUFFER_HEIGHT - Y;
+
+	for (Page = Y >> 3; Page <= ((Y + Height - 1) >> 3); ++Page)
+	{
+		// Rows of the rectangle that fall in this page
+		Top = (Y > Page * 8) ? Y : Page * 8;
+		Bottom = ((Y + Height) < (Page * 8 + 8)) ? (Y + Height) : (Page * 8 + 8);
+		Mask = (uint8_t)(((1U << (Bottom - Top)) - 1) << (Top - Page * 8));
+
+		for (Column = X; Column < X + Width; ++Column)
+			Framebuffer_Write(Page, Column, Mask, Value);
+	}
+}
+
+// Draw one character cell. Returns 0, drawing nothing, if it does not fit on the display.
+uint8_t Framebuffer_Char(uint8_t X, uint8_t Y, uint8_t Character, uint8_t Foreground, uint8_t Background)
+{
+	const uint8_t *Glyph;
+	uint8_t i;
+
+	if ((X + FRAMEBUFFER_CHAR_WIDTH > FRAMEBUFFER_WIDTH) || (Y + FRAMEBUFFER_CHAR_HEIGHT > FRAMEBUFFER_HEIGHT))
+		return 0;
+
+	if ((Character < FONT5X7_FIRST) || (Character >= FONT5X7_FIRST + FONT5X7_COUNT))
+		Character = '?';
+
+	// Dark text on a page boundary is a straight copy of the pre-rendered cell
+	if (((Y & 7) == 0) && (Foreground == OLED_COLOR_BLACK) && (Background == OLED_COLOR_WHITE))
+	{
+		Framebuffer_Cell(Y >> 3, X, Font5x7Cells[Character - FONT5X7_FIRST]);
+		return 1;
+	}
+
+	Glyph = Font5x7[Character - FONT5X7_FIRST];
+	for (i = 0; i < FONT5X7_WIDTH; ++i)
+		Framebuffer_Column(X + i, Y, Glyph[i], Foreground, Background);
+	Framebuffer_Column(X + FONT5X7_WIDTH, Y, 0, Foreground, Background);
+	return 1;
+}
+
+// Draw characters left to right until the string or the display runs out
+void Framebuffer_String(uint8_t X, uint8_t Y, const uint8_t *String, uint8_t Foreground, uint8_t Background)
+{
+	while (*String != '\0')
+	{
+		if (!Framebuffer_Char(X, Y, *String++, Foreground, Background))
+			break;
+		X += FRAMEBUFFER_CHAR_WIDTH;
+	}
+}
+
+// Send every run of changed columns. Runs closer together than the cost of an
+// address are sent as one, clean columns and all. Returns the number of bursts sent.
+uint8_t Framebuffer_Flush(void)
+{
+	uint8_t Page;
+	uint8_t Column;
+	uint8_t Start;
+	uint8_t End;
+	uint8_t Sent = 0;
+	uint32_t Bytes;
+
+	if (Dirty == 0)
+		return 0;
+
+	Dirty = 0;
+	++Stats.Flushes;
+
+	for (Page = 0; Page < FRAMEBUFFER_PAGES; ++Page)
+	{
+		if (DirtyStart[Page] == FRAMEBUFFER_CLEAN)
+			continue;
+
+		Bytes = Stats.Bytes;
+		Column = DirtyStart[Page];
+		while (Column < DirtyEnd[Page])
+		{
+			// Extend the run over any gap too short to be worth a new address
+			Start = Column;
+			End = Column + 1;
+			for (Column = End; Column < DirtyEnd[Page]; ++Column)
+			{
+				if (Framebuffer_IsDirty(Page, Column))
+					End = Column + 1;
+				else if (Column - End >= FRAMEBUFFER_ADDRESS)
+					break;
+			}
+
+			Framebuffer_SendSpan(Page, Start, &Pixels[Page][Start], End - Start);
+			++Sent;
+
+			while ((Column < DirtyEnd[Page]) && !Framebuffer_IsDirty(Page, Column))
+				++Column;
+		}
+
+		// Against sending the whole span between the first and last change
+		Stats.BytesSaved += (FRAMEBUFFER_ADDRESS + DirtyEnd[Page] - DirtyStart[Page]) - (Stats.Bytes - Bytes);
+
+		DirtyStart[Page] = FRAMEBUFFER_CLEAN;
+		DirtyEnd[Page] = 0;
+		for (Column = 0; Column < FRAMEBUFFER_WORDS; ++Column)
+			DirtyColumns[Page][Column] = 0;
+	}
+
+	return Sent;
+}
+
+void Framebuffer_GetStats(Framebuffer_Stats_t *Copy)
+{
+	*Copy = Stats;
+}
+
+void Framebuffer_ResetStats(void)
+{
+	Stats.Bytes = 0;
+	Stats.Transactions = 0;
+	Stats.Flushes = 0;
+	Stats.BytesSaved = 0;
+}
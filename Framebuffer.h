@@ -0,0 +1,48 @@
+/**************************************************************************//**
+ *
+ * @file		Framebuffer.h
+ * @brief		Header file for the RAM framebuffer in front of the 96x64 OLED
+ * @version		1.0
+ *
+ * Drawing only touches RAM. Every byte that actually changes marks its column
+ * dirty, and Framebuffer_Flush sends each run of dirty columns to the display
+ * in one SPI burst. Redrawing text that is already on screen costs no SPI
+ * traffic at all.
+ *
+******************************************************************************/
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+// Includes
+#include "FreeRTOS.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define FRAMEBUFFER_WIDTH		96
+#define FRAMEBUFFER_HEIGHT		64
+#define FRAMEBUFFER_PAGES		(FRAMEBUFFER_HEIGHT / 8)	// Rows of eight pixels, one byte per column
+#define FRAMEBUFFER_CHAR_WIDTH	6							// Five font columns and a gap
+#define FRAMEBUFFER_CHAR_HEIGHT	8
+
+typedef struct {
+	uint32_t Bytes;					// SPI bytes sent to the display, commands included
+	uint32_t Transactions;			// Chip select bursts
+	uint32_t Flushes;				// Flush passes that found something to send
+	uint32_t BytesSaved;			// Against one burst per page from first to last change
+} Framebuffer_Stats_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Framebuffer_Init(void);
+void Framebuffer_Clear(uint8_t Color);
+void Framebuffer_Fill(uint8_t X, uint8_t Y, uint8_t Width, uint8_t Height, uint8_t Color);
+uint8_t Framebuffer_Char(uint8_t X, uint8_t Y, uint8_t Character, uint8_t Foreground, uint8_t Background);
+void Framebuffer_String(uint8_t X, uint8_t Y, const uint8_t *String, uint8_t Foreground, uint8_t Background);
+uint8_t Framebuffer_Flush(void);
+void Framebuffer_GetStats(Framebuffer_Stats_t *Stats);
+void Framebuffer_ResetStats(void);
+
+#endif // FRAMEBUFFER_H
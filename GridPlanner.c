@@ -0,0 +1,378 @@
+/**************************************************************************//**
+ *
+ * @file		GridPlanner.c
+ * @brief		Warehouse grid path planner
+ * @version		1.0
+ *
+ * A* over states of cell and heading, so turns are part of the search rather
+ * than added afterwards. Each state can be reached by a step forward, a step
+ * backward or a quarter turn either way; which one is kept in Via, and that
+ * is enough to walk the path back from the target without storing parents.
+ *
+ * The estimate is the Manhattan distance, plus one turn when the target is
+ * not on the line the robot is facing along. No step can lower it by more
+ * than the step costs, so the first state taken off the open list at the
+ * target is the end of a cheapest plan. Ties go to the state further along,
+ * which keeps the search close to a straight line across open floor.
+ *
+ * Jump point search does not fit here: it relies on every way round an open
+ * area costing the same, and the turn cost is what tells them apart.
+ *
+******************************************************************************/
+
+// Includes
+#include <string.h>
+
+#include "GridPlanner.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define GRIDPLANNER_STATES			(GRIDPLANNER_MAX_WIDTH * GRIDPLANNER_MAX_HEIGHT * GRIDPLANNER_HEADINGS)
+#define GRIDPLANNER_MAP_BYTES		(((GRIDPLANNER_MAX_WIDTH * GRIDPLANNER_MAX_HEIGHT) + 7) / 8)
+#define GRIDPLANNER_NOT_OPEN		0xFFFF
+
+// Flags, one byte per state
+#define GRIDPLANNER_VIA_MASK		0x07					// How the state was reached
+#define GRIDPLANNER_VIA_START		0
+#define GRIDPLANNER_VIA_FORWARD		1
+#define GRIDPLANNER_VIA_BACKWARD	2
+#define GRIDPLANNER_VIA_CLOCKWISE	3
+#define GRIDPLANNER_VIA_ANTICLOCKWISE	4
+#define GRIDPLANNER_SEEN			0x40					// Cost is valid
+#define GRIDPLANNER_CLOSED			0x80
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static uint8_t Map[GRIDPLANNER_MAP_BYTES];
+static uint8_t Width = 0;
+static uint8_t Height = 0;
+static int16_t Left = 0;									// Coordinates of the map's south west cell
+static int16_t Bottom = 0;
+
+// The node pool: every state of the largest map, and the open list as a binary heap of states
+static uint16_t Cost[GRIDPLANNER_STATES];
+static uint8_t Flags[GRIDPLANNER_STATES];
+static uint16_t HeapPosition[GRIDPLANNER_STATES];
+static uint16_t Heap[GRIDPLANNER_STATES];
+static uint16_t HeapLength = 0;
+
+static int16_t TargetX = 0;									// In map cells while a plan is being made
+static int16_t TargetY = 0;
+
+static const int8_t StepX[GRIDPLANNER_HEADINGS] = {0, 1, 0, -1};
+static const int8_t StepY[GRIDPLANNER_HEADINGS] = {1, 0, -1, 0};
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static uint16_t GridPlanner_State(int16_t X, int16_t Y, uint8_t Heading)
+{
+	return (uint16_t)((((Y * Width) + X) * GRIDPLANNER_HEADINGS) + Heading);
+}
+
+static uint8_t GridPlanner_Free(int16_t X, int16_t Y)
+{
+	uint16_t Cell;
+
+	if ((X < 0) || (Y < 0) || (X >= Width) || (Y >= Height))
+		return 0;
+	Cell = (uint16_t)((Y * Width) + X);
+	return (Map[Cell >> 3] & (1U << (Cell & 7))) == 0;
+}
+
+static uint16_t GridPlanner_Estimate(uint16_t State)
+{
+	uint16_t Cell = State / GRIDPLANNER_HEADINGS;
+	uint8_t Heading = State % GRIDPLANNER_HEADINGS;
+	int16_t DeltaX = TargetX - (int16_t)(Cell % Width);
+	int16_t DeltaY = TargetY - (int16_t)(Cell / Width);
+	uint16_t Estimate;
+
+	if (DeltaX < 0)
+		DeltaX = -DeltaX;
+	if (DeltaY < 0)
+		DeltaY = -DeltaY;
+	Estimate = (uint16_t)((DeltaX + DeltaY) * GRIDPLANNER_MOVE_COST);
+
+	// Facing north or south only a turn reaches another column, and the other way round
+	if ((Heading == GRIDPLANNER_NORTH) || (Heading == GRIDPLANNER_SOUTH))
+	{
+		if (DeltaX != 0)
+			Estimate += GRIDPLANNER_TURN_COST;
+	}
+	else if (DeltaY != 0)
+	{
+		Estimate += GRIDPLANNER_TURN_COST;
+	}
+	return Estimate;
+}
+
+// Whether state A should leave the open list before state B
+static uint8_t GridPlanner_Before(uint16_t A, uint16_t B)
+{
+	uint16_t TotalA = Cost[A] + GridPlanner_Estimate(A);
+	uint16_t TotalB = Cost[B] + GridPlanner_Estimate(B);
+
+	if (TotalA != TotalB)
+		return TotalA < TotalB;
+	return Cost[A] > Cost[B];
+}
+
+static void GridPlanner_Place(uint16_t Position, uint16_t State)
+{
+	Heap[Position] = State;
+	HeapPosition[State] = Position;
+}
+
+static void GridPlanner_SiftUp(uint16_t Position)
+{
+	uint16_t State = Heap[Position];
+	uint16_t Parent;
+
+	while (Position > 0)
+	{
+		Parent = (Position - 1) / 2;
+		if (!GridPlanner_Before(State, Heap[Parent]))
+			break;
+		GridPlanner_Place(Position, Heap[Parent]);
+		Position = Parent;
+	}
+	GridPlanner_Place(Position, State);
+}
+
+static uint16_t GridPlanner_Pop(void)
+{
+	uint16_t Top = Heap[0];
+	uint16_t State;
+	uint16_t Position = 0;
+	uint16_t Child;
+
+	HeapPosition[Top] = GRIDPLANNER_NOT_OPEN;
+	if (--HeapLength == 0)
+		return Top;
+
+	State = Heap[HeapLength];
+	for (;;)
+	{
+		Child = (Position * 2) + 1;
+		if (Child >= HeapLength)
+			break;
+		if (((Child + 1) < HeapLength) && GridPlanner_Before(Heap[Child + 1], Heap[Child]))
+			++Child;
+		if (!GridPlanner_Before(Heap[Child], State))
+			break;
+		GridPlanner_Place(Position, Heap[Child]);
+		Position = Child;
+	}
+	GridPlanner_Place(Position, State);
+	return Top;
+}
+
+// Offer State a way in costing NewCost; it joins or moves up the open list if that is cheaper
+static void GridPlanner_Offer(uint16_t State, uint16_t NewCost, uint8_t Via)
+{
+	if ((Flags[State] & GRIDPLANNER_SEEN) && (Cost[State] <= NewCost))
+		return;
+
+	Cost[State] = NewCost;
+	Flags[State] = GRIDPLANNER_SEEN | Via;
+	if (HeapPosition[State] == GRIDPLANNER_NOT_OPEN)
+	{
+		HeapPosition[State] = HeapLength;
+		Heap[HeapLength++] = State;
+	}
+	GridPlanner_SiftUp(HeapPosition[State]);
+}
+
+static void GridPlanner_Expand(uint16_t State)
+{
+	uint16_t Cell = State / GRIDPLANNER_HEADINGS;
+	uint8_t Heading = State % GRIDPLANNER_HEADINGS;
+	int16_t X = (int16_t)(Cell % Width);
+	int16_t Y = (int16_t)(Cell / Width);
+	uint16_t Moved = Cost[State] + GRIDPLANNER_MOVE_COST;
+	uint16_t Turned = Cost[State] + GRIDPLANNER_TURN_COST;
+
+	if (GridPlanner_Free(X + StepX[Heading], Y + StepY[Heading]))
+		GridPlanner_Offer(GridPlanner_State(X + StepX[Heading], Y + StepY[Heading], Heading), Moved, GRIDPLANNER_VIA_FORWARD);
+	if (GridPlanner_Free(X - StepX[Heading], Y - StepY[Heading]))
+		GridPlanner_Offer(GridPlanner_State(X - StepX[Heading], Y - StepY[Heading], Heading), Moved, GRIDPLANNER_VIA_BACKWARD);
+	GridPlanner_Offer((uint16_t)(State - Heading + ((Heading + 1) % GRIDPLANNER_HEADINGS)), Turned, GRIDPLANNER_VIA_CLOCKWISE);
+	GridPlanner_Offer((uint16_t)(State - Heading + ((Heading + 3) % GRIDPLANNER_HEADINGS)), Turned, GRIDPLANNER_VIA_ANTICLOCKWISE);
+}
+
+// Walk back from the target, merging runs of cells into one step. The steps
+// come out last first, so they are reversed at the end. Returns 0 if the plan
+// has more steps than fit.
+static uint8_t GridPlanner_Steps(uint16_t State, GridPlanner_Plan_t *Plan)
+{
+	GridPlanner_Step_t Step;
+	uint16_t Cell;
+	int16_t X;
+	int16_t Y;
+	uint8_t Heading;
+	uint8_t Action;
+	uint8_t i;
+
+	Plan->Length = 0;
+	for (;;)
+	{
+		Cell = State / GRIDPLANNER_HEADINGS;
+		Heading = State % GRIDPLANNER_HEADINGS;
+		X = (int16_t)(Cell % Width);
+		Y = (int16_t)(Cell / Width);
+
+		switch (Flags[State] & GRIDPLANNER_VIA_MASK)
+		{
+			case GRIDPLANNER_VIA_FORWARD:
+				Action = GRIDPLANNER_FORWARD;
+				State = GridPlanner_State(X - StepX[Heading], Y - StepY[Heading], Heading);
+				break;
+			case GRIDPLANNER_VIA_BACKWARD:
+				Action = GRIDPLANNER_BACKWARD;
+				State = GridPlanner_State(X + StepX[Heading], Y + StepY[Heading], Heading);
+				break;
+			case GRIDPLANNER_VIA_CLOCKWISE:
+				Action = GRIDPLANNER_CLOCKWISE;
+				State = (uint16_t)(State - Heading + ((Heading + 3) % GRIDPLANNER_HEADINGS));
+				break;
+			case GRIDPLANNER_VIA_ANTICLOCKWISE:
+				Action = GRIDPLANNER_ANTICLOCKWISE;
+				State = (uint16_t)(State - Heading + ((Heading + 1) % GRIDPLANNER_HEADINGS));
+				break;
+			default:
+				// Back at the start
+				for (i = 0; i < (Plan->Length / 2); ++i)
+				{
+					Step = Plan->Steps[i];
+					Plan->Steps[i] = Plan->Steps[Plan->Length - 1 - i];
+					Plan->Steps[Plan->Length - 1 - i] = Step;
+				}
+				return 1;
+		}
+
+		// Quarter turns stay one to a step, as the motor task turns 90 degrees at a time
+		if ((Plan->Length != 0) && (Action <= GRIDPLANNER_BACKWARD) && (Plan->Steps[Plan->Length - 1].Action == Action)
+			&& (Plan->Steps[Plan->Length - 1].Count != 0xFF))
+		{
+			++Plan->Steps[Plan->Length - 1].Count;
+			continue;
+		}
+		if (Plan->Length == GRIDPLANNER_MAX_STEPS)
+		{
+			Plan->Length = 0;
+			return 0;
+		}
+		Plan->Steps[Plan->Length].Action = Action;
+		Plan->Steps[Plan->Length].Count = 1;
+		++Plan->Length;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Start an empty map of Width by Height cells whose south west cell is at
+// (Left, Bottom). Returns 1 if it fits in GRIDPLANNER_MAX_WIDTH by
+// GRIDPLANNER_MAX_HEIGHT.
+uint8_t GridPlanner_Init(uint8_t NewWidth, uint8_t NewHeight, int16_t NewLeft, int16_t NewBottom)
+{
+	if ((NewWidth == 0) || (NewHeight == 0) || (NewWidth > GRIDPLANNER_MAX_WIDTH) || (NewHeight > GRIDPLANNER_MAX_HEIGHT))
+		return 0;
+
+	Width = NewWidth;
+	Height = NewHeight;
+	Left = NewLeft;
+	Bottom = NewBottom;
+	memset(Map, 0, sizeof(Map));
+	return 1;
+}
+
+// Start a map from Height strings of Width characters, the north row first,
+// with GRIDPLANNER_BLOCKED for each blocked cell
+uint8_t GridPlanner_Load(const char *const *Rows, uint8_t NewWidth, uint8_t NewHeight, int16_t NewLeft, int16_t NewBottom)
+{
+	uint8_t Row;
+	uint8_t Column;
+
+	if (!GridPlanner_Init(NewWidth, NewHeight, NewLeft, NewBottom))
+		return 0;
+
+	for (Row = 0; Row < NewHeight; ++Row)
+	{
+		for (Column = 0; (Column < NewWidth) && (Rows[Row][Column] != '\0'); ++Column)
+		{
+			if (Rows[Row][Column] == GRIDPLANNER_BLOCKED)
+				GridPlanner_SetBlocked(NewLeft + Column, NewBottom + (NewHeight - 1 - Row), 1);
+		}
+	}
+	return 1;
+}
+
+// Cells off the map are left alone
+void GridPlanner_SetBlocked(int X, int Y, uint8_t Blocked)
+{
+	int16_t MapX = (int16_t)(X - Left);
+	int16_t MapY = (int16_t)(Y - Bottom);
+	uint16_t Cell;
+
+	if ((MapX < 0) || (MapY < 0) || (MapX >= Width) || (MapY >= Height))
+		return;
+
+	Cell = (uint16_t)((MapY * Width) + MapX);
+	if (Blocked)
+		Map[Cell >> 3] |= (uint8_t)(1U << (Cell & 7));
+	else
+		Map[Cell >> 3] &= (uint8_t)~(1U << (Cell & 7));
+}
+
+// Cells off the map count as blocked
+uint8_t GridPlanner_IsBlocked(int X, int Y)
+{
+	return !GridPlanner_Free((int16_t)(X - Left), (int16_t)(Y - Bottom));
+}
+
+// Plan the way from (FromX, FromY) facing Heading to (ToX, ToY). Returns 1
+// with the steps in Plan, or 0 if either end is blocked or off the map, there
+// is no way through, or the way needs more than GRIDPLANNER_MAX_STEPS steps.
+uint8_t GridPlanner_Plan(int FromX, int FromY, uint8_t Heading, int ToX, int ToY, GridPlanner_Plan_t *Plan)
+{
+	int16_t StartX = (int16_t)(FromX - Left);
+	int16_t StartY = (int16_t)(FromY - Bottom);
+	uint16_t States = (uint16_t)(Width * Height * GRIDPLANNER_HEADINGS);
+	uint16_t State;
+
+	Plan->Length = 0;
+	Plan->Heading = Heading;
+	Plan->Cost = 0;
+	Plan->Expanded = 0;
+
+	TargetX = (int16_t)(ToX - Left);
+	TargetY = (int16_t)(ToY - Bottom);
+	if ((Heading >= GRIDPLANNER_HEADINGS) || !GridPlanner_Free(StartX, StartY) || !GridPlanner_Free(TargetX, TargetY))
+		return 0;
+
+	memset(Flags, 0, States);
+	memset(HeapPosition, 0xFF, States * sizeof(HeapPosition[0]));
+	HeapLength = 0;
+	GridPlanner_Offer(GridPlanner_State(StartX, StartY, Heading), 0, GRIDPLANNER_VIA_START);
+
+	while (HeapLength != 0)
+	{
+		State = GridPlanner_Pop();
+		Flags[State] |= GRIDPLANNER_CLOSED;
+		++Plan->Expanded;
+
+		if ((State / GRIDPLANNER_HEADINGS) == (uint16_t)((TargetY * Width) + TargetX))
+		{
+			Plan->Heading = State % GRIDPLANNER_HEADINGS;
+			Plan->Cost = Cost[State];
+			return GridPlanner_Steps(State, Plan);
+		}
+		GridPlanner_Expand(State);
+	}
+	return 0;
+}
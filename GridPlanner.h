@@ -0,0 +1,76 @@
+/**************************************************************************//**
+ *
+ * @file		GridPlanner.h
+ * @brief		Header file for the warehouse grid path planner
+ * @version		1.0
+ *
+ * The floor is a grid of cells, each one bit in the map: set for a shelf or
+ * anything else the robot cannot drive through. GridPlanner_Plan finds the
+ * cheapest way from the robot's cell and heading to a target cell and gives
+ * it as drive and quarter turn steps, ready for the motor task.
+ *
+ * A step forward or backward costs GRIDPLANNER_MOVE_COST and a quarter turn
+ * GRIDPLANNER_TURN_COST, so with the defaults the plan is a shortest path and,
+ * of the shortest paths, the one with the fewest turns. Driving backward
+ * counts as much as forward, so the robot never turns round just to reverse.
+ *
+ * All the search state is in fixed arrays sized for the largest map, about
+ * 7 bytes for each cell and heading; nothing is allocated at run time.
+ *
+******************************************************************************/
+
+#ifndef GRIDPLANNER_H
+#define GRIDPLANNER_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define GRIDPLANNER_MAX_WIDTH		16
+#define GRIDPLANNER_MAX_HEIGHT		16
+#define GRIDPLANNER_MAX_STEPS		16						// Steps in one plan, and so the motor queue's length
+
+#define GRIDPLANNER_MOVE_COST		16						// One cell forward or backward
+#define GRIDPLANNER_TURN_COST		1						// One quarter turn
+#define GRIDPLANNER_BLOCKED			'#'						// Marks a blocked cell in GridPlanner_Load's rows
+
+typedef enum {
+	GRIDPLANNER_NORTH,										// Towards +Y, in the same order as main.c's compass
+	GRIDPLANNER_EAST,										// Towards +X
+	GRIDPLANNER_SOUTH,
+	GRIDPLANNER_WEST,
+	GRIDPLANNER_HEADINGS
+} GridPlanner_Heading_t;
+
+typedef enum {
+	GRIDPLANNER_FORWARD,
+	GRIDPLANNER_BACKWARD,
+	GRIDPLANNER_CLOCKWISE,
+	GRIDPLANNER_ANTICLOCKWISE
+} GridPlanner_Action_t;
+
+typedef struct {
+	uint8_t Action;											// A GridPlanner_Action_t
+	uint8_t Count;											// Cells to drive; always 1 for a quarter turn
+} GridPlanner_Step_t;
+
+typedef struct {
+	GridPlanner_Step_t Steps[GRIDPLANNER_MAX_STEPS];
+	uint8_t Length;											// Steps used, 0 if the robot is already there
+	uint8_t Heading;										// Heading at the end, a GridPlanner_Heading_t
+	uint16_t Cost;											// Set even when the way found has too many steps
+	uint16_t Expanded;										// Search states taken off the open list, found or not
+} GridPlanner_Plan_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+uint8_t GridPlanner_Init(uint8_t NewWidth, uint8_t NewHeight, int16_t NewLeft, int16_t NewBottom);
+uint8_t GridPlanner_Load(const char *const *Rows, uint8_t NewWidth, uint8_t NewHeight, int16_t NewLeft, int16_t NewBottom);
+void GridPlanner_SetBlocked(int X, int Y, uint8_t Blocked);
+uint8_t GridPlanner_IsBlocked(int X, int Y);
+uint8_t GridPlanner_Plan(int FromX, int FromY, uint8_t Heading, int ToX, int ToY, GridPlanner_Plan_t *Plan);
+
+#endif // GRIDPLANNER_H
@@ -0,0 +1,136 @@
+/**************************************************************************//**
+ *
+ * @file		ImaAdpcm.c
+ * @brief		IMA-ADPCM block decoder used by WavPlayer
+ * @version		1.0
+ *
+ * Decodes straight to the unsigned 8-bit samples the DAC path uses. Only
+ * shifts, adds and table lookups are needed per sample, so it is cheap enough
+ * for the audio task at 24 kHz. The host encoder in tools/ uses ImaAdpcm_Step
+ * as well, so both sides reconstruct identical predictors.
+ *
+******************************************************************************/
+
+// Includes
+#include "ImaAdpcm.h"
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static const int8_t IndexTable[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+static const uint16_t StepTable[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+	19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+	876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+	5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+// Load the header of the block at Decoder->Block
+static void StartBlock(ImaAdpcm_Decoder_t *Decoder)
+{
+	uint32_t Remaining = (uint32_t)(Decoder->End - Decoder->Block);
+
+	Decoder->SampleIndex = 0;
+	if (Remaining < IMAADPCM_HEADER_SIZE)
+	{
+		Decoder->BlockSamples = 0;
+		Decoder->Block = Decoder->End;
+		return;
+	}
+
+	if (Remaining > Decoder->BlockAlign)
+		Remaining = Decoder->BlockAlign;
+	Decoder->BlockSamples = IMAADPCM_SAMPLES_PER_BLOCK(Remaining);
+	Decoder->Predictor = (int16_t)(Decoder->Block[0] | (Decoder->Block[1] << 8));
+	// Clamped as read, unsigned, so a corrupt header byte of 0x80 or more cannot index below the step table
+	Decoder->StepIndex = (Decoder->Block[2] > 88) ? 88 : (int8_t)Decoder->Block[2];
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void ImaAdpcm_Init(ImaAdpcm_Decoder_t *Decoder, const uint8_t *Data, uint32_t Length, uint16_t BlockAlign)
+{
+	Decoder->Block = Data;
+	Decoder->End = Data + Length;
+	Decoder->BlockAlign = BlockAlign;
+	StartBlock(Decoder);
+}
+
+// Apply one 4-bit code to the predictor and return the new sample
+int16_t ImaAdpcm_Step(int16_t *Predictor, int8_t *StepIndex, uint8_t Code)
+{
+	int32_t Step = StepTable[*StepIndex];
+	int32_t Difference = Step >> 3;
+	int32_t Sample = *Predictor;
+	int32_t Index = *StepIndex + IndexTable[Code & 0x07];
+
+	if (Code & 0x01) Difference += Step >> 2;
+	if (Code & 0x02) Difference += Step >> 1;
+	if (Code & 0x04) Difference += Step;
+
+	if (Code & 0x08)
+		Sample -= Difference;
+	else
+		Sample += Difference;
+
+	if (Sample > 32767) Sample = 32767;
+	else if (Sample < -32768) Sample = -32768;
+
+	if (Index < 0) Index = 0;
+	else if (Index > 88) Index = 88;
+
+	*Predictor = (int16_t)Sample;
+	*StepIndex = (int8_t)Index;
+	return (int16_t)Sample;
+}
+
+// Decode up to Count unsigned 8-bit samples, returning fewer only at the end of the data
+uint32_t ImaAdpcm_Decode(ImaAdpcm_Decoder_t *Decoder, uint8_t *Samples, uint32_t Count)
+{
+	uint32_t Decoded = 0;
+	uint16_t Index;
+	uint8_t Code;
+	int32_t Sample;
+
+	while (Decoded < Count)
+	{
+		if (Decoder->SampleIndex >= Decoder->BlockSamples)
+		{
+			if (Decoder->Block >= Decoder->End)
+				break;
+			Decoder->Block += Decoder->BlockAlign;
+			if (Decoder->Block > Decoder->End)
+				Decoder->Block = Decoder->End;
+			StartBlock(Decoder);
+			continue;
+		}
+
+		Index = Decoder->SampleIndex++;
+		if (Index != 0)
+		{
+			// Sample n (n >= 1) is the low nibble of byte (n - 1) / 2 for odd n, high for even
+			Code = Decoder->Block[IMAADPCM_HEADER_SIZE + ((Index - 1) >> 1)];
+			if ((Index & 1) == 0)
+				Code >>= 4;
+			ImaAdpcm_Step(&Decoder->Predictor, &Decoder->StepIndex, Code & 0x0F);
+		}
+
+		// Round to 8 bits rather than truncate, saturating at the top
+		Sample = (Decoder->Predictor + 0x80) >> 8;
+		if (Sample > 127)
+			Sample = 127;
+		Samples[Decoded++] = (uint8_t)(Sample + 128);
+	}
+
+	return Decoded;
+}
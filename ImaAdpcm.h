@@ -0,0 +1,43 @@
+/**************************************************************************//**
+ *
+ * @file		ImaAdpcm.h
+ * @brief		Header file for the IMA-ADPCM block decoder used by WavPlayer
+ * @version		1.0
+ *
+ * Assets are ordinary RIFF/WAVE images with CompressionCode 0x0011 (mono).
+ * Each block starts with a 4 byte header (first sample, step index, reserved)
+ * followed by two 4-bit codes per byte, low nibble first.
+ *
+******************************************************************************/
+
+#ifndef IMAADPCM_H
+#define IMAADPCM_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define IMAADPCM_HEADER_SIZE		4
+#define IMAADPCM_SAMPLES_PER_BLOCK(BlockAlign)	((((BlockAlign) - IMAADPCM_HEADER_SIZE) * 2) + 1)
+
+// Streaming state, so a block can be decoded across several calls
+typedef struct {
+	const uint8_t *Block;		// Header of the block being decoded
+	const uint8_t *End;			// One past the last byte of data
+	uint16_t BlockAlign;		// Bytes per block
+	uint16_t BlockSamples;		// Samples in the current block (the last one may be short)
+	uint16_t SampleIndex;		// Next sample within the current block
+	int16_t Predictor;			// Last decoded sample
+	int8_t StepIndex;			// Index into the step size table
+} ImaAdpcm_Decoder_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void ImaAdpcm_Init(ImaAdpcm_Decoder_t *Decoder, const uint8_t *Data, uint32_t Length, uint16_t BlockAlign);
+uint32_t ImaAdpcm_Decode(ImaAdpcm_Decoder_t *Decoder, uint8_t *Samples, uint32_t Count);
+int16_t ImaAdpcm_Step(int16_t *Predictor, int8_t *StepIndex, uint8_t Code);
+
+#endif // IMAADPCM_H
@@ -0,0 +1,123 @@
+/**************************************************************************//**
+ *
+ * @file		InputTrace.c
+ * @brief		Joystick and encoder interrupt recorder
+ * @version		1.0
+ *
+ * Only EINT3 writes the log, so recording needs no lock. A record is six
+ * bytes written straight into the file format, which keeps the log small
+ * enough to leave in RAM and means the debugger or the simulation can save
+ * it without any conversion. Edges that arrive together are recorded
+ * together, as the handler sees them.
+ *
+******************************************************************************/
+
+// Includes
+#include "LPC17xx.h"
+#include "LPC17xx_GPIO.h"
+
+#include "InputTrace.h"
+#include "Uptime.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define INPUTTRACE_MAX_DELTA		0xFFFFFFFFUL			// A gap over 71 minutes is recorded as 71 minutes
+
+//------------------------------------------------------------------------------
+
+// Local variables
+
+// The pins main.c wires each input to; all but the right button interrupt on the rising edge
+const InputTrace_Pin_t InputTrace_Pins[INPUTTRACE_INPUTS] = {
+	{2, 1UL << 3},				// Joystick up
+	{0, 1UL << 15},				// Joystick down
+	{2, 1UL << 4},				// Joystick left
+	{0, 1UL << 16},				// Joystick right
+	{0, 1UL << 17},				// Joystick centre
+	{0, 1UL << 4},				// Left button
+	{2, 1UL << 11},				// Left wheel encoder
+	{2, 1UL << 12},				// Right wheel encoder
+	{1, 1UL << 31},				// Right button, low while held
+};
+
+uint8_t InputTrace_Log[INPUTTRACE_BYTES];
+static uint32_t Count = 0;
+static uint32_t Dropped = 0;
+static uint64_t Last = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static void InputTrace_Put32(uint8_t *Out, uint32_t Value)
+{
+	Out[0] = (uint8_t)Value;
+	Out[1] = (uint8_t)(Value >> 8);
+	Out[2] = (uint8_t)(Value >> 16);
+	Out[3] = (uint8_t)(Value >> 24);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Start an empty trace. Call after Uptime_Init, before EINT3 is enabled.
+void InputTrace_Init(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < 4; ++i)
+		InputTrace_Log[i] = (uint8_t)INPUTTRACE_MAGIC[i];
+	Count = 0;
+	Dropped = 0;
+	Last = 0;
+	InputTrace_Put32(&InputTrace_Log[4], 0);
+	InputTrace_Put32(&InputTrace_Log[8], 0);
+}
+
+// Note the inputs EINT3 is about to handle. Called from EINT3_IRQHandler.
+void InputTrace_Record(void)
+{
+	uint32_t Rising[3];
+	uint16_t Inputs = 0;
+	uint64_t Now = Uptime_Micros();
+	uint64_t Delta = Now - Last;
+	uint8_t *Record;
+	uint8_t i;
+
+	Rising[0] = LPC_GPIOINT->IO0IntStatR;
+	Rising[1] = 0;
+	Rising[2] = LPC_GPIOINT->IO2IntStatR;
+
+	for (i = 0; i < INPUTTRACE_RBUTTON; ++i)
+	{
+		if (Rising[InputTrace_Pins[i].Port] & InputTrace_Pins[i].Pin)
+			Inputs |= (1U << i);
+	}
+	if ((GPIO_ReadValue(InputTrace_Pins[INPUTTRACE_RBUTTON].Port) & InputTrace_Pins[INPUTTRACE_RBUTTON].Pin) == 0)
+		Inputs |= (1U << INPUTTRACE_RBUTTON);
+
+	// Nothing the handler acts on
+	if ((Inputs & ~(1U << INPUTTRACE_RBUTTON)) == 0)
+		return;
+
+	if (Count == INPUTTRACE_EVENTS)
+	{
+		InputTrace_Put32(&InputTrace_Log[8], ++Dropped);
+		return;
+	}
+
+	Record = &InputTrace_Log[INPUTTRACE_HEADER + (Count * INPUTTRACE_RECORD_BYTES)];
+	InputTrace_Put32(Record, (Delta > INPUTTRACE_MAX_DELTA) ? INPUTTRACE_MAX_DELTA : (uint32_t)Delta);
+	Record[4] = (uint8_t)Inputs;
+	Record[5] = (uint8_t)(Inputs >> 8);
+	Last = Now;
+
+	InputTrace_Put32(&InputTrace_Log[4], ++Count);
+}
+
+// Bytes of InputTrace_Log in use, header included
+uint32_t InputTrace_Length(void)
+{
+	return INPUTTRACE_HEADER + (Count * INPUTTRACE_RECORD_BYTES);
+}
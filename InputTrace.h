@@ -0,0 +1,79 @@
+/**************************************************************************//**
+ *
+ * @file		InputTrace.h
+ * @brief		Header file for the joystick and encoder interrupt recorder
+ * @version		1.0
+ *
+ * EINT3_IRQHandler calls INPUTTRACE_RECORD() on entry, which notes which of
+ * the inputs below have a pending edge and the time from Uptime_Micros. The
+ * trace is kept in RAM already in its file format, so on the board it can be
+ * saved with the debugger, e.g.
+ *
+ *		dump binary memory trace.bin InputTrace_Log InputTrace_Log+6156
+ *
+ * and the simulation writes it with -r. Replaying it with the simulation's
+ * -p option drives the same edges into EINT3_IRQHandler at the same times.
+ *
+ * File format, all little endian:
+ *		Header	"ITR1", uint32_t Count, uint32_t Dropped
+ *		Count records of uint32_t Delta, uint16_t Inputs
+ * Delta is microseconds since the previous record (since Uptime_Init for the
+ * first) and Inputs has a bit per InputTrace_Input_t. The trace stops when it
+ * is full, keeping the start of the session; Dropped counts the rest.
+ *
+ * Removing INPUTTRACE_ENABLE compiles the recorder out altogether.
+ *
+******************************************************************************/
+
+#ifndef INPUTTRACE_H
+#define INPUTTRACE_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define INPUTTRACE_ENABLE									// Record EINT3's inputs
+
+#define INPUTTRACE_EVENTS			1024					// Records kept, about 20 s of driving
+#define INPUTTRACE_MAGIC			"ITR1"
+#define INPUTTRACE_HEADER			12						// Bytes before the first record
+#define INPUTTRACE_RECORD_BYTES		6
+#define INPUTTRACE_BYTES			(INPUTTRACE_HEADER + (INPUTTRACE_EVENTS * INPUTTRACE_RECORD_BYTES))
+
+typedef enum {
+	INPUTTRACE_UP,
+	INPUTTRACE_DOWN,
+	INPUTTRACE_LEFT,
+	INPUTTRACE_RIGHT,
+	INPUTTRACE_CENTER,
+	INPUTTRACE_LBUTTON,
+	INPUTTRACE_ENCODER_LEFT,
+	INPUTTRACE_ENCODER_RIGHT,
+	INPUTTRACE_RBUTTON,										// Held down, not an edge: EINT3 reads its level
+	INPUTTRACE_INPUTS
+} InputTrace_Input_t;
+
+typedef struct {
+	uint8_t Port;
+	uint32_t Pin;
+} InputTrace_Pin_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+extern const InputTrace_Pin_t InputTrace_Pins[INPUTTRACE_INPUTS];
+extern uint8_t InputTrace_Log[INPUTTRACE_BYTES];
+
+void InputTrace_Init(void);
+void InputTrace_Record(void);
+uint32_t InputTrace_Length(void);
+
+#ifdef INPUTTRACE_ENABLE
+#define INPUTTRACE_RECORD()			InputTrace_Record()
+#else
+#define INPUTTRACE_RECORD()
+#endif
+
+#endif // INPUTTRACE_H
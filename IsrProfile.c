@@ -0,0 +1,139 @@
+/**************************************************************************//**
+ *
+ * @file		IsrProfile.c
+ * @brief		Cycle-accurate interrupt cost measurement
+ * @version		1.0
+ *
+ * IsrProfile_Record runs at the end of every instrumented handler, so it only
+ * does compares, adds and one count-leading-zeros. A handler that is itself
+ * interrupted is charged for the nested handler's cycles too.
+ *
+******************************************************************************/
+
+// Includes
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#include "IsrProfile.h"
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static IsrProfile_Stats_t Stats[ISRPROFILE_SOURCES];
+static uint32_t WindowStart = 0;					// Cycle count when the window opened
+static uint32_t IdleCycles = 0;
+static uint32_t IdleLast = 0;						// Cycle count at the last idle hook call
+
+static const char *Names[ISRPROFILE_SOURCES] = {"EINT3", "TIMER0", "DMA"};
+
+#ifdef ISRPROFILE_HOST
+volatile uint32_t IsrProfile_HostCycles = 0;
+#endif
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static void IsrProfile_Clear(void)
+{
+	uint8_t i;
+	uint8_t b;
+
+	for (i = 0; i < ISRPROFILE_SOURCES; ++i)
+	{
+		Stats[i].Count = 0;
+		Stats[i].Min = 0xFFFFFFFF;
+		Stats[i].Max = 0;
+		Stats[i].Cycles = 0;
+		for (b = 0; b < ISRPROFILE_BUCKETS; ++b)
+			Stats[i].Histogram[b] = 0;
+	}
+	IdleCycles = 0;
+	WindowStart = IsrProfile_Now();
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void IsrProfile_Init(void)
+{
+#ifndef ISRPROFILE_HOST
+	// Trace has to be enabled before the DWT counts anything
+	ISRPROFILE_DEMCR |= (1UL << 24);
+	ISRPROFILE_DWT_CYCCNT = 0;
+	ISRPROFILE_DWT_CTRL |= 1UL;
+#endif
+	IsrProfile_Clear();
+}
+
+// Fold one handler run into its source's figures. Called from interrupts.
+void IsrProfile_Record(uint8_t Source, uint32_t Cycles)
+{
+	IsrProfile_Stats_t *Entry = &Stats[Source];
+	uint32_t Bucket = Cycles >> ISRPROFILE_BUCKET_SHIFT;
+
+	++Entry->Count;
+	Entry->Cycles += Cycles;
+	if (Cycles < Entry->Min)
+		Entry->Min = Cycles;
+	if (Cycles > Entry->Max)
+		Entry->Max = Cycles;
+
+	Bucket = (Bucket == 0) ? 0 : (32 - __builtin_clz(Bucket));
+	if (Bucket >= ISRPROFILE_BUCKETS)
+		Bucket = ISRPROFILE_BUCKETS - 1;
+	++Entry->Histogram[Bucket];
+}
+
+// Count the time since the last call as idle, unless it was long enough for
+// another task or a long interrupt to have run in between. Called from the
+// idle hook, so the idle task has to call it at least every ISRPROFILE_IDLE_GAP
+// cycles when nothing else is running: keep the rest of the hook short.
+void IsrProfile_Idle(void)
+{
+	uint32_t Now = IsrProfile_Now();
+	uint32_t Gap = Now - IdleLast;
+
+	IdleLast = Now;
+	if (Gap < ISRPROFILE_IDLE_GAP)
+		IdleCycles += Gap;
+}
+
+// Copy out the figures since the last report and start a new window. The
+// window has to be reported at least every 40 s, before the counter wraps.
+void IsrProfile_Report(IsrProfile_Report_t *Report)
+{
+	uint32_t Total = 0;
+	uint32_t Idle;
+	uint8_t i;
+
+	taskENTER_CRITICAL();
+		for (i = 0; i < ISRPROFILE_SOURCES; ++i)
+			Report->Stats[i] = Stats[i];
+		Idle = IdleCycles;
+		Report->Elapsed = IsrProfile_Now() - WindowStart;
+		IsrProfile_Clear();
+	taskEXIT_CRITICAL();
+
+	for (i = 0; i < ISRPROFILE_SOURCES; ++i)
+	{
+		if (Report->Stats[i].Count == 0)
+			Report->Stats[i].Min = 0;
+		Report->Load[i] = (Report->Elapsed == 0) ? 0 : (uint16_t)(((uint64_t)Report->Stats[i].Cycles * 1000) / Report->Elapsed);
+		Total += Report->Load[i];
+	}
+	Report->TotalLoad = (uint16_t)Total;
+	Report->IdleLoad = (Report->Elapsed == 0) ? 0 : (uint16_t)(((uint64_t)Idle * 1000) / Report->Elapsed);
+}
+
+const char* IsrProfile_Name(uint8_t Source)
+{
+	return (Source < ISRPROFILE_SOURCES) ? Names[Source] : "?";
+}
+
+#ifdef ISRPROFILE_HOST
+// Simulation stand-in for the passing of CPU cycles
+void IsrProfile_HostAdvance(uint32_t Cycles)
+{
+	IsrProfile_HostCycles += Cycles;
+}
+#endif
@@ -0,0 +1,98 @@
+/**************************************************************************//**
+ *
+ * @file		IsrProfile.h
+ * @brief		Header file for cycle-accurate interrupt cost measurement
+ * @version		1.0
+ *
+ * Each instrumented handler starts with ISRPROFILE_ENTER() and ends with
+ * ISRPROFILE_EXIT(Source). The cycles in between are read from the Cortex-M3
+ * DWT cycle counter and folded into per-source count, min, max, total and a
+ * log2 histogram. IsrProfile_Report turns a window of that into load figures.
+ *
+ * Called from vApplicationIdleHook, IsrProfile_Idle adds up the cycles the
+ * idle task spends going round its loop, which gives the share of the CPU
+ * nothing else wanted.
+ *
+ * Simulation builds define ISRPROFILE_HOST and advance a software counter
+ * with IsrProfile_HostAdvance instead. Removing ISRPROFILE_ENABLE compiles
+ * the instrumentation out altogether.
+ *
+******************************************************************************/
+
+#ifndef ISRPROFILE_H
+#define ISRPROFILE_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define ISRPROFILE_ENABLE									// Measure the instrumented handlers
+
+#define ISRPROFILE_BUCKETS			12						// Histogram buckets, doubling in width
+#define ISRPROFILE_BUCKET_SHIFT		6						// The first bucket holds anything under 64 cycles
+#define ISRPROFILE_IDLE_GAP			512						// Longer between idle hook calls means something else ran
+
+#ifndef ISRPROFILE_HOST
+#define ISRPROFILE_DEMCR			(*(volatile uint32_t*)0xE000EDFC)	// CoreDebug DEMCR, TRCENA is bit 24
+#define ISRPROFILE_DWT_CTRL			(*(volatile uint32_t*)0xE0001000)	// CYCCNTENA is bit 0
+#define ISRPROFILE_DWT_CYCCNT		(*(volatile uint32_t*)0xE0001004)
+#endif
+
+typedef enum {
+	ISRPROFILE_EINT3,
+	ISRPROFILE_TIMER0,
+	ISRPROFILE_DMA,
+	ISRPROFILE_SOURCES
+} IsrProfile_Source_t;
+
+typedef struct {
+	uint32_t Count;
+	uint32_t Min;
+	uint32_t Max;
+	uint32_t Cycles;							// Total over the window
+	uint32_t Histogram[ISRPROFILE_BUCKETS];		// Bucket n holds up to (64 << n) cycles
+} IsrProfile_Stats_t;
+
+typedef struct {
+	IsrProfile_Stats_t Stats[ISRPROFILE_SOURCES];
+	uint32_t Elapsed;							// Cycles covered by the window
+	uint16_t Load[ISRPROFILE_SOURCES];			// Share of the window in each handler, per mille
+	uint16_t TotalLoad;							// Per mille
+	uint16_t IdleLoad;							// Share of the window in the idle task, per mille
+} IsrProfile_Report_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void IsrProfile_Init(void);
+void IsrProfile_Record(uint8_t Source, uint32_t Cycles);
+void IsrProfile_Idle(void);
+void IsrProfile_Report(IsrProfile_Report_t *Report);
+const char* IsrProfile_Name(uint8_t Source);
+
+#ifdef ISRPROFILE_HOST
+extern volatile uint32_t IsrProfile_HostCycles;
+void IsrProfile_HostAdvance(uint32_t Cycles);
+
+static inline uint32_t IsrProfile_Now(void)
+{
+	return IsrProfile_HostCycles;
+}
+#else
+static inline uint32_t IsrProfile_Now(void)
+{
+	return ISRPROFILE_DWT_CYCCNT;
+}
+#endif
+
+#ifdef ISRPROFILE_ENABLE
+#define ISRPROFILE_ENTER()			uint32_t IsrProfileStart = IsrProfile_Now()
+#define ISRPROFILE_EXIT(Source)		IsrProfile_Record((Source), IsrProfile_Now() - IsrProfileStart)
+#else
+#define ISRPROFILE_ENTER()
+#define ISRPROFILE_EXIT(Source)
+#endif
+
+#endif // ISRPROFILE_H
@@ -0,0 +1,290 @@
+/**************************************************************************//**
+ *
+ * @file		Playlist.c
+ * @brief		Gapless song queue played through WavPlayer
+ * @version		1.0
+ *
+ * Tracks are kept as parsed descriptors, so moving on never has to look at a
+ * RIFF header. Playlist_Advance is handed to WavPlayer_SetNextTrack and runs in
+ * the audio task; everything else runs in the calling task. Both sides only
+ * touch the list inside short critical sections.
+ *
+******************************************************************************/
+
+// Includes
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Queue.h"
+
+#include "Playlist.h"
+#include "WavPlayer.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define PLAYLIST_EVENTS			8			// Events waiting for Playlist_WaitEvent
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static WavFormat_Descriptor_t Tracks[PLAYLIST_SIZE];
+static uint8_t Count = 0;					// Tracks queued
+static uint8_t Current = 0;					// Track playing, or to play first; PLAYLIST_NONE once cleared under a playing song
+static uint8_t Staged = PLAYLIST_NONE;		// Track to follow Current
+static uint16_t Played = 0;					// Tracks already played this round, for shuffle
+static uint8_t Loop = 0;
+static uint8_t Shuffle = 0;
+static volatile uint8_t Playing = 0;
+static uint32_t Seed = 0x2545F491;			// Shuffle state, any non-zero value
+static xQueueHandle EventQueue = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// xorshift32, plenty for picking the next song
+static uint32_t Playlist_Random(void)
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+// Work out the track to follow Current. Called inside a critical section.
+static void Playlist_Stage(void)
+{
+	uint16_t All = (uint16_t)((1U << Count) - 1);
+	uint8_t Left = 0;
+	uint8_t Pick;
+	uint8_t i;
+
+	Staged = PLAYLIST_NONE;
+	if (Count == 0)
+		return;
+
+	if (Shuffle == 0)
+	{
+		// After a clear the song playing is not in the list, so the list's first track follows it
+		if (Current == PLAYLIST_NONE)
+			Staged = 0;
+		else if (Current + 1 < Count)
+			Staged = Current + 1;
+		else if (Loop)
+			Staged = 0;
+		return;
+	}
+
+	// Every track once per round, in a random order
+	if ((Played & All) == All)
+	{
+		if (Loop == 0)
+			return;
+		// Start a new round, without repeating the current track straight away
+		Played = ((Count > 1) && (Current < Count)) ? (uint16_t)(1U << Current) : 0;
+	}
+
+	for (i = 0; i < Count; ++i)
+	{
+		if ((Played & (1U << i)) == 0)
+			++Left;
+	}
+
+	Pick = (uint8_t)(Playlist_Random() % Left);
+	for (i = 0; i < Count; ++i)
+	{
+		if ((Played & (1U << i)) == 0)
+		{
+			if (Pick == 0)
+			{
+				Staged = i;
+				return;
+			}
+			--Pick;
+		}
+	}
+}
+
+// Move on to the staged track, copying it out. Called inside a critical section.
+static uint8_t Playlist_TakeStaged(WavFormat_Descriptor_t *Next)
+{
+	if ((Playing == 0) || (Staged == PLAYLIST_NONE))
+		return 0;
+
+	Current = Staged;
+	Played |= (uint16_t)(1U << Current);
+	*Next = Tracks[Current];
+	Playlist_Stage();
+	return 1;
+}
+
+static void Playlist_Post(uint8_t Type, uint8_t Track)
+{
+	Playlist_Event_t Event;
+
+	Event.Type = Type;
+	Event.Track = Track;
+	xQueueSendToBack(EventQueue, &Event, 0);
+}
+
+// WavPlayer next track callback, run by the audio task when a song runs out
+static uint8_t Playlist_Advance(WavFormat_Descriptor_t *Next)
+{
+	uint8_t Started = 0;
+	uint8_t Track;
+
+	taskENTER_CRITICAL();
+		if (Next != 0)
+			Started = Playlist_TakeStaged(Next);
+		Track = Current;
+		if (Started == 0)
+		{
+			// Start from the top next time
+			Playing = 0;
+			Current = 0;
+		}
+	taskEXIT_CRITICAL();
+
+	if (Started)
+		Playlist_Post(PLAYLIST_EVENT_TRACK, Track);
+	else
+		Playlist_Post((Next != 0) ? PLAYLIST_EVENT_END : PLAYLIST_EVENT_STOPPED, Track);
+	return Started;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Playlist_Init(void)
+{
+	EventQueue = xQueueCreate(PLAYLIST_EVENTS, sizeof(Playlist_Event_t));
+	WavPlayer_SetNextTrack(Playlist_Advance);
+}
+
+// Add a track to the end of the list. Returns 0 if the list is full.
+uint8_t Playlist_Enqueue(const WavFormat_Descriptor_t *Descriptor)
+{
+	uint8_t Added = 0;
+
+	taskENTER_CRITICAL();
+		if (Count < PLAYLIST_SIZE)
+		{
+			Tracks[Count++] = *Descriptor;
+			Added = 1;
+			// The playing track may have been the last one
+			if (Playing && (Staged == PLAYLIST_NONE))
+				Playlist_Stage();
+		}
+	taskEXIT_CRITICAL();
+
+	return Added;
+}
+
+// As Playlist_Enqueue, for a RIFF/WAVE image. Returns 0 if it cannot be played.
+uint8_t Playlist_EnqueueWav(const uint8_t *WavArray, const uint32_t Length)
+{
+	const WavFormat_Descriptor_t *Descriptor;
+
+	Descriptor = WavPlayer_GetDescriptor(WavArray, Length);
+	if (Descriptor == 0)
+		return 0;
+	return Playlist_Enqueue(Descriptor);
+}
+
+// Empty the list. The current song plays to its end, then the first track queued after this, if any.
+void Playlist_Clear(void)
+{
+	taskENTER_CRITICAL();
+		Count = 0;
+		Current = Playing ? PLAYLIST_NONE : 0;
+		Staged = PLAYLIST_NONE;
+		Played = 0;
+	taskEXIT_CRITICAL();
+}
+
+// Start playing from the current track, taking over the music voice
+void Playlist_Play(void)
+{
+	WavFormat_Descriptor_t Descriptor;
+	uint8_t Track;
+
+	taskENTER_CRITICAL();
+		if (Count == 0)
+		{
+			taskEXIT_CRITICAL();
+			return;
+		}
+		if (Current >= Count)
+			Current = 0;
+		Track = Current;
+		Played = (uint16_t)(1U << Current);
+		Playing = 1;
+		Descriptor = Tracks[Current];
+		Playlist_Stage();
+	taskEXIT_CRITICAL();
+
+	WavPlayer_PlayDescriptor(&Descriptor);
+	Playlist_Post(PLAYLIST_EVENT_TRACK, Track);
+}
+
+// Cut the current track short and move on, if there is anything to move on to
+void Playlist_Skip(void)
+{
+	WavFormat_Descriptor_t Descriptor;
+	uint8_t Started;
+	uint8_t Track;
+
+	taskENTER_CRITICAL();
+		Started = Playlist_TakeStaged(&Descriptor);
+		Track = Current;
+	taskEXIT_CRITICAL();
+
+	if (Started)
+	{
+		WavPlayer_PlayDescriptor(&Descriptor);
+		Playlist_Post(PLAYLIST_EVENT_TRACK, Track);
+	}
+}
+
+void Playlist_SetLoop(uint8_t NewLoop)
+{
+	taskENTER_CRITICAL();
+		Loop = NewLoop;
+		if (Playing)
+			Playlist_Stage();
+	taskEXIT_CRITICAL();
+}
+
+void Playlist_SetShuffle(uint8_t NewShuffle)
+{
+	taskENTER_CRITICAL();
+		Shuffle = NewShuffle;
+		if (Playing)
+			Playlist_Stage();
+	taskEXIT_CRITICAL();
+}
+
+uint8_t Playlist_IsPlaying(void)
+{
+	return Playing;
+}
+
+// Block until something happens to the playlist. Returns 0 on timeout.
+uint8_t Playlist_WaitEvent(Playlist_Event_t *Event, portTickType Timeout)
+{
+	if (xQueueReceive(EventQueue, Event, Timeout) == pdPASS)
+		return 1;
+	return 0;
+}
+
+// Ask whoever waits on the playlist to start it, e.g. from a button interrupt
+void Playlist_RequestStartFromISR(void)
+{
+	Playlist_Event_t Event;
+	portBASE_TYPE HigherPriorityTaskWoken = pdFALSE;
+
+	Event.Type = PLAYLIST_EVENT_START;
+	Event.Track = PLAYLIST_NONE;
+	xQueueSendToBackFromISR(EventQueue, &Event, &HigherPriorityTaskWoken);
+	portEND_SWITCHING_ISR(HigherPriorityTaskWoken);
+}
@@ -0,0 +1,53 @@
+/**************************************************************************//**
+ *
+ * @file		Playlist.h
+ * @brief		Header file for the gapless song queue played through WavPlayer
+ * @version		1.0
+ *
+ * The track after the current one is always worked out in advance, so when a
+ * song runs out the audio task can carry straight on with the next one in the
+ * same block. Tasks follow playback by waiting on Playlist_WaitEvent.
+ *
+******************************************************************************/
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+// Includes
+#include "FreeRTOS.h"
+#include "WavFormat.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define PLAYLIST_SIZE			8			// Songs that can be queued
+#define PLAYLIST_NONE			0xFF		// No track
+
+typedef enum {
+	PLAYLIST_EVENT_START,		// Someone asked for the playlist to start
+	PLAYLIST_EVENT_TRACK,		// A track has started, Track is its index
+	PLAYLIST_EVENT_END,			// The last track has finished
+	PLAYLIST_EVENT_STOPPED		// Playback was cut off by the stop button
+} Playlist_EventType_t;
+
+typedef struct {
+	uint8_t Type;				// Playlist_EventType_t
+	uint8_t Track;
+} Playlist_Event_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Playlist_Init(void);
+uint8_t Playlist_Enqueue(const WavFormat_Descriptor_t *Descriptor);
+uint8_t Playlist_EnqueueWav(const uint8_t *WavArray, const uint32_t Length);
+void Playlist_Clear(void);
+void Playlist_Play(void);
+void Playlist_Skip(void);
+void Playlist_SetLoop(uint8_t Loop);
+void Playlist_SetShuffle(uint8_t Shuffle);
+uint8_t Playlist_IsPlaying(void);
+uint8_t Playlist_WaitEvent(Playlist_Event_t *Event, portTickType Timeout);
+void Playlist_RequestStartFromISR(void);
+
+#endif // PLAYLIST_H
@@ -0,0 +1,163 @@
+/**************************************************************************//**
+ *
+ * @file		RouteLatency.c
+ * @brief		Joystick centre to motor latency benchmark
+ * @version		1.0
+ *
+ * The stages of a route follow one another through the state machine in
+ * main.c, so only one route is ever being timed and a mark needs no lock.
+ * RouteLatency_Report copies each stage's samples out under a critical
+ * section and sorts the copy, which is why it belongs in a task.
+ *
+******************************************************************************/
+
+// Includes
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+
+#include "RouteLatency.h"
+#include "Uptime.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define ROUTELATENCY_LONGEST		0xFFFFFFFFUL			// A stage over 71 minutes after its press counts as 71 minutes
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static uint32_t Samples[ROUTELATENCY_STAGES][ROUTELATENCY_SAMPLES];
+static uint32_t Count[ROUTELATENCY_STAGES];
+static uint32_t Max[ROUTELATENCY_STAGES];
+static uint64_t PressTime = 0;
+static uint8_t Reached = 0;							// Stages this route has marked, one bit each
+static uint32_t NoRoute = 0;						// Presses that ended without a route
+
+static uint32_t Sorted[ROUTELATENCY_SAMPLES];		// Report's copy, kept off the caller's stack
+
+static const char *Names[ROUTELATENCY_STAGES] = {"press", "routed", "dequeue", "drive"};
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static void RouteLatency_Sort(uint32_t *Values, uint32_t Length)
+{
+	uint32_t Value;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 1; i < Length; ++i)
+	{
+		Value = Values[i];
+		for (j = i; (j > 0) && (Values[j - 1] > Value); --j)
+			Values[j] = Values[j - 1];
+		Values[j] = Value;
+	}
+}
+
+// Nearest rank, so the 99th percentile of fewer than 100 samples is the largest
+static uint32_t RouteLatency_Percentile(const uint32_t *Values, uint32_t Length, uint32_t Percent)
+{
+	if (Length == 0)
+		return 0;
+	return Values[(((Length * Percent) + 99) / 100) - 1];
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void RouteLatency_Init(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < ROUTELATENCY_STAGES; ++i)
+	{
+		Count[i] = 0;
+		Max[i] = 0;
+	}
+	NoRoute = 0;
+	Reached = 0;
+}
+
+// Note that a route has reached Stage. Called from EINT3 and the routing and motor tasks.
+void RouteLatency_Mark(uint8_t Stage)
+{
+	uint64_t Now = Uptime_Micros();
+	uint64_t Latency;
+
+	if (Stage == ROUTELATENCY_PRESS)
+	{
+		PressTime = Now;
+		Reached = (1U << ROUTELATENCY_PRESS);
+		++Count[ROUTELATENCY_PRESS];
+		return;
+	}
+
+	// Only the first time in a route, and only once there has been a press
+	if ((Stage >= ROUTELATENCY_STAGES) || ((Reached & (1U << ROUTELATENCY_PRESS)) == 0) || (Reached & (1U << Stage)))
+		return;
+	Reached |= (1U << Stage);
+
+	Latency = Now - PressTime;
+	if (Latency > ROUTELATENCY_LONGEST)
+		Latency = ROUTELATENCY_LONGEST;
+
+	Samples[Stage][Count[Stage] % ROUTELATENCY_SAMPLES] = (uint32_t)Latency;
+	++Count[Stage];
+	if ((uint32_t)Latency > Max[Stage])
+		Max[Stage] = (uint32_t)Latency;
+}
+
+// End the current route without a plan, so its press is not left unfinished.
+// Called from the routing task.
+void RouteLatency_NoRoute(void)
+{
+	taskENTER_CRITICAL();
+		if (Reached == (1U << ROUTELATENCY_PRESS))
+		{
+			++NoRoute;
+			Reached = 0;
+		}
+	taskEXIT_CRITICAL();
+}
+
+// Work out each stage's figures over the routes remembered. Unlike the
+// interrupt figures these are not windowed: every route counts until
+// ROUTELATENCY_SAMPLES newer ones have pushed it out.
+void RouteLatency_Report(RouteLatency_Report_t *Report)
+{
+	RouteLatency_Stats_t *Stats;
+	uint32_t Length;
+	uint8_t i;
+
+	Report->Stats[ROUTELATENCY_PRESS].Count = Count[ROUTELATENCY_PRESS];
+	Report->Stats[ROUTELATENCY_PRESS].P50 = 0;
+	Report->Stats[ROUTELATENCY_PRESS].P99 = 0;
+	Report->Stats[ROUTELATENCY_PRESS].Max = 0;
+
+	for (i = ROUTELATENCY_PRESS + 1; i < ROUTELATENCY_STAGES; ++i)
+	{
+		Stats = &Report->Stats[i];
+
+		taskENTER_CRITICAL();
+			Stats->Count = Count[i];
+			Stats->Max = Max[i];
+			Length = (Count[i] < ROUTELATENCY_SAMPLES) ? Count[i] : ROUTELATENCY_SAMPLES;
+			memcpy(Sorted, Samples[i], Length * sizeof(uint32_t));
+		taskEXIT_CRITICAL();
+
+		RouteLatency_Sort(Sorted, Length);
+		Stats->P50 = RouteLatency_Percentile(Sorted, Length, 50);
+		Stats->P99 = RouteLatency_Percentile(Sorted, Length, 99);
+	}
+
+	Report->NoRoute = NoRoute;
+	Report->Unfinished = Report->Stats[ROUTELATENCY_PRESS].Count - Report->Stats[ROUTELATENCY_DRIVEN].Count - NoRoute;
+}
+
+const char* RouteLatency_Name(uint8_t Stage)
+{
+	return (Stage < ROUTELATENCY_STAGES) ? Names[Stage] : "?";
+}
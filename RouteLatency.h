@@ -0,0 +1,71 @@
+/**************************************************************************//**
+ *
+ * @file		RouteLatency.h
+ * @brief		Header file for the joystick centre to motor latency benchmark
+ * @version		1.0
+ *
+ * A route starts with ROUTELATENCY_MARK(ROUTELATENCY_PRESS) where EINT3 sees
+ * the centre press, and each later stage marks itself the first time it is
+ * reached in that route: the route queued for the motors, the first
+ * instruction taken off that queue and the first DFR_Drive call. Each mark
+ * is the uptime in microseconds since the press, and the last
+ * ROUTELATENCY_SAMPLES of them for each stage are kept, so
+ * RouteLatency_Report can give the median and the 99th percentile. A press
+ * that finds nothing to drive ends its route with ROUTELATENCY_NO_ROUTE().
+ *
+ * Removing ROUTELATENCY_ENABLE compiles the marks out altogether.
+ *
+******************************************************************************/
+
+#ifndef ROUTELATENCY_H
+#define ROUTELATENCY_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define ROUTELATENCY_ENABLE									// Time the instrumented stages
+
+#define ROUTELATENCY_SAMPLES		64						// Routes remembered for each stage
+
+typedef enum {
+	ROUTELATENCY_PRESS,										// Centre press seen in EINT3
+	ROUTELATENCY_ROUTED,									// Route queued for the motors
+	ROUTELATENCY_DEQUEUED,									// First instruction taken off the queue
+	ROUTELATENCY_DRIVEN,									// First DFR_Drive call
+	ROUTELATENCY_STAGES
+} RouteLatency_Stage_t;
+
+typedef struct {
+	uint32_t Count;											// Routes that reached the stage
+	uint32_t P50;											// Microseconds from the press, over the samples kept
+	uint32_t P99;
+	uint32_t Max;
+} RouteLatency_Stats_t;
+
+typedef struct {
+	RouteLatency_Stats_t Stats[ROUTELATENCY_STAGES];		// The press has a count and no times
+	uint32_t NoRoute;										// Presses already there or with no way there
+	uint32_t Unfinished;									// Presses that have not reached a drive or ended, the current one included
+} RouteLatency_Report_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void RouteLatency_Init(void);
+void RouteLatency_Mark(uint8_t Stage);
+void RouteLatency_NoRoute(void);
+void RouteLatency_Report(RouteLatency_Report_t *Report);
+const char* RouteLatency_Name(uint8_t Stage);
+
+#ifdef ROUTELATENCY_ENABLE
+#define ROUTELATENCY_MARK(Stage)	RouteLatency_Mark(Stage)
+#define ROUTELATENCY_NO_ROUTE()		RouteLatency_NoRoute()
+#else
+#define ROUTELATENCY_MARK(Stage)
+#define ROUTELATENCY_NO_ROUTE()
+#endif
+
+#endif // ROUTELATENCY_H
@@ -0,0 +1,45 @@
+/**************************************************************************//**
+ *
+ * @file		SampleClock.c
+ * @brief		Fractional sample rate generator
+ * @version		1.0
+ *
+ * A counter clocked at ClockHz can only produce whole-cycle periods, so
+ * ClockHz / Rate is truncated (e.g. 25 MHz / 22050 Hz = 1133.79 cycles).
+ * Instead of always using the truncated period, each step picks Period or
+ * Period + 1, whichever keeps the accumulated phase error nearest zero. The
+ * error never exceeds half a step, so the long-run rate is exact.
+ *
+******************************************************************************/
+
+// Includes
+#include "SampleClock.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void SampleClock_Init(SampleClock_t *Clock, uint32_t ClockHz, uint32_t Rate)
+{
+	Clock->ClockHz = ClockHz;
+	Clock->Rate = Rate;
+	Clock->Period = ClockHz / Rate;
+	Clock->Remainder = ClockHz - (Clock->Period * Rate);
+	Clock->Error = 0;
+}
+
+// Period in clock cycles to use for each of the next Samples samples.
+// Samples * Rate must stay below 2^30 so the error fits in 32 bits.
+uint32_t SampleClock_Next(SampleClock_t *Clock, uint32_t Samples)
+{
+	int32_t Short = Clock->Error - (int32_t)(Samples * Clock->Remainder);	// Error after Period cycles
+	int32_t Long = Short + (int32_t)(Samples * Clock->Rate);				// Error after Period + 1 cycles
+
+	if ((Short + Long) < 0)
+	{
+		Clock->Error = Long;
+		return Clock->Period + 1;
+	}
+
+	Clock->Error = Short;
+	return Clock->Period;
+}
@@ -0,0 +1,34 @@
+/**************************************************************************//**
+ *
+ * @file		SampleClock.h
+ * @brief		Header file for the fractional sample rate generator
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef SAMPLECLOCK_H
+#define SAMPLECLOCK_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+// Splits a peripheral clock into sample periods of Period or Period+1 cycles,
+// chosen Bresenham-style so the long-run rate is exact.
+typedef struct {
+	uint32_t ClockHz;			// Peripheral clock driving the counter
+	uint32_t Rate;				// Requested samples per second
+	uint32_t Period;			// Whole clock cycles per sample, rounded down
+	uint32_t Remainder;			// ClockHz - (Period * Rate)
+	int32_t Error;				// (cycles emitted * Rate) - (samples emitted * ClockHz)
+} SampleClock_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void SampleClock_Init(SampleClock_t *Clock, uint32_t ClockHz, uint32_t Rate);
+uint32_t SampleClock_Next(SampleClock_t *Clock, uint32_t Samples);
+
+#endif // SAMPLECLOCK_H
@@ -0,0 +1,404 @@
+/**************************************************************************//**
+ *
+ * @file		Spi.c
+ * @brief		DMA driven SPI transactions on SSP1
+ * @version		1.0
+ *
+ * Two GPDMA channels run each phase: one feeds the transmit FIFO from the
+ * caller's buffer, the other empties the receive FIFO into a sink. The receive
+ * channel only finishes once the last byte has been clocked in, which is also
+ * when it has been clocked out, so its interrupt is the safe point to change
+ * the data/command line or release the chip select. The next transaction is
+ * picked and started from the same interrupt, keeping the bus busy without
+ * waking any task.
+ *
+ * Byte rates are charged when a transaction is submitted, so the interrupt
+ * only compares the flags and deadlines of at most SPI_QUEUE_LENGTH entries.
+ *
+ * Must be started after OLED_Init, which still uses the polled FreeRTOS_IO
+ * driver, and after GPDMA_Init.
+ *
+******************************************************************************/
+
+// Includes
+#include "LPC17xx.h"
+#include "LPC17xx_GPIO.h"
+#include "LPC17xx_GPDMA.h"
+#include "LPC17xx_SSP.h"
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Semaphore.h"
+
+#include "Spi.h"
+#include "IsrProfile.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SPI_TX_CHANNEL			1			// GPDMA channels, below the DAC's channel 0
+#define SPI_RX_CHANNEL			2
+#define SPI_RX_NOT_EMPTY		(1<<2)		// SSP status RNE bit
+#define SPI_CYCLES_PER_US		(configCPU_CLOCK_HZ / 1000000UL)
+
+typedef enum {
+	SPI_IDLE,
+	SPI_COMMAND,
+	SPI_DATA
+} Spi_Phase_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static Spi_Transaction_t *Pending[SPI_QUEUE_LENGTH];	// Waiting, oldest first
+static uint8_t PendingCount = 0;
+static Spi_Transaction_t *Current = 0;			// On the wire
+static Spi_Client_t Clients[SPI_CLIENTS];
+static uint8_t ClientCount = 0;
+static volatile uint8_t Phase = SPI_IDLE;
+static uint8_t Sink[SPI_MAX_PHASE];				// Where received bytes go
+static uint32_t StartCycles;					// When Current asserted its chip select
+static uint32_t WindowStart;
+static Spi_Report_t Stats;
+static Spi_Report_t Totals;						// Every window reported so far
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Fold one window's figures for a client into a running total
+static void Spi_Add(Spi_ClientStats_t *Sum, const Spi_ClientStats_t *Window)
+{
+	Sum->Transactions += Window->Transactions;
+	Sum->Bytes += Window->Bytes;
+	if (Window->WaitMax > Sum->WaitMax)
+		Sum->WaitMax = Window->WaitMax;
+	Sum->WaitTotal += Window->WaitTotal;
+	Sum->Missed += Window->Missed;
+	Sum->OverRate += Window->OverRate;
+}
+
+// Clock Length bytes out of Buffer, discarding what comes back
+static void Spi_StartPhase(const uint8_t *Buffer, uint16_t Length)
+{
+	GPDMA_Channel_CFG_Type GPDMACfg;
+
+	// Anything left in the receive FIFO would end the phase early
+	while (LPC_SSP1->SR & SPI_RX_NOT_EMPTY)
+		(void)LPC_SSP1->DR;
+
+	GPDMACfg.ChannelNum = SPI_RX_CHANNEL;
+	GPDMACfg.SrcMemAddr = 0;
+	GPDMACfg.DstMemAddr = (uint32_t)Sink;
+	GPDMACfg.TransferSize = Length;
+	GPDMACfg.TransferWidth = 0;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_P2M;
+	GPDMACfg.SrcConn = GPDMA_CONN_SSP1_Rx;
+	GPDMACfg.DstConn = 0;
+	GPDMACfg.DMALLI = 0;
+	GPDMA_Setup(&GPDMACfg);
+
+	GPDMACfg.ChannelNum = SPI_TX_CHANNEL;
+	GPDMACfg.SrcMemAddr = (uint32_t)Buffer;
+	GPDMACfg.DstMemAddr = 0;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	GPDMACfg.SrcConn = 0;
+	GPDMACfg.DstConn = GPDMA_CONN_SSP1_Tx;
+	GPDMA_Setup(&GPDMACfg);
+
+	GPDMA_ChannelCmd(SPI_RX_CHANNEL, ENABLE);
+	GPDMA_ChannelCmd(SPI_TX_CHANNEL, ENABLE);
+}
+
+// Select the device and send the first phase. Called with the bus idle, from
+// a critical section or the DMA interrupt.
+static void Spi_Start(Spi_Transaction_t *Transaction)
+{
+	const Spi_Device_t *Device = Transaction->Device;
+	Spi_ClientStats_t *Client = &Transaction->Client->Stats;
+	uint32_t Wait;
+
+	Current = Transaction;
+	StartCycles = IsrProfile_Now();
+	GPIO_ClearValue(Device->CsPort, Device->CsPin);
+
+	Wait = (StartCycles - Transaction->Submitted) / SPI_CYCLES_PER_US;
+	Client->WaitTotal += Wait;
+	if (Wait > Client->WaitMax)
+		Client->WaitMax = Wait;
+	if ((int32_t)(xTaskGetTickCountFromISR() - Transaction->Due) > 0)
+		++Client->Missed;
+
+	if (Transaction->CommandLength != 0)
+	{
+		Phase = SPI_COMMAND;
+		if (Device->DcPin != 0)
+			GPIO_ClearValue(Device->DcPort, Device->DcPin);
+		Spi_StartPhase(Transaction->Command, Transaction->CommandLength);
+	}
+	else
+	{
+		Phase = SPI_DATA;
+		if (Device->DcPin != 0)
+			GPIO_SetValue(Device->DcPort, Device->DcPin);
+		Spi_StartPhase(Transaction->Data, Transaction->DataLength);
+	}
+}
+
+// 1 if A should go before B, which was submitted earlier
+static uint8_t Spi_Before(const Spi_Transaction_t *A, const Spi_Transaction_t *B)
+{
+	int32_t Sooner = (int32_t)(A->Due - B->Due);
+
+	if (A->OverRate != B->OverRate)
+		return B->OverRate;
+	if (Sooner != 0)
+		return Sooner < 0;
+	return A->Client->Priority > B->Client->Priority;
+}
+
+// Take the transaction that should go next off the pending list, or 0
+static Spi_Transaction_t* Spi_Next(void)
+{
+	Spi_Transaction_t *Next;
+	uint8_t Best = 0;
+	uint8_t i;
+
+	if (PendingCount == 0)
+		return 0;
+
+	for (i = 1; i < PendingCount; ++i)
+	{
+		if (Spi_Before(Pending[i], Pending[Best]))
+			Best = i;
+	}
+
+	Next = Pending[Best];
+	for (i = Best + 1; i < PendingCount; ++i)
+		Pending[i - 1] = Pending[i];
+	--PendingCount;
+	return Next;
+}
+
+// Top up a capped client's budget for the time since it was last charged
+static void Spi_Refill(Spi_Client_t *Client, portTickType Now)
+{
+	int32_t Limit = (int32_t)((Client->ByteRate * SPI_BURST_MS) / 1000);
+	uint32_t Earned = (uint32_t)(((uint64_t)Client->ByteRate * (Now - Client->Refilled)) / configTICK_RATE_HZ);
+
+	if (Earned == 0)
+		return;
+	Client->Refilled = Now;
+	Client->Budget = ((Client->Budget + (int32_t)Earned) > Limit) ? Limit : (Client->Budget + (int32_t)Earned);
+}
+
+// Release the device, tell its owner and move on to the next transaction
+static void Spi_Finish(uint8_t Result, portBASE_TYPE *HigherPriorityTaskWoken)
+{
+	Spi_Transaction_t *Finished = Current;
+	uint16_t Bytes = Finished->CommandLength + Finished->DataLength;
+
+	GPIO_SetValue(Finished->Device->CsPort, Finished->Device->CsPin);
+	Finished->Result = Result;
+
+	++Stats.Transactions;
+	Stats.Bytes += Bytes;
+	Stats.BusyCycles += IsrProfile_Now() - StartCycles;
+	++Finished->Client->Stats.Transactions;
+	Finished->Client->Stats.Bytes += Bytes;
+
+	Current = Spi_Next();
+	Phase = SPI_IDLE;
+	if (Current != 0)
+		Spi_Start(Current);
+
+	if (Finished->Done != 0)
+		xSemaphoreGiveFromISR(Finished->Done, HigherPriorityTaskWoken);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Spi_Init(void)
+{
+	WindowStart = IsrProfile_Now();
+
+	SSP_DMACmd(LPC_SSP1, SSP_DMA_TX, ENABLE);
+	SSP_DMACmd(LPC_SSP1, SSP_DMA_RX, ENABLE);
+
+	NVIC_SetPriority(DMA_IRQn, ((0x01<<4)|0x01));
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+// Register a bus user. Priority breaks ties between equal deadlines, ByteRate
+// (bytes per second, 0 for none) is how much it may send before dropping
+// behind the others. Returns 0 if there is no room for another client.
+Spi_Client_t* Spi_AddClient(const char *Name, uint8_t Priority, uint32_t ByteRate)
+{
+	Spi_Client_t *Client;
+
+	if (ClientCount == SPI_CLIENTS)
+		return 0;
+
+	taskENTER_CRITICAL();
+		Client = &Clients[ClientCount++];
+		Client->Name = Name;
+		Client->Priority = Priority;
+		Client->ByteRate = ByteRate;
+		Client->Budget = (int32_t)((ByteRate * SPI_BURST_MS) / 1000);
+		Client->Refilled = xTaskGetTickCount();
+	taskEXIT_CRITICAL();
+	return Client;
+}
+
+const char* Spi_ClientName(uint8_t Client)
+{
+	return (Client < ClientCount) ? Clients[Client].Name : "?";
+}
+
+// Queue a transaction, starting it at once if the bus is free. Returns 0 if
+// the queue is full or a phase is too long.
+uint8_t Spi_Submit(Spi_Transaction_t *Transaction)
+{
+	Spi_Client_t *Client = Transaction->Client;
+	portTickType Now;
+	uint8_t Ret = 1;
+
+	if ((Transaction->CommandLength > SPI_MAX_PHASE) || (Transaction->DataLength > SPI_MAX_PHASE))
+		return 0;
+	if ((Transaction->CommandLength == 0) && (Transaction->DataLength == 0))
+		return 0;
+
+	Transaction->Result = 0;
+	taskENTER_CRITICAL();
+		// A rejected transaction never goes out, so it is not charged to the budget
+		if ((Phase != SPI_IDLE) && (PendingCount >= SPI_QUEUE_LENGTH))
+		{
+			Ret = 0;
+		}
+		else
+		{
+			Now = xTaskGetTickCount();
+			Transaction->Due = Now + Transaction->Deadline;
+			Transaction->Submitted = IsrProfile_Now();
+			Transaction->OverRate = 0;
+			if (Client->ByteRate != 0)
+			{
+				Spi_Refill(Client, Now);
+				if (Client->Budget <= 0)
+				{
+					Transaction->OverRate = 1;
+					++Client->Stats.OverRate;
+				}
+				Client->Budget -= Transaction->CommandLength + Transaction->DataLength;
+			}
+
+			if (Phase == SPI_IDLE)
+				Spi_Start(Transaction);
+			else
+				Pending[PendingCount++] = Transaction;
+		}
+	taskEXIT_CRITICAL();
+	return Ret;
+}
+
+// Send a transaction and wait until the driver is done with it, however long
+// that takes: giving up early would leave the DMA holding the caller's stack.
+// Returns 1 if it went out, 0 if it could not be queued or the DMA failed.
+uint8_t Spi_Transfer(Spi_Transaction_t *Transaction)
+{
+	if (!Spi_Submit(Transaction))
+		return 0;
+	xSemaphoreTake(Transaction->Done, portMAX_DELAY);
+	return Transaction->Result;
+}
+
+// Copy out the figures since the last report and start a new window
+void Spi_Report(Spi_Report_t *Report)
+{
+	uint8_t i;
+
+	taskENTER_CRITICAL();
+		*Report = Stats;
+		Report->Elapsed = IsrProfile_Now() - WindowStart;
+		WindowStart += Report->Elapsed;
+		Totals.Transactions += Stats.Transactions;
+		Totals.Bytes += Stats.Bytes;
+		Stats.Transactions = 0;
+		Stats.Bytes = 0;
+		Stats.BusyCycles = 0;
+
+		Report->ClientCount = ClientCount;
+		for (i = 0; i < ClientCount; ++i)
+		{
+			Report->Clients[i] = Clients[i].Stats;
+			Spi_Add(&Totals.Clients[i], &Clients[i].Stats);
+			Clients[i].Stats.Transactions = 0;
+			Clients[i].Stats.Bytes = 0;
+			Clients[i].Stats.WaitMax = 0;
+			Clients[i].Stats.WaitTotal = 0;
+			Clients[i].Stats.Missed = 0;
+			Clients[i].Stats.OverRate = 0;
+		}
+	taskEXIT_CRITICAL();
+
+	Report->Load = (Report->Elapsed == 0) ? 0 : (uint16_t)(((uint64_t)Report->BusyCycles * 1000) / Report->Elapsed);
+}
+
+// Copy out the figures since start up, the window not yet reported included.
+// The cycle counts would wrap within a minute, so only the windows have a
+// load: BusyCycles, Elapsed and Load come back 0.
+void Spi_Totals(Spi_Report_t *Report)
+{
+	uint8_t i;
+
+	taskENTER_CRITICAL();
+		*Report = Totals;
+		Report->Transactions += Stats.Transactions;
+		Report->Bytes += Stats.Bytes;
+		Report->ClientCount = ClientCount;
+		for (i = 0; i < ClientCount; ++i)
+			Spi_Add(&Report->Clients[i], &Clients[i].Stats);
+	taskEXIT_CRITICAL();
+}
+
+// Called from DMA_IRQHandler for the SPI channels' interrupts
+void Spi_DMAHandler(void)
+{
+	portBASE_TYPE HigherPriorityTaskWoken = pdFALSE;
+	const Spi_Device_t *Device;
+
+	// The transmit side finishing early means nothing; wait for the receive side
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, SPI_TX_CHANNEL))
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, SPI_TX_CHANNEL);
+
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, SPI_TX_CHANNEL) || GPDMA_IntGetStatus(GPDMA_STAT_INTERR, SPI_RX_CHANNEL))
+	{
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, SPI_TX_CHANNEL);
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, SPI_RX_CHANNEL);
+		GPDMA_ChannelCmd(SPI_TX_CHANNEL, DISABLE);
+		GPDMA_ChannelCmd(SPI_RX_CHANNEL, DISABLE);
+		if (Phase != SPI_IDLE)
+			Spi_Finish(0, &HigherPriorityTaskWoken);
+	}
+	else if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, SPI_RX_CHANNEL))
+	{
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, SPI_RX_CHANNEL);
+
+		if ((Phase == SPI_COMMAND) && (Current->DataLength != 0))
+		{
+			// Commands are out; switch to data without releasing the device
+			Device = Current->Device;
+			Phase = SPI_DATA;
+			if (Device->DcPin != 0)
+				GPIO_SetValue(Device->DcPort, Device->DcPin);
+			Spi_StartPhase(Current->Data, Current->DataLength);
+		}
+		else if (Phase != SPI_IDLE)
+		{
+			Spi_Finish(1, &HigherPriorityTaskWoken);
+		}
+	}
+
+	portEND_SWITCHING_ISR(HigherPriorityTaskWoken);
+}
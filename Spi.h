@@ -0,0 +1,102 @@
+/**************************************************************************//**
+ *
+ * @file		Spi.h
+ * @brief		Header file for DMA driven SPI transactions on SSP1
+ * @version		1.0
+ *
+ * A transaction names a device (its chip select, and data/command line if it
+ * has one), an optional command phase and a data phase. Spi_Submit queues it
+ * and returns at once; the GPDMA moves the bytes and the transaction's Done
+ * semaphore is given when the last bit has left the wire. Spi_Transfer does
+ * both and waits, with the CPU free for other tasks in the meantime. It has
+ * no timeout, since the transaction cannot be taken back once queued; it
+ * needs a Done semaphore.
+ *
+ * Every transaction belongs to a client from Spi_AddClient and carries a
+ * deadline. Waiting transactions go out earliest deadline first, then by
+ * client priority. A client that has used up its byte rate drops behind
+ * everyone within budget, so it can only have the bus when nobody else
+ * wants it. Per client wait times and missed deadlines are in Spi_Report.
+ *
+ * The transaction and its buffers belong to the driver until it is done.
+ *
+******************************************************************************/
+
+#ifndef SPI_H
+#define SPI_H
+
+// Includes
+#include "FreeRTOS.h"
+#include "FreeRTOS_Semaphore.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SPI_QUEUE_LENGTH		8			// Transactions waiting behind the one on the wire
+#define SPI_MAX_PHASE			128			// Longest command or data phase, bytes
+#define SPI_CLIENTS				4			// Most clients that can be added
+#define SPI_BURST_MS			100			// A capped client may save up this much of its rate
+
+typedef struct {
+	uint8_t CsPort;				// Chip select, active low
+	uint32_t CsPin;
+	uint8_t DcPort;				// Data/command select, low for commands
+	uint32_t DcPin;				// 0 if the device has none
+} Spi_Device_t;
+
+typedef struct {
+	uint32_t Transactions;
+	uint32_t Bytes;
+	uint32_t WaitMax;			// Submit to chip select, us
+	uint32_t WaitTotal;			// us
+	uint32_t Missed;			// Transactions started after their deadline
+	uint32_t OverRate;			// Transactions submitted while over the byte rate
+} Spi_ClientStats_t;
+
+typedef struct {
+	const char *Name;
+	uint8_t Priority;			// Higher goes first among equal deadlines
+	uint32_t ByteRate;			// Bytes per second within budget, 0 for no cap
+	int32_t Budget;				// Bytes left, refilled at ByteRate
+	portTickType Refilled;		// When Budget was last topped up
+	Spi_ClientStats_t Stats;
+} Spi_Client_t;
+
+typedef struct {
+	Spi_Client_t *Client;
+	portTickType Deadline;		// Ticks from submission until it should have started
+	const Spi_Device_t *Device;
+	const uint8_t *Command;		// Sent with DC low, may be 0
+	uint16_t CommandLength;
+	const uint8_t *Data;		// Sent with DC high, may be 0
+	uint16_t DataLength;
+	xSemaphoreHandle Done;		// Given on completion, may be 0
+	volatile uint8_t Result;	// 1 once sent, 0 if the DMA failed
+	portTickType Due;			// Set by Spi_Submit
+	uint32_t Submitted;			// Cycle count at submission
+	uint8_t OverRate;			// Client was over its byte rate at submission
+} Spi_Transaction_t;
+
+typedef struct {
+	uint32_t Transactions;
+	uint32_t Bytes;
+	uint32_t BusyCycles;		// Time from chip select to completion
+	uint32_t Elapsed;			// Cycles covered by the window
+	uint16_t Load;				// Share of the window the bus was busy, per mille
+	uint8_t ClientCount;
+	Spi_ClientStats_t Clients[SPI_CLIENTS];	// In the order they were added
+} Spi_Report_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Spi_Init(void);
+Spi_Client_t* Spi_AddClient(const char *Name, uint8_t Priority, uint32_t ByteRate);
+const char* Spi_ClientName(uint8_t Client);
+uint8_t Spi_Submit(Spi_Transaction_t *Transaction);
+uint8_t Spi_Transfer(Spi_Transaction_t *Transaction);
+void Spi_Report(Spi_Report_t *Report);
+void Spi_Totals(Spi_Report_t *Report);
+void Spi_DMAHandler(void);
+
+#endif // SPI_H
@@ -0,0 +1,202 @@
+/**************************************************************************//**
+ *
+ * @file		Synth.c
+ * @brief		Wavetable tone synthesizer used by WavPlayer
+ * @version		1.0
+ *
+ * The per-sample work is a phase step, one table lookup (or a shift for the
+ * other waveforms), an envelope step and one multiply. Anything that needs a
+ * division is worked out once per tune or once per note.
+ *
+******************************************************************************/
+
+// Includes
+#include "Synth.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SYNTH_FULL				(1UL << 24)		// Envelope at full scale
+#define SYNTH_GATE(x)			((x) - ((x) / 8))	// Part of a note held before its release
+
+typedef enum {
+	SYNTH_ATTACK,
+	SYNTH_DECAY,
+	SYNTH_SUSTAIN,
+	SYNTH_RELEASE,
+	SYNTH_IDLE
+} Synth_Stage_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+
+// One cycle of a sine wave
+static const int8_t SineTable[64] = {
+	   0,   12,   25,   37,   49,   60,   71,   81,   90,   98,  106,  112,  117,  122,  125,  126,
+	 127,  126,  125,  122,  117,  112,  106,   98,   90,   81,   71,   60,   49,   37,   25,   12,
+	   0,  -12,  -25,  -37,  -49,  -60,  -71,  -81,  -90,  -98, -106, -112, -117, -122, -125, -126,
+	-127, -126, -125, -122, -117, -112, -106,  -98,  -90,  -81,  -71,  -60,  -49,  -37,  -25,  -12
+};
+
+// MIDI notes 120 to 131 (C9 to B9) in Hz * 256, lower octaves are shifted down
+static const uint32_t OctaveTable[12] = {
+	2143237, 2270680, 2405702, 2548752, 2700309, 2860878,
+	3030994, 3211227, 3402176, 3604480, 3818814, 4045892
+};
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Samples in a time given in ms, at least one
+static uint32_t Synth_Samples(const Synth_t *Synth, uint32_t Milliseconds)
+{
+	uint32_t Samples = (Milliseconds * Synth->Rate) / 1000;
+	return (Samples == 0) ? 1 : Samples;
+}
+
+static int32_t Synth_Wave(uint8_t Waveform, uint32_t Phase)
+{
+	int32_t Ramp;
+
+	switch (Waveform)
+	{
+		case SYNTH_SQUARE:
+			return (Phase & 0x80000000UL) ? -127 : 127;
+		case SYNTH_SAW:
+			return (int8_t)(Phase >> 24);
+		case SYNTH_TRIANGLE:
+			// Fold the saw about its peak
+			Ramp = (int32_t)(Phase >> 23) - 256;
+			Ramp = ((Ramp < 0) ? -Ramp : Ramp) - 128;
+			return (Ramp > 127) ? 127 : Ramp;
+		default:
+			return SineTable[Phase >> 26];
+	}
+}
+
+// Start the next note of the tune. Returns 0 once the tune has ended.
+static uint8_t Synth_NextNote(Synth_t *Synth)
+{
+	uint32_t Frequency;
+	uint8_t Note = Synth->Note[0];
+	uint8_t Length;
+
+	if (Note == SYNTH_LOOP)
+	{
+		Synth->Note = &Synth->Tune[SYNTH_TUNE_HEADER];
+		Note = Synth->Note[0];
+	}
+	if ((Note == SYNTH_END) || (Note == SYNTH_LOOP))
+		return 0;
+
+	// A zero length would never move the tune on
+	Length = Synth->Note[1];
+	if (Length == 0)
+		Length = 1;
+	Synth->Note += 2;
+
+	Synth->SamplesLeft = Length * Synth->TickSamples;
+	if (Note >= SYNTH_REST)
+	{
+		// Let the last note finish its release
+		Synth->GateLeft = 0;
+		return 1;
+	}
+
+	Frequency = OctaveTable[Note % 12] >> (10 - (Note / 12));
+	Synth->Increment = (uint32_t)(((uint64_t)Frequency << 24) / Synth->Rate);
+	Synth->GateLeft = SYNTH_GATE(Synth->SamplesLeft);
+	// The envelope carries on from where it is, so back to back notes do not click
+	Synth->Stage = SYNTH_ATTACK;
+	return 1;
+}
+
+static void Synth_Envelope(Synth_t *Synth)
+{
+	switch (Synth->Stage)
+	{
+		case SYNTH_ATTACK:
+			Synth->Level += Synth->AttackStep;
+			if (Synth->Level >= SYNTH_FULL)
+			{
+				Synth->Level = SYNTH_FULL;
+				Synth->Stage = SYNTH_DECAY;
+			}
+			break;
+		case SYNTH_DECAY:
+			if (Synth->Level > Synth->Sustain + Synth->DecayStep)
+			{
+				Synth->Level -= Synth->DecayStep;
+			}
+			else
+			{
+				Synth->Level = Synth->Sustain;
+				Synth->Stage = SYNTH_SUSTAIN;
+			}
+			break;
+		case SYNTH_RELEASE:
+			if (Synth->Level > Synth->ReleaseStep)
+			{
+				Synth->Level -= Synth->ReleaseStep;
+			}
+			else
+			{
+				Synth->Level = 0;
+				Synth->Stage = SYNTH_IDLE;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Synth_Init(Synth_t *Synth, const uint8_t *Tune, uint32_t Rate)
+{
+	Synth->Tune = Tune;
+	Synth->Note = &Tune[SYNTH_TUNE_HEADER];
+	Synth->Rate = Rate;
+	Synth->Waveform = Tune[0];
+	Synth->TickSamples = Synth_Samples(Synth, Tune[1]);
+	Synth->AttackStep = SYNTH_FULL / Synth_Samples(Synth, Tune[2]);
+	Synth->Sustain = (Tune[4] * SYNTH_FULL) / 255;
+	Synth->DecayStep = (SYNTH_FULL - Synth->Sustain) / Synth_Samples(Synth, Tune[3]);
+	Synth->ReleaseSamples = Synth_Samples(Synth, Tune[5]);
+	Synth->ReleaseStep = 0;
+	Synth->Phase = 0;
+	Synth->Increment = 0;
+	Synth->Level = 0;
+	Synth->SamplesLeft = 0;
+	Synth->GateLeft = 0;
+	Synth->Stage = SYNTH_IDLE;
+}
+
+// Mixer fill callback: render up to Count unsigned 8-bit samples of the tune
+uint32_t Synth_Fill(void *Context, uint8_t *Samples, uint32_t Count)
+{
+	Synth_t *Synth = (Synth_t*)Context;
+	uint32_t i;
+
+	for (i = 0; i < Count; ++i)
+	{
+		if ((Synth->SamplesLeft == 0) && !Synth_NextNote(Synth))
+			break;
+		--Synth->SamplesLeft;
+
+		if ((Synth->GateLeft != 0) && (--Synth->GateLeft == 0))
+		{
+			// Note off: fade from wherever the envelope has got to
+			Synth->ReleaseStep = (Synth->Level / Synth->ReleaseSamples) + 1;
+			Synth->Stage = SYNTH_RELEASE;
+		}
+		Synth_Envelope(Synth);
+
+		Synth->Phase += Synth->Increment;
+		Samples[i] = (uint8_t)(128 + ((Synth_Wave(Synth->Waveform, Synth->Phase) * (int32_t)(Synth->Level >> 16)) >> 8));
+	}
+	return i;
+}
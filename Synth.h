@@ -0,0 +1,65 @@
+/**************************************************************************//**
+ *
+ * @file		Synth.h
+ * @brief		Header file for the wavetable tone synthesizer used by WavPlayer
+ * @version		1.0
+ *
+ * Plays a compact tune (a few bytes per note, see tools/tune2c) through one
+ * oscillator with an ADSR envelope, all in fixed point. Synth_Fill matches
+ * AudioMixer_Fill_t, so a tune plays as a mixer voice next to the samples.
+ *
+ * Tune layout:	[0] Waveform		[1] Tick length in ms
+ *				[2] Attack in ms	[3] Decay in ms
+ *				[4] Sustain level (255 = full)	[5] Release in ms
+ *				then two bytes per note: MIDI note number (or SYNTH_REST) and
+ *				length in ticks, ending with SYNTH_END or SYNTH_LOOP.
+ *
+******************************************************************************/
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SYNTH_TUNE_HEADER		6			// Bytes before the first note
+#define SYNTH_REST				0x80		// Note byte for silence
+#define SYNTH_LOOP				0xFE		// Note byte that goes back to the first note
+#define SYNTH_END				0xFF		// Note byte that ends the tune
+
+typedef enum {
+	SYNTH_SINE,
+	SYNTH_SQUARE,
+	SYNTH_SAW,
+	SYNTH_TRIANGLE
+} Synth_Waveform_t;
+
+typedef struct {
+	const uint8_t *Tune;
+	const uint8_t *Note;			// Next note to play
+	uint32_t TickSamples;			// Output samples per tick
+	uint32_t Phase;					// Oscillator phase, a full cycle is 2^32
+	uint32_t Increment;				// Phase step per sample for the current note
+	uint32_t Level;					// Envelope, SYNTH_FULL = full scale
+	uint32_t AttackStep;
+	uint32_t DecayStep;
+	uint32_t Sustain;
+	uint32_t ReleaseSamples;
+	uint32_t ReleaseStep;			// Worked out from the level at note off
+	uint32_t SamplesLeft;			// Until the next note
+	uint32_t GateLeft;				// Until the current note is released
+	uint32_t Rate;
+	uint8_t Waveform;
+	uint8_t Stage;
+} Synth_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Synth_Init(Synth_t *Synth, const uint8_t *Tune, uint32_t Rate);
+uint32_t Synth_Fill(void *Context, uint8_t *Samples, uint32_t Count);
+
+#endif // SYNTH_H
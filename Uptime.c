@@ -0,0 +1,111 @@
+/**************************************************************************//**
+ *
+ * @file		Uptime.c
+ * @brief		Monotonic microsecond uptime clock
+ * @version		1.0
+ *
+ * Half counts how many times bit 31 of the timer has changed, so its lowest
+ * bit should always equal bit 31 of the count. The TIMER2 interrupt brings it
+ * up to date halfway through each half (about eighteen minutes in), well
+ * away from the moment the bit flips. A reader that sees the two disagree has
+ * caught the count after a flip the interrupt has not yet caught up with, and
+ * adds the missing half itself. Nothing is ever locked: Half has one writer,
+ * and the interrupt only ever moves it to agree with the count, so a late or
+ * repeated interrupt does no harm.
+ *
+******************************************************************************/
+
+// Includes
+#include "LPC17xx.h"
+#include "LPC17xx_Timer.h"
+
+#include "Uptime.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define UPTIME_HALF_BITS		31
+#define UPTIME_HALF_MASK		0x7FFFFFFFUL
+#define UPTIME_FIRST_QUARTER	0x40000000UL		// Points at which Half is brought up to date
+#define UPTIME_THIRD_QUARTER	0xC0000000UL
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static volatile uint32_t Half = 0;				// Half periods of the 32 bit count since Uptime_Init
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static void Uptime_Match(uint8_t Channel, uint32_t Value)
+{
+	TIM_MATCHCFG_Type TIM_MatchConfigStruct;
+
+	TIM_MatchConfigStruct.MatchChannel = Channel;
+	TIM_MatchConfigStruct.IntOnMatch = TRUE;
+	TIM_MatchConfigStruct.ResetOnMatch = FALSE;
+	TIM_MatchConfigStruct.StopOnMatch = FALSE;
+	TIM_MatchConfigStruct.ExtMatchOutputType = TIM_EXTMATCH_NOTHING;
+	TIM_MatchConfigStruct.MatchValue = Value;
+	TIM_ConfigMatch(LPC_TIM2, &TIM_MatchConfigStruct);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Start counting from zero. Call once, before anything asks for the time.
+void Uptime_Init(void)
+{
+	TIM_TIMERCFG_Type TIM_ConfigStruct;
+
+	TIM_ConfigStruct.PrescaleOption = TIM_PRESCALE_USVAL;
+	TIM_ConfigStruct.PrescaleValue = 1;
+	TIM_Init(LPC_TIM2, TIM_TIMER_MODE, &TIM_ConfigStruct);
+
+	Uptime_Match(0, UPTIME_FIRST_QUARTER);
+	Uptime_Match(1, UPTIME_THIRD_QUARTER);
+
+	// Nothing here touches the kernel and there is a quarter period to respond, so it can wait behind everything else
+	NVIC_SetPriority(TIMER2_IRQn, 0x1F);
+	NVIC_EnableIRQ(TIMER2_IRQn);
+
+	Half = 0;
+	TIM_ResetCounter(LPC_TIM2);
+	TIM_Cmd(LPC_TIM2, ENABLE);
+}
+
+// Microseconds since Uptime_Init. Safe from any task or interrupt.
+uint64_t Uptime_Micros(void)
+{
+	uint32_t Halves = Half;
+	uint32_t Count = LPC_TIM2->TC;
+
+	// Count has crossed into a new half the interrupt has not seen yet
+	Halves += (Halves ^ (Count >> UPTIME_HALF_BITS)) & 1;
+
+	return ((uint64_t)Halves << UPTIME_HALF_BITS) | (Count & UPTIME_HALF_MASK);
+}
+
+// Split a time from Uptime_Micros into hours, minutes and seconds
+void Uptime_ToClock(uint64_t Micros, Uptime_Clock_t *Clock)
+{
+	uint64_t Whole = Micros / UPTIME_MICROS_PER_SECOND;
+	uint32_t Seconds = (uint32_t)Whole;				// Good for 136 years
+
+	Clock->Micros = (uint32_t)(Micros - (Whole * UPTIME_MICROS_PER_SECOND));
+	Clock->Hours = Seconds / 3600;
+	Clock->Minutes = (uint8_t)((Seconds / 60) % 60);
+	Clock->Seconds = (uint8_t)(Seconds % 60);
+}
+
+void TIMER2_IRQHandler(void)
+{
+	uint32_t Count = LPC_TIM2->TC;
+
+	TIM_ClearIntPending(LPC_TIM2, TIM_MR0_INT);
+	TIM_ClearIntPending(LPC_TIM2, TIM_MR1_INT);
+
+	if ((Half ^ (Count >> UPTIME_HALF_BITS)) & 1)
+		++Half;
+}
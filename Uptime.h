@@ -0,0 +1,40 @@
+/**************************************************************************//**
+ *
+ * @file		Uptime.h
+ * @brief		Header file for the monotonic microsecond uptime clock
+ * @version		1.0
+ *
+ * TIMER2 counts microseconds from Uptime_Init and is never stopped or reset.
+ * Uptime_Micros extends its 32 bit count to 64 bits, which will not wrap for
+ * over half a million years, and can be called from any task or interrupt
+ * without a critical section. Hours, minutes and seconds are only worked out
+ * when someone asks for them with Uptime_ToClock.
+ *
+******************************************************************************/
+
+#ifndef UPTIME_H
+#define UPTIME_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define UPTIME_MICROS_PER_SECOND	1000000UL
+
+typedef struct {
+	uint32_t Hours;
+	uint8_t Minutes;
+	uint8_t Seconds;
+	uint32_t Micros;			// Within the second
+} Uptime_Clock_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void Uptime_Init(void);
+uint64_t Uptime_Micros(void);
+void Uptime_ToClock(uint64_t Micros, Uptime_Clock_t *Clock);
+
+#endif // UPTIME_H
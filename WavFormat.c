@@ -0,0 +1,157 @@
+/**************************************************************************//**
+ *
+ * @file		WavFormat.c
+ * @brief		RIFF/WAVE chunk parser used by WavPlayer
+ * @version		1.0
+ *
+ * Walks the chunk list of a RIFF/WAVE image instead of assuming fixed offsets,
+ * so fmt chunks of any size and extra chunks (LIST, fact, ...) are handled.
+ * Sizes read from the file are clamped to the array, as several of the bundled
+ * samples carry RIFF/data sizes that do not match their contents.
+ *
+******************************************************************************/
+
+// Includes
+#include "WavFormat.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define WAVFORMAT_FMT_MIN_SIZE	16			// CompressionCode up to BitsPerSample
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static uint16_t ReadU16(const uint8_t *Bytes)
+{
+	return (uint16_t)(Bytes[0] | (Bytes[1] << 8));
+}
+
+static uint32_t ReadU32(const uint8_t *Bytes)
+{
+	return ((uint32_t)Bytes[0] | ((uint32_t)Bytes[1] << 8) | ((uint32_t)Bytes[2] << 16) | ((uint32_t)Bytes[3] << 24));
+}
+
+// Case insensitive four character code compare, as the old fixed parser accepted either case
+static uint8_t IsFourCC(const uint8_t *Bytes, const char *FourCC)
+{
+	uint8_t i;
+	for (i = 0; i < 4; ++i)
+	{
+		uint8_t c = Bytes[i];
+		if ((c >= 'a') && (c <= 'z'))
+			c -= 'a' - 'A';
+		if (c != (uint8_t)FourCC[i])
+			return 0;
+	}
+	return 1;
+}
+
+// A chunk ID is four printable ASCII characters
+static uint8_t IsChunkID(const uint8_t *Bytes)
+{
+	uint8_t i;
+	for (i = 0; i < 4; ++i)
+	{
+		if ((Bytes[i] < 0x20) || (Bytes[i] > 0x7E))
+			return 0;
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+uint8_t WavFormat_Parse(const uint8_t *WavArray, uint32_t Length, WavFormat_Descriptor_t *Descriptor)
+{
+	uint32_t Position;
+	uint32_t End;
+	uint32_t ChunkSize;
+	uint8_t HaveFormat = 0;
+
+	// RIFF header
+	if ((WavArray == 0) || (Length < 12))
+		return 0;
+	if (!IsFourCC(&WavArray[0], "RIFF") || !IsFourCC(&WavArray[8], "WAVE"))
+		return 0;
+
+	// Never trust the RIFF size past the end of the array
+	End = ReadU32(&WavArray[4]);
+	if ((End > Length - 8) || (End < 4))
+		End = Length;
+	else
+		End += 8;
+
+	// Walk the sub chunks
+	Position = 12;
+	while (End - Position >= 8)
+	{
+		ChunkSize = ReadU32(&WavArray[Position + 4]);
+
+		if (IsFourCC(&WavArray[Position], "FMT "))
+		{
+			if ((ChunkSize < WAVFORMAT_FMT_MIN_SIZE) || (ChunkSize > End - Position - 8))
+				return 0;
+
+			Descriptor->Format = ReadU16(&WavArray[Position + 8]);
+			Descriptor->Channels = ReadU16(&WavArray[Position + 10]);
+			Descriptor->SampleRate = ReadU32(&WavArray[Position + 12]);
+			// Skip ByteRate (4 bytes), it is derived from the other fields
+			Descriptor->BlockAlign = ReadU16(&WavArray[Position + 20]);
+			Descriptor->BitsPerSample = ReadU16(&WavArray[Position + 22]);
+
+			if ((Descriptor->Channels == 0) || (Descriptor->SampleRate == 0))
+				return 0;
+
+			if (Descriptor->Format == WAVFORMAT_PCM)
+			{
+				if ((Descriptor->BitsPerSample != 8) && (Descriptor->BitsPerSample != 16))
+					return 0;
+				// BlockAlign is redundant for PCM, so rebuild it rather than trust it
+				Descriptor->BlockAlign = Descriptor->Channels * (Descriptor->BitsPerSample / 8);
+			}
+			else if (Descriptor->BlockAlign == 0)
+			{
+				return 0;
+			}
+
+			HaveFormat = 1;
+
+			// Some writers declare an 18 byte fmt chunk (with cbSize) but only store
+			// the 16 byte PCM fields, as WavPlayer_Sample does. Fall back to the
+			// short layout when the declared size does not land on a chunk ID.
+			if ((ChunkSize > WAVFORMAT_FMT_MIN_SIZE) && (End - Position >= 8 + WAVFORMAT_FMT_MIN_SIZE + 8)
+				&& ((End - Position - 8 - ChunkSize < 8) || !IsChunkID(&WavArray[Position + 8 + ChunkSize + (ChunkSize & 1)]))
+				&& IsChunkID(&WavArray[Position + 8 + WAVFORMAT_FMT_MIN_SIZE]))
+			{
+				ChunkSize = WAVFORMAT_FMT_MIN_SIZE;
+			}
+		}
+		else if (IsFourCC(&WavArray[Position], "DATA"))
+		{
+			if (!HaveFormat)
+				return 0;
+
+			// A missing or oversized data length runs to the end of the array
+			Position += 8;
+			if (ChunkSize > End - Position)
+				ChunkSize = End - Position;
+
+			// PCM is cut to whole frames; compressed formats may end in a short block
+			Descriptor->Data = &WavArray[Position];
+			Descriptor->DataLength = ChunkSize;
+			if (Descriptor->Format == WAVFORMAT_PCM)
+				Descriptor->DataLength -= ChunkSize % Descriptor->BlockAlign;
+			return 1;
+		}
+
+		// Chunks are word aligned; stop rather than wrap on a corrupt size
+		if (ChunkSize > End - Position - 8)
+			return 0;
+		Position += 8 + ChunkSize + (ChunkSize & 1);
+		if (Position > End)
+			return 0;
+	}
+
+	return 0;
+}
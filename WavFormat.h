@@ -0,0 +1,37 @@
+/**************************************************************************//**
+ *
+ * @file		WavFormat.h
+ * @brief		Header file for the RIFF/WAVE chunk parser used by WavPlayer
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef WAVFORMAT_H
+#define WAVFORMAT_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define WAVFORMAT_PCM			0x0001		// CompressionCode for uncompressed samples
+#define WAVFORMAT_IMA_ADPCM		0x0011		// CompressionCode for IMA-ADPCM blocks (see ImaAdpcm.h)
+
+// Everything the player needs to know about an asset, found once by WavFormat_Parse
+typedef struct {
+	const uint8_t *Data;		// First byte of the sample data
+	uint32_t DataLength;		// Bytes of sample data (whole frames for PCM)
+	uint32_t SampleRate;		// Frames per second
+	uint16_t Format;			// CompressionCode from the fmt chunk
+	uint16_t Channels;			// Interleaved channels per frame
+	uint16_t BitsPerSample;		// 8 (unsigned) or 16 (signed) for PCM
+	uint16_t BlockAlign;		// Bytes per frame, or per compressed block
+} WavFormat_Descriptor_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+uint8_t WavFormat_Parse(const uint8_t *WavArray, uint32_t Length, WavFormat_Descriptor_t *Descriptor);
+
+#endif // WAVFORMAT_H
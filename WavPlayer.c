@@ -19,6 +19,8 @@
 #include "LPC17xx_PinSelect.h"
 #include "LPC17xx_DAC.h"
 #include "LPC17xx_Timer.h"
+#include "LPC17xx_GPDMA.h"
+#include "LPC17xx_ClkPwr.h"
 
 #include "FreeRTOS.h"
 #include "FreeRTOS_Task.h"
@@ -27,11 +29,48 @@
 #include "FreeRTOS_IO.h"
 
 #include "WavPlayer.h"
+#include "SampleClock.h"
+#include "AudioRing.h"
+#include "ImaAdpcm.h"
+#include "AudioMixer.h"
+#include "Amplifier.h"
+#include "Synth.h"
+#include "IsrProfile.h"
 
 //------------------------------------------------------------------------------
 
 // Defines and typedefs
-//...
+#define WAVPLAYER_DMA_CHANNEL		0						// GPDMA channel driving the DAC (0 = highest priority)
+#define WAVPLAYER_DMA_BLOCK			256						// Samples in each half of the ping-pong buffer
+#define WAVPLAYER_DAC_VALUE(x)		((uint32_t)(x) << 8)	// 8-bit sample to DACR (VALUE field is bits 15:6)
+#define WAVPLAYER_RELOAD(x)			((x) - 1)				// Timer match and DAC counter both run for reload + 1 cycles
+#define WAVPLAYER_CACHE_SIZE		4						// Assets whose descriptors are remembered
+#define WAVPLAYER_PRODUCE_BLOCK		64						// Samples decoded per pass of the audio task
+#define WAVPLAYER_REFILL_LEVEL		(AUDIORING_SIZE / 2)	// Ring level at which the audio task is woken
+#define WAVPLAYER_POLL_TICKS		(20 / portTICK_RATE_MS)	// Longest the audio task sleeps without being woken
+#define WAVPLAYER_OUTPUT_RATE		24000					// Samples per second at the DAC, every voice is resampled to it
+#define WAVPLAYER_COMMANDS			4						// Play requests waiting for the audio task
+#define WAVPLAYER_RAMP_STEP			2						// Pause ramp gain change per sample, 128 samples (about 5 ms) end to end
+
+typedef struct {
+	const uint8_t *WavArray;
+	WavFormat_Descriptor_t Descriptor;
+} WavPlayer_CacheEntry_t;
+
+// Read position in one asset, the fill context of a mixer voice
+typedef struct {
+	WavFormat_Descriptor_t Format;
+	uint32_t Position;
+	ImaAdpcm_Decoder_t Decoder;				// Used when Format is IMA-ADPCM
+} WavPlayer_Source_t;
+
+// Request from another task to start an asset on a voice
+typedef struct {
+	WavFormat_Descriptor_t Descriptor;
+	const uint8_t *Tune;					// Synth tune to play instead of Descriptor, or 0
+	uint8_t Voice;							// WAVPLAYER_VOICE_MUSIC or WAVPLAYER_VOICE_EFFECT
+	uint16_t Gain;
+} WavPlayer_Command_t;
 
 //------------------------------------------------------------------------------
 
@@ -41,7 +80,30 @@
 //------------------------------------------------------------------------------
 
 // Local variables
-//...
+#ifdef WAVPLAYER_USE_DMA
+static uint32_t DMABuffer[2][WAVPLAYER_DMA_BLOCK];	// Ping-pong buffers of ready-made DACR words
+static GPDMA_LLI_Type DMALinkedList[2];				// Each half links to the other, so the DMA never stops
+static volatile uint8_t DMAHalf = 0;				// Half currently being played
+static volatile uint8_t DMADrain = 0;				// Halves completed since the song ran out
+#endif
+static WavPlayer_CacheEntry_t DescriptorCache[WAVPLAYER_CACHE_SIZE];	// Assets parsed so far
+static uint8_t DescriptorCacheNext = 0;				// Entry to replace on the next miss
+static SampleClock_t OutputClock;					// Splits the peripheral clock into exact sample periods
+static volatile uint32_t InterruptCount = 0;		// Audio interrupts serviced, for measuring CPU load
+
+static AudioRing_t Ring;							// Decoded samples from the audio task to the output
+static xSemaphoreHandle WakeSemaphore = 0;			// Wakes the audio task for a new song or a refill
+static xQueueHandle CommandQueue = 0;				// WavPlayer_Command_t from the other tasks
+static AudioMixer_t Mixer;							// Voices mixed by the audio task into the ring
+static WavPlayer_Source_t Sources[AUDIOMIXER_VOICES];	// Fill context of each mixer voice
+static Synth_t Synths[AUDIOMIXER_VOICES];			// Fill context of each mixer voice playing a tune
+static WavPlayer_NextTrack_t NextTrack = 0;			// Supplies the song to follow the music voice
+static uint8_t NextEffect = 0;						// Effect voice to take over when none are free
+static volatile uint8_t PendingPlay = 0;			// A song is queued for the music voice
+static volatile uint8_t OutputActive = 0;			// The output is running (or about to)
+static volatile uint8_t SongEnded = 0;				// Every voice has finished and the last sample is written
+static volatile uint16_t Volume = 256;				// Software gain, 256 = unity
+static volatile uint16_t RampGain = 256;			// Pause ramp applied at the output, 256 = playing
 
 //------------------------------------------------------------------------------
 
@@ -57,14 +119,10 @@ void WavPlayer_Init()
 	GPIO_SetDir(2, 1<<0, 1); // ?
 	GPIO_SetDir(2, 1<<1, 1); // ?
 
-	GPIO_SetDir(0, 1<<27, 1); // ?
-	GPIO_SetDir(0, 1<<28, 1); // ?
-	GPIO_SetDir(2, 1<<13, 1); // ?
 	GPIO_SetDir(0, 1<<26, 1); // ?
 
-	GPIO_ClearValue(0, 1<<27); // Audio amplifier - Clock
-	GPIO_ClearValue(0, 1<<28); // Audio amplifier - Up/Down
-	GPIO_ClearValue(2, 1<<13); // Audio amplifier - Shutdown
+	// Audio amplifier - Clock, Up/Down and Shutdown
+	Amplifier_Init();
 
 	PinConfig.Funcnum = 2;
 	PinConfig.OpenDrain = 0;
@@ -75,12 +133,189 @@ void WavPlayer_Init()
 	PINSEL_ConfigPin(&PinConfig);
 
 	DAC_Init(LPC_DAC);
+
+	vSemaphoreCreateBinary(WakeSemaphore);
+	xSemaphoreTake(WakeSemaphore, 0);
+	CommandQueue = xQueueCreate(WAVPLAYER_COMMANDS, sizeof(WavPlayer_Command_t));
+	AudioMixer_Init(&Mixer, WAVPLAYER_OUTPUT_RATE);
+}
+
+uint8_t isPaused = 0;
+uint32_t currChar;
+
+// Turn the output off. Safe from both the audio task and the sample interrupt.
+static void WavPlayer_Stop(void) {
+#ifdef WAVPLAYER_USE_DMA
+	GPDMA_ChannelCmd(WAVPLAYER_DMA_CHANNEL, DISABLE);
+#else
+	TIM_Cmd(LPC_TIM0, DISABLE);
+	NVIC_DisableIRQ(TIMER0_IRQn);
+#endif
+	OutputActive = 0;
+}
+
+// Ask the audio task for more samples once the ring has drained to the refill level
+static void WavPlayer_WakeFromISR(void) {
+	portBASE_TYPE HigherPriorityTaskWoken = pdFALSE;
+
+	xSemaphoreGiveFromISR(WakeSemaphore, &HigherPriorityTaskWoken);
+	portEND_SWITCHING_ISR(HigherPriorityTaskWoken);
+}
+
+// Read the next frame of an asset as one unsigned 8-bit sample,
+// mixing interleaved channels down to mono.
+static uint32_t WavPlayer_NextSample(WavPlayer_Source_t *Source) {
+	const uint8_t *Frame = &Source->Format.Data[Source->Position];
+	uint32_t Sum = 0;
+	uint16_t Channel;
+
+	Source->Position += Source->Format.BlockAlign;
+
+	if (Source->Format.BitsPerSample == 8) {
+		if (Source->Format.Channels == 1)
+			return Frame[0];
+		for (Channel = 0; Channel < Source->Format.Channels; ++Channel)
+			Sum += Frame[Channel];
+	} else {
+		// 16-bit samples are signed, so keep the top byte and flip it to unsigned
+		for (Channel = 0; Channel < Source->Format.Channels; ++Channel)
+			Sum += (uint8_t)(Frame[(Channel * 2) + 1] ^ 0x80);
+	}
+	return Sum / Source->Format.Channels;
+}
+
+// Scale a sample about the mid-point by the software volume (256 = unity)
+static uint8_t WavPlayer_ApplyVolume(uint32_t Sample) {
+	return (uint8_t)(128 + ((((int32_t)Sample - 128) * (int32_t)Volume) >> 8));
+}
+
+// Mixer fill callback: decode up to Count samples of an asset, returning fewer only once it has ended
+static uint32_t WavPlayer_ReadSource(void *Context, uint8_t *Samples, uint32_t Count) {
+	WavPlayer_Source_t *Source = (WavPlayer_Source_t*)Context;
+	uint32_t i;
+
+	if (Source->Format.Format == WAVFORMAT_IMA_ADPCM)
+		return ImaAdpcm_Decode(&Source->Decoder, Samples, Count);
+
+	for (i = 0; (i < Count) && (Source->Position < Source->Format.DataLength); ++i)
+		Samples[i] = WavPlayer_NextSample(Source);
+	return i;
+}
+
+// Point a source at the start of an asset
+static void WavPlayer_OpenSource(WavPlayer_Source_t *Source, const WavFormat_Descriptor_t *Descriptor) {
+	Source->Format = *Descriptor;
+	Source->Position = 0;
+	if (Source->Format.Format == WAVFORMAT_IMA_ADPCM)
+		ImaAdpcm_Init(&Source->Decoder, Source->Format.Data, Source->Format.DataLength, Source->Format.BlockAlign);
+}
+
+// Mixer next callback for the music voice: open the following song without a gap
+static uint8_t WavPlayer_NextSource(void *Context, uint32_t *Rate) {
+	WavFormat_Descriptor_t Next;
+
+	if ((NextTrack == 0) || !NextTrack(&Next))
+		return 0;
+
+	WavPlayer_OpenSource((WavPlayer_Source_t*)Context, &Next);
+	*Rate = Next.SampleRate;
+	return 1;
+}
+
+// Mix the voices into the ring, one block at a time, until it is full or every voice has ended
+static void WavPlayer_Produce(void) {
+	uint8_t Block[WAVPLAYER_PRODUCE_BLOCK];
+	uint32_t i;
+
+	while ((SongEnded == 0) && (AudioRing_Space(&Ring) >= WAVPLAYER_PRODUCE_BLOCK)) {
+		if (AudioMixer_ActiveVoices(&Mixer) == 0) {
+			SongEnded = 1;
+			break;
+		}
+
+		AudioMixer_Mix(&Mixer, Block, WAVPLAYER_PRODUCE_BLOCK);
+		for (i = 0; i < WAVPLAYER_PRODUCE_BLOCK; ++i)
+			Block[i] = WavPlayer_ApplyVolume(Block[i]);
+
+		AudioRing_Write(&Ring, Block, WAVPLAYER_PRODUCE_BLOCK);
+	}
+}
+
+// Take the next sample for the DAC. Pausing ramps the gain down to the
+// mid-point before the ring is left alone, and resuming ramps it back up, so
+// neither clicks. If the ring runs dry the last sample is held.
+static uint32_t WavPlayer_NextOutput(void) {
+	uint8_t Sample;
+
+	if (isPaused) {
+		if (RampGain == 0)
+			return 128;
+		RampGain -= WAVPLAYER_RAMP_STEP;
+	} else if (RampGain < 256) {
+		RampGain += WAVPLAYER_RAMP_STEP;
+	}
+
+	if (AudioRing_Pop(&Ring, &Sample))
+		currChar = Sample;
+	else if (SongEnded == 0)
+		++Ring.Underruns;
+
+	return (uint32_t)(128 + ((((int32_t)currChar - 128) * (int32_t)RampGain) >> 8));
+}
+
+#ifdef WAVPLAYER_USE_DMA
+// Fill one half of the ping-pong buffer from the ring
+static void WavPlayer_FillBlock(uint32_t *Block) {
+	uint32_t i;
+
+	for (i = 0; i < WAVPLAYER_DMA_BLOCK; ++i)
+		Block[i] = WAVPLAYER_DAC_VALUE(WavPlayer_NextOutput());
 }
 
+// Start the GPDMA streaming both halves to the DAC, paced by the DAC counter.
+static void Init_DMA(uint32_t Count) {
+	GPDMA_Channel_CFG_Type GPDMACfg;
+	DAC_CONVERTER_CFG_Type DACCfg;
+	uint8_t i;
+
+	for (i = 0; i < 2; ++i) {
+		DMALinkedList[i].SrcAddr = (uint32_t)DMABuffer[i];
+		DMALinkedList[i].DstAddr = (uint32_t)&(LPC_DAC->CR);
+		DMALinkedList[i].NextLLI = (uint32_t)&DMALinkedList[i ^ 1];
+		DMALinkedList[i].Control = GPDMA_DMACCxControl_TransferSize(WAVPLAYER_DMA_BLOCK)
+								 | GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD)
+								 | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD)
+								 | GPDMA_DMACCxControl_SI
+								 | GPDMA_DMACCxControl_I;
+	}
+
+	// The first half comes from the channel setup, which then follows the list into the second
+	GPDMACfg.ChannelNum = WAVPLAYER_DMA_CHANNEL;
+	GPDMACfg.SrcMemAddr = (uint32_t)DMABuffer[0];
+	GPDMACfg.DstMemAddr = 0;
+	GPDMACfg.TransferSize = WAVPLAYER_DMA_BLOCK;
+	GPDMACfg.TransferWidth = 0;
+	GPDMACfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	GPDMACfg.SrcConn = 0;
+	GPDMACfg.DstConn = GPDMA_CONN_DAC;
+	GPDMACfg.DMALLI = (uint32_t)&DMALinkedList[1];
+	GPDMA_Setup(&GPDMACfg);
+
+	DACCfg.DBLBUF_ENA = SET;
+	DACCfg.CNT_ENA = SET;
+	DACCfg.DMA_ENA = SET;
+	DAC_SetDMATimeOut(LPC_DAC, Count);
+	DAC_ConfigDAConverterControl(LPC_DAC, &DACCfg);
+
+	NVIC_SetPriority(DMA_IRQn, ((0x01<<4)|0x01));
+	NVIC_EnableIRQ(DMA_IRQn);
+	GPDMA_ChannelCmd(WAVPLAYER_DMA_CHANNEL, ENABLE);
+}
+#else
 static void Init_Timer0(uint32_t Time, uint32_t Prescale) {
 	TIM_TIMERCFG_Type TIM_ConfigStruct;
 	TIM_MATCHCFG_Type TIM_MatchConfigStruct;
-	TIM_ConfigStruct.PrescaleOption = TIM_PRESCALE_USVAL;
+	TIM_ConfigStruct.PrescaleOption = TIM_PRESCALE_TICKVAL;
 	TIM_ConfigStruct.PrescaleValue = Prescale;
 	TIM_MatchConfigStruct.MatchChannel = 0;
 	TIM_MatchConfigStruct.IntOnMatch = TRUE;
@@ -96,138 +331,334 @@ static void Init_Timer0(uint32_t Time, uint32_t Prescale) {
 	TIM_ResetCounter(LPC_TIM0);
 	TIM_Cmd(LPC_TIM0, ENABLE);
 }
+#endif
+
+// Hand a queued asset to its mixer voice. Runs in the audio task, which owns the mixer.
+static void WavPlayer_StartVoice(const WavPlayer_Command_t *Command) {
+	WavPlayer_Source_t *Source;
+	uint8_t Voice = Command->Voice;
+	uint8_t i;
+
+	if (Voice == WAVPLAYER_VOICE_EFFECT) {
+		// A free effect voice, otherwise the one taken longest ago
+		Voice = NextEffect + 1;
+		for (i = 1; i < AUDIOMIXER_VOICES; ++i) {
+			if (Mixer.Voices[i].Active == 0) {
+				Voice = i;
+				break;
+			}
+		}
+		NextEffect = Voice % (AUDIOMIXER_VOICES - 1);
+	}
 
-uint32_t SongPosition = 0;
-uint32_t SongLength = 0;
-const uint8_t* SongPointer;
+	if (Command->Tune != 0) {
+		Synth_Init(&Synths[Voice], Command->Tune, WAVPLAYER_OUTPUT_RATE);
+		AudioMixer_Start(&Mixer, Voice, Synth_Fill, &Synths[Voice], WAVPLAYER_OUTPUT_RATE, Command->Gain);
+		return;
+	}
 
-uint8_t isPaused = 0;
-void WavPlayer_Play(const uint8_t *WavArray, const uint32_t Length)
-{
-	portTickType Delay;
-	uint32_t SampleRate = 0;
-	uint32_t Position = 0;
+	Source = &Sources[Voice];
+	WavPlayer_OpenSource(Source, &Command->Descriptor);
+	AudioMixer_Start(&Mixer, Voice, WavPlayer_ReadSource, Source, Source->Format.SampleRate, Command->Gain);
 
-	isPaused = 0;
+	if (Voice == WAVPLAYER_VOICE_MUSIC) {
+		AudioMixer_SetNext(&Mixer, Voice, WavPlayer_NextSource);
+		PendingPlay = 0;
+	}
+}
 
-	// Check RIFF header
-	if ((WavArray[Position+0] != 'R') && (WavArray[Position+0] != 'r'))
-		return;
-	if ((WavArray[Position+1] != 'I') && (WavArray[Position+1] != 'i'))
-		return;
-	if ((WavArray[Position+2] != 'F') && (WavArray[Position+2] != 'f'))
-		return;
-	if ((WavArray[Position+3] != 'F') && (WavArray[Position+3] != 'f'))
+// Make sure the output is running now that a voice has started. Runs in the
+// audio task so it is the only producer for the ring.
+static void WavPlayer_Start(void) {
+	// Still draining the end of the last sound: just carry on producing
+	taskENTER_CRITICAL();
+		if (OutputActive) {
+			SongEnded = 0;
+#ifdef WAVPLAYER_USE_DMA
+			DMADrain = 0;
+#endif
+		}
+	taskEXIT_CRITICAL();
+	if (OutputActive)
 		return;
-	// Move past "RIFF"
-	Position += 4;
-	// Move past header
-	Position += 4;
 
-	// Format header
-	if ((WavArray[Position+0] != 'W') && (WavArray[Position+0] != 'w'))
-		return;
-	if ((WavArray[Position+1] != 'A') && (WavArray[Position+1] != 'a'))
-		return;
-	if ((WavArray[Position+2] != 'V') && (WavArray[Position+2] != 'v'))
-		return;
-	if ((WavArray[Position+3] != 'E') && (WavArray[Position+3] != 'e'))
-		return;
-	// Move past "WAVE"
-	Position += 4;
+	SongEnded = 0;
+	OutputActive = 1;
+	currChar = 128;
+	RampGain = isPaused ? 0 : 256;
+	Amplifier_Wake();
+
+	// Prime the ring before the output starts pulling from it
+	AudioRing_Reset(&Ring);
+	WavPlayer_Produce();
+
+#ifdef WAVPLAYER_USE_DMA
+	// Play using the GPDMA
+	DMAHalf = 0;
+	DMADrain = 0;
+	WavPlayer_FillBlock(DMABuffer[0]);
+	WavPlayer_FillBlock(DMABuffer[1]);
+	// Sample periods are counted in DAC peripheral clock cycles
+	SampleClock_Init(&OutputClock, CLKPWR_GetPCLK(CLKPWR_PCLKSEL_DAC), WAVPLAYER_OUTPUT_RATE);
+	Init_DMA(WAVPLAYER_RELOAD(SampleClock_Next(&OutputClock, WAVPLAYER_DMA_BLOCK)));
+#else
+	// Play using timer0
+	// Sample periods are counted in Timer0 peripheral clock cycles, one per tick
+	SampleClock_Init(&OutputClock, CLKPWR_GetPCLK(CLKPWR_PCLKSEL_TIMER0), WAVPLAYER_OUTPUT_RATE);
+	Init_Timer0(WAVPLAYER_RELOAD(SampleClock_Next(&OutputClock, 1)), 1);
+#endif
+}
 
-	// Sub header 1 ID
-	if ((WavArray[Position+0] != 'F') && (WavArray[Position+0] != 'f'))
-		return;
-	if ((WavArray[Position+1] != 'M') && (WavArray[Position+1] != 'm'))
-		return;
-	if ((WavArray[Position+2] != 'T') && (WavArray[Position+2] != 't'))
+// Look up the descriptor for an asset, parsing its RIFF chunks only the first time it is seen
+const WavFormat_Descriptor_t* WavPlayer_GetDescriptor(const uint8_t *WavArray, const uint32_t Length)
+{
+	WavPlayer_CacheEntry_t *Entry;
+	WavFormat_Descriptor_t Descriptor;
+	uint8_t i;
+
+	for (i = 0; i < WAVPLAYER_CACHE_SIZE; ++i)
+	{
+		if (DescriptorCache[i].WavArray == WavArray)
+			return &DescriptorCache[i].Descriptor;
+	}
+
+	// Parsed aside, so an asset that is rejected leaves the cache entry it would have replaced intact
+	if (!WavFormat_Parse(WavArray, Length, &Descriptor))
+		return 0;
+	// Uncompressed PCM, or mono IMA-ADPCM with at least one sample per block
+	if ((Descriptor.Format == WAVFORMAT_IMA_ADPCM)
+		&& ((Descriptor.Channels != 1) || (Descriptor.BlockAlign <= IMAADPCM_HEADER_SIZE)))
+		return 0;
+	if ((Descriptor.Format != WAVFORMAT_PCM) && (Descriptor.Format != WAVFORMAT_IMA_ADPCM))
+		return 0;
+
+	Entry = &DescriptorCache[DescriptorCacheNext];
+	Entry->WavArray = WavArray;
+	Entry->Descriptor = Descriptor;
+	DescriptorCacheNext = (DescriptorCacheNext + 1) % WAVPLAYER_CACHE_SIZE;
+	return &Entry->Descriptor;
+}
+
+// Queue a song for the music voice, which takes over from whatever song is playing
+void WavPlayer_Play(const uint8_t *WavArray, const uint32_t Length)
+{
+	const WavFormat_Descriptor_t *Descriptor;
+
+	Descriptor = WavPlayer_GetDescriptor(WavArray, Length);
+	if (Descriptor == 0)
 		return;
-	if ((WavArray[Position+3] != ' '))
+
+	WavPlayer_PlayDescriptor(Descriptor);
+}
+
+// As WavPlayer_Play, for assets already described (e.g. generated by tools/wav2c)
+void WavPlayer_PlayDescriptor(const WavFormat_Descriptor_t *Descriptor)
+{
+	WavPlayer_Command_t Command;
+
+	Command.Descriptor = *Descriptor;
+	Command.Tune = 0;
+	Command.Voice = WAVPLAYER_VOICE_MUSIC;
+	Command.Gain = AUDIOMIXER_UNITY;
+
+	isPaused = 0;
+	PendingPlay = 1;
+	if (xQueueSendToBack(CommandQueue, &Command, 0) != pdPASS) {
+		PendingPlay = 0;
 		return;
-	// Move past "fmt "
-	Position += 4;
+	}
+	xSemaphoreGive(WakeSemaphore);
+}
 
-	// Skip ChunkSize (4 bytes), CompressionCode (2 bytes), NumberOfChannels (2 bytes)
-	Position += 8;
+// Set the callback asked for the next song whenever the music voice ends, so
+// songs follow each other without a gap. It runs in the audio task; it is
+// called with Next = 0 when the stop button cuts the music off.
+void WavPlayer_SetNextTrack(WavPlayer_NextTrack_t Callback)
+{
+	NextTrack = Callback;
+}
 
-	// Sample rate
-	SampleRate = (WavArray[Position+0] | (WavArray[Position+1] << 8) | (WavArray[Position+2] << 16) | (WavArray[Position+3] << 24));
-	Position += 4;
+// Play a sound effect over the music on a free effect voice. Gain is relative
+// to AUDIOMIXER_UNITY. Dropped if the audio task is already too far behind.
+void WavPlayer_PlayEffect(const WavFormat_Descriptor_t *Descriptor, uint16_t Gain)
+{
+	WavPlayer_Command_t Command;
 
-	// Calculate delay
-	Delay = (1000000 / SampleRate) / portTICK_RATE_MS;
+	Command.Descriptor = *Descriptor;
+	Command.Tune = 0;
+	Command.Voice = WAVPLAYER_VOICE_EFFECT;
+	Command.Gain = Gain;
 
-	// Skip ByteRate (4 bytes), Align (2 bytes), BitsPerSample (2 bytes)
-	Position += 8;
+	if (xQueueSendToBack(CommandQueue, &Command, 0) == pdPASS)
+		xSemaphoreGive(WakeSemaphore);
+}
 
-	// Sub header 2 ID
-	if ((WavArray[Position+0] != 'D') && (WavArray[Position+0] != 'd'))
-		return;
-	if ((WavArray[Position+1] != 'A') && (WavArray[Position+1] != 'a'))
-		return;
-	if ((WavArray[Position+2] != 'T') && (WavArray[Position+2] != 't'))
-		return;
-	if ((WavArray[Position+3] != 'A') && (WavArray[Position+3] != 'a'))
-		return;
-	Position += 4;
+// As WavPlayer_PlayEffect, for a synth tune (see Synth.h and tools/tune2c)
+void WavPlayer_PlayTune(const uint8_t *Tune, uint16_t Gain)
+{
+	WavPlayer_Command_t Command;
 
-	//Skip chunk size
-	Position += 4;
+	Command.Tune = Tune;
+	Command.Voice = WAVPLAYER_VOICE_EFFECT;
+	Command.Gain = Gain;
 
-	// Play using timer0
-	SongPosition = Position;
-	SongLength = Length;
-	SongPointer = WavArray;
-	Init_Timer0(Delay, 1);
+	if (xQueueSendToBack(CommandQueue, &Command, 0) == pdPASS)
+		xSemaphoreGive(WakeSemaphore);
 }
 
-uint32_t currChar;
-void TIMER0_IRQHandler(void) {
-	if(isPaused == 0) {
-
-		if (SongPosition < SongLength)
-		{
-			currChar = (uint32_t)(SongPointer[SongPosition++]);
-			DAC_UpdateValue(LPC_DAC, currChar*4);
-
-			if (((GPIO_ReadValue(1) >> 31) & 0x01) == 0){
-				TIM_Cmd(LPC_TIM0, DISABLE);
-				NVIC_DisableIRQ(TIMER0_IRQn);
-				SongPosition = 0;
-				SongLength = 0;
-				SongPointer = 0;
+/******************************************************************************
+ * Description:	Low priority audio task. Keeps the sample ring topped up in
+ *				blocks so the output interrupt only has to pop one sample.
+ *****************************************************************************/
+void WavPlayer_Task(void *pvParameters)
+{
+	WavPlayer_Command_t Command;
+	uint8_t Started = 0;
+	uint8_t StopArmed = 0;		// The right button has been up since the output started
+	uint8_t i;
+
+	(void)pvParameters;
+
+	for(;;)
+	{
+		// Woken by a new sound or by the output draining the ring; the timeout
+		// keeps the stop button responsive while paused
+		xSemaphoreTake(WakeSemaphore, WAVPLAYER_POLL_TICKS);
+
+		while (xQueueReceive(CommandQueue, &Command, 0) == pdPASS) {
+			WavPlayer_StartVoice(&Command);
+			Started = 1;
+		}
+		if (Started) {
+			if (!OutputActive)
+				StopArmed = 0;
+			WavPlayer_Start();
+			Started = 0;
+		}
+
+		if (OutputActive) {
+			// Only a press made while the sound plays stops it: the right button is
+			// still held when both buttons have just started the playlist
+			if (((GPIO_ReadValue(1) >> 31) & 0x01) != 0) {
+				StopArmed = 1;
+				WavPlayer_Produce();
+			} else if (StopArmed) {
+				StopArmed = 0;
+				WavPlayer_Stop();
+				for (i = 0; i < AUDIOMIXER_VOICES; ++i)
+					AudioMixer_Stop(&Mixer, i);
+				// Let whoever queues the songs know nothing follows
+				if (NextTrack != 0)
+					NextTrack(0);
+			} else {
+				WavPlayer_Produce();
 			}
 		}
-		else
-		{
-			TIM_Cmd(LPC_TIM0, DISABLE);
-			NVIC_DisableIRQ(TIMER0_IRQn);
-			SongPosition = 0;
-			SongLength = 0;
-			SongPointer = 0;
+	}
+}
+
+#ifdef WAVPLAYER_USE_DMA
+// Runs once per half buffer: refill the half that has just been played while
+// the DMA carries on with the other one. Called from DMA_IRQHandler, which
+// the GPDMA shares with the SPI driver.
+void WavPlayer_DMAHandler(void) {
+	uint8_t Finished;
+
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, WAVPLAYER_DMA_CHANNEL)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, WAVPLAYER_DMA_CHANNEL);
+		++InterruptCount;
+
+		Finished = DMAHalf;
+		DMAHalf ^= 1;
+
+		if (SongEnded && (AudioRing_Level(&Ring) == 0) && (++DMADrain >= 2)) {
+			// Both halves holding the end of the song have now been played
+			WavPlayer_Stop();
+		} else {
+			WavPlayer_FillBlock(DMABuffer[Finished]);
+			// Period for the half now playing, so the long-run rate matches the header
+			LPC_DAC->CNTVAL = WAVPLAYER_RELOAD(SampleClock_Next(&OutputClock, WAVPLAYER_DMA_BLOCK));
+			if ((SongEnded == 0) && (AudioRing_Level(&Ring) <= WAVPLAYER_REFILL_LEVEL))
+				WavPlayer_WakeFromISR();
 		}
+	}
+
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, WAVPLAYER_DMA_CHANNEL)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, WAVPLAYER_DMA_CHANNEL);
+		WavPlayer_Stop();
+	}
+}
+#else
+void TIMER0_IRQHandler(void) {
+	uint32_t Level;
+	ISRPROFILE_ENTER();
+
+	++InterruptCount;
+	// Length of the next sample period; the counter has just reset on the last match
+	LPC_TIM0->MR0 = WAVPLAYER_RELOAD(SampleClock_Next(&OutputClock, 1));
 
+	Level = AudioRing_Level(&Ring);
+	if (SongEnded && (Level == 0))
+	{
+		WavPlayer_Stop();
+	}
+	else
+	{
+		DAC_UpdateValue(LPC_DAC, WavPlayer_NextOutput()*4);
+
+		// Crossing the refill level happens once per drain, so wake the producer once
+		if ((SongEnded == 0) && (Level != AudioRing_Level(&Ring)) && (AudioRing_Level(&Ring) == WAVPLAYER_REFILL_LEVEL))
+			WavPlayer_WakeFromISR();
 	}
 	TIM_ClearIntPending(LPC_TIM0, TIM_MR0_INT);
+	ISRPROFILE_EXIT(ISRPROFILE_TIMER0);
+}
+#endif
+
+// Something is coming out of the DAC, rather than silence or a finished pause ramp
+uint8_t WavPlayer_IsAudible(void) {
+	if (OutputActive && ((isPaused == 0) || (RampGain != 0)))
+		return 1;
+	return 0;
 }
 
+// A song is on the music voice; effects on their own do not count
 uint8_t WavPlayer_IsPlaying(void) {
-	if (SongPointer != 0)
+	if (Mixer.Voices[WAVPLAYER_VOICE_MUSIC].Active || PendingPlay)
 		return 1;
 	return 0;
 }
 
+// Software volume applied by the audio task, 0 (mute) to 256 (unity)
+void WavPlayer_SetVolume(uint16_t NewVolume) {
+	if (NewVolume > 256)
+		NewVolume = 256;
+	Volume = NewVolume;
+}
+
+void WavPlayer_GetBufferStats(AudioRing_Stats_t *Stats) {
+	AudioRing_GetStats(&Ring, Stats);
+}
+
+void WavPlayer_ResetBufferStats(void) {
+	AudioRing_ResetStats(&Ring);
+}
+
+uint32_t WavPlayer_GetInterruptCount(void) {
+	return InterruptCount;
+}
+
 uint8_t getIsPaused(void) {
 	return isPaused;
 }
 
 
+// Pause or resume; the output ramps rather than cutting off. Safe from interrupts.
 void togglePauseSong(void) {
 	if(isPaused == 1){
 		isPaused = 0;
+		Amplifier_Wake();
 	}else{
 		isPaused = 1;
 	}
 }
-
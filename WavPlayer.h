@@ -0,0 +1,67 @@
+/**************************************************************************//**
+ *
+ * @file		WavPlayer.h
+ * @brief		Header file for a wav file player using the DAC
+ * @author		Vlad Cazan
+ * @author		Stephan Rochon
+ * @author		Tom Coxon
+ * @author		Geoffrey Daniels
+ * @version		1.0
+ * @date		19 July. 2012
+ *
+ * Copyright(C) 2012, Vlad Cazan and Stephan Rochon
+ * All rights reserved.
+ *
+******************************************************************************/
+
+#ifndef WAVPLAYER_H
+#define WAVPLAYER_H
+
+// Includes
+#include "LPC17xx.h"
+#include "WavFormat.h"
+#include "AudioRing.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define WAVPLAYER_USE_DMA					// Feed the DAC from GPDMA instead of the Timer0 interrupt
+#define WAVPLAYER_VOICE_MUSIC		0		// Mixer voice used by WavPlayer_Play
+#define WAVPLAYER_VOICE_EFFECT		0xFF	// Any other mixer voice, for WavPlayer_PlayEffect
+
+// Fill Next with the song to follow the current one and return 1, or return 0 to stop
+typedef uint8_t (*WavPlayer_NextTrack_t)(WavFormat_Descriptor_t *Next);
+
+//------------------------------------------------------------------------------
+
+// Sample songs
+#ifdef WAVPLAYER_INCLUDE_SAMPLESONGS
+extern const uint8_t WavPlayer_Sample[];
+extern const uint32_t WavPlayer_SampleLength;
+#endif
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void WavPlayer_Init(void);
+void WavPlayer_Play(const uint8_t *WavArray, const uint32_t Length);
+void WavPlayer_PlayDescriptor(const WavFormat_Descriptor_t *Descriptor);
+void WavPlayer_SetNextTrack(WavPlayer_NextTrack_t Callback);
+void WavPlayer_PlayEffect(const WavFormat_Descriptor_t *Descriptor, uint16_t Gain);
+void WavPlayer_PlayTune(const uint8_t *Tune, uint16_t Gain);
+const WavFormat_Descriptor_t* WavPlayer_GetDescriptor(const uint8_t *WavArray, const uint32_t Length);
+uint8_t WavPlayer_IsPlaying(void);
+uint8_t WavPlayer_IsAudible(void);
+void WavPlayer_Task(void *pvParameters);
+void WavPlayer_SetVolume(uint16_t NewVolume);
+void WavPlayer_GetBufferStats(AudioRing_Stats_t *Stats);
+void WavPlayer_ResetBufferStats(void);
+uint32_t WavPlayer_GetInterruptCount(void);
+#ifdef WAVPLAYER_USE_DMA
+void WavPlayer_DMAHandler(void);
+#endif
+
+uint8_t getIsPaused(void);
+void togglePauseSong(void);
+
+#endif // WAVPLAYER_H
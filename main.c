@@ -19,23 +19,20 @@
 #include "FreeRTOS_IO.h"
 #include "FreeRTOS_Task.h"
 #include "FreeRTOS_Queue.h"
-#include "FreeRTOS_Timers.h"
 #include "FreeRTOS_Semaphore.h"
 
 /******************************************************************************
  * Library includes.
  *****************************************************************************/
-#include "stdio.h"
 #include "LPC17xx.h"
 #include "LPC17xx_GPIO.h"
+#include "LPC17xx_GPDMA.h"
 
 /******************************************************************************
  * Defines and typedefs
  *****************************************************************************/
-#define SOFTWARE_TIMER_PERIOD_MS (1000 / portTICK_RATE_MS)	// The timer period (1 second)
 #define WAVPLAYER_INCLUDE_SAMPLESONGS						// Include the sample in WavPlayer_Sample.h
-//#define PutStringOLED PutStringOLED1						// Select which to use
-#define PutStringOLED PutStringOLED2						// Select which to use
+//#define DIAGNOSTICS_OLED_LINE 6							// Show interrupt load on this OLED line
 
 /******************************************************************************
  * Library includes.
@@ -44,7 +41,19 @@
 #include "pca9532.h"
 #include "joystick.h"
 #include "OLED.h"
+#include "Display.h"
+#include "Spi.h"
 #include "WavPlayer.h"
+#include "Playlist.h"
+#include "Amplifier.h"
+#include "AudioMixer.h"
+#include "Synth.h"
+#include "IsrProfile.h"
+#include "Uptime.h"
+#include "InputTrace.h"
+#include "RouteLatency.h"
+#include "GridPlanner.h"
+#include "Fmt.h"
 
 extern const uint8_t cantinaBandSample[];
 extern const uint32_t cantinaBandSampleLength;
@@ -59,20 +68,52 @@ Peripheral_Descriptor_t SPIPort;
 // Fixed Seven segment values. Encoded to be upside down.
 static const uint8_t SevenSegmentDecoder[] = {0x24, 0x7D, 0xE0, 0x70, 0x39, 0x32, 0x22, 0x7C, 0x20, 0x30};
 
-// Variables associated with the software timer
-static xTimerHandle SoftwareTimer = NULL;
-uint8_t Seconds, Minutes, Hours;
+// Interrupt load per source and idle time, display latency, SPI bus load and centre press to motor latency, refreshed every second by DiagnosticTask (watch them in the debugger)
+IsrProfile_Report_t IsrLoad;
+Display_Stats_t DisplayLoad;
+Spi_Report_t SpiLoad;
+RouteLatency_Report_t RouteLoad;
+
+// Rising chirp played when a route has been handed to the motors
+static const uint8_t RouteTune[] = {SYNTH_SQUARE, 40, 2, 20, 160, 20, 84, 2, 91, 3, SYNTH_END};
 
 // Variables associated with the WEEE navigation
 unsigned dx = 0, dy = 0, cx = 0, cy = 0;
 
+// The warehouse floor, north at the top and the robot's starting cell (0, 0) in the middle; '#' is a shelf
+#define WAREHOUSE_WIDTH		16
+#define WAREHOUSE_HEIGHT	16
+#define WAREHOUSE_LEFT		-8
+#define WAREHOUSE_BOTTOM	-8
+static const char *const WarehouseMap[WAREHOUSE_HEIGHT] = {
+	"................",
+	"......######....",
+	"...##...........",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"...##........#..",
+	"......######....",
+	"................",
+	"................",
+};
+
 /******************************************************************************
  * Semaphores
  *****************************************************************************/
 
 // Include all your semaphore declarations here
 //xSemaphoreHandle xCountingSemaphore;
-xSemaphoreHandle SPISemaphore = 0;
+
+// Given whenever currentState moves to ROUTING or MOTOR, so those tasks sleep until there is work
+xSemaphoreHandle routingWakeSemaphore;
+xSemaphoreHandle motorWakeSemaphore;
 
 // Message queue
 long joystickToRoutingSend;
@@ -91,57 +132,6 @@ xQueueHandle routingToMotorQueueHandle = 0;
 /******************************************************************************
  * Task Defintions
  *****************************************************************************/
-/******************************************************************************
- * Description:	The callback function assigned to the SoftwareTimer.
- *
- *****************************************************************************/
-static void SoftwareTimerCallback(xTimerHandle xTimer)
-{
-    (void)xTimer;
-
-	// Increment timers, inside critical so that they can't be accessed while updating them
-	taskENTER_CRITICAL();
-		++Seconds;
-		if (Seconds == 60) { Seconds = 0; ++Minutes; }
-		if (Minutes == 60) { Minutes = 0; ++Hours; }
-	taskEXIT_CRITICAL();
-}
-
-
-/******************************************************************************
- * Description:	OLED helper writing functions. Put out entire string
- *				in one critical section.
- *****************************************************************************/
-void PutStringOLED1(uint8_t* String, uint8_t Line)
-{
-	uint8_t X = 2;
-	uint8_t Ret = 1;
-	while(1)
-	{
-		if ((*String)=='\0')
-			break;
-		taskENTER_CRITICAL();
-			Ret = OLED_Char(X, ((Line)%7)*9 + 1, *String++, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
-		taskEXIT_CRITICAL();
-		if (Ret == 0)
-			break;
-
-		X += 6;
-	}
-}
-
-
-/******************************************************************************
- * Description:	Put out characters one by one, each in a critical section
- *
- *****************************************************************************/
-void PutStringOLED2(uint8_t* String, uint8_t Line)
-{
-	taskENTER_CRITICAL();
-		OLED_String(2,  ((Line)%7)*9 + 1, String, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
-	taskEXIT_CRITICAL();
-}
-
 
 /******************************************************************************
  * Description:	This task counts seconds and shows the number on the seven
@@ -150,10 +140,22 @@ void PutStringOLED2(uint8_t* String, uint8_t Line)
 static void SevenSegmentTask(void *pvParameters)
 {
 	const portTickType TaskPeriodms = 1200UL / portTICK_RATE_MS;
+	const Spi_Device_t SevenSegment = {board7SEG_CS_PORT, board7SEG_CS_PIN, 0, 0};
+	Spi_Transaction_t Digit;
 	portTickType LastExecutionTime;
 	uint8_t i = 0;
 	(void)pvParameters;
 
+	// Highest priority on the SPI with no byte cap: one byte every 1200 ms, due within 10 ms
+	Digit.Client = Spi_AddClient("7SEG", 2, 0);
+	Digit.Deadline = 10 / portTICK_RATE_MS;
+	Digit.Device = &SevenSegment;
+	Digit.Command = 0;
+	Digit.CommandLength = 0;
+	Digit.DataLength = sizeof(uint8_t);
+	vSemaphoreCreateBinary(Digit.Done);
+	xSemaphoreTake(Digit.Done, 0);
+
 	// Initialise LastExecutionTime prior to the first call to vTaskDelayUntil().
 	// This only needs to be done once, as after this call, LastExectionTime is updated inside vTaskDelayUntil.
 	LastExecutionTime = xTaskGetTickCount();
@@ -162,20 +164,13 @@ static void SevenSegmentTask(void *pvParameters)
 	{
 		for(i = 0; i < 10; ++i)
 		{
-			if (xSemaphoreTake(SPISemaphore, 1000)){
-				// Critical section here so that we don't use the SPI at the same time as the OLED
-
-				//taskENTER_CRITICAL();
-				board7SEG_ASSERT_CS();
-				FreeRTOS_write(SPIPort, &(SevenSegmentDecoder[i]), sizeof(uint8_t)); // semaphore?
-				board7SEG_DEASSERT_CS();
-				//taskEXIT_CRITICAL();
-				// gives the semaphore back once done in here
-				xSemaphoreGive(SPISemaphore);
-
-				// Delay until it is time to update the display with a new digit.
-				vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
-			}
+			// The SPI driver orders this against the OLED and drives the chip select;
+			// this task sleeps until the digit is out
+			Digit.Data = &(SevenSegmentDecoder[i]);
+			Spi_Transfer(&Digit);
+
+			// Delay until it is time to update the display with a new digit.
+			vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
 		}
 	}
 }
@@ -183,11 +178,9 @@ static void SevenSegmentTask(void *pvParameters)
 
 
 /******************************************************************************
- * Description:	This task makes the top four lines of the OLED black boxes
+ * Description:	This task makes the top three lines of the OLED black boxes
  *
  *****************************************************************************/
-uint8_t row = 0;
-uint8_t column = 2;
 static void OLEDTask1(void *pvParameters)
 {
 	const portTickType TaskPeriodms = 1000UL / portTICK_RATE_MS;
@@ -197,51 +190,16 @@ static void OLEDTask1(void *pvParameters)
 
 	for(;;)
 	{
-		// mutex semaphore
-		// task must go through SPISemaphore to access SPI
-		// only one task is able to enter this statement
-		// OLEDTask1 and OLEDTask2 will take turns
-		if (xSemaphoreTake(SPISemaphore, 1000)){
-
-			//PutStringOLED((uint8_t*)"", row);
-			/*OLED_Char(column*6, ((row)%7)*9 + 1, (uint8_t)'', OLED_COLOR_BLACK, OLED_COLOR_WHITE);
-
-			if(column == 17){
-				column = 0;
-				// Move onto next row
-				if(row == 2){
-					row = 0;
-				}else{
-					row++;
-				}
-			}else{
-				column++;
-			}*/
-
-
-			PutStringOLED((uint8_t*)"", 0);
-			PutStringOLED((uint8_t*)"", 1);
-			PutStringOLED((uint8_t*)"", 2);
-
-			// gives the semaphore back once done in here
-			xSemaphoreGive(SPISemaphore);
-		}
+		Display_PutLine(0, "\177\177\177\177\177\177\177\177\177\177\177\177\177\177\177\177");
+		Display_PutLine(1, "\177\177\177\177\177\177\177\177\177\177\177\177\177\177\177\177");
+		Display_PutLine(2, "\177\177\177\177\177\177\177\177\177\177\177\177\177\177\177\177");
 
 		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms*10);
-
-		/*
-		PutStringOLED((uint8_t*)"", 0);
-		PutStringOLED((uint8_t*)"", 1);
-		PutStringOLED((uint8_t*)"", 2);
-		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
-		*/
-
-
 	}
 }
 
 /******************************************************************************
- * Description:	This task makes the top four lines of the OLED empty
+ * Description:	This task makes the top three lines of the OLED empty
  *
  *****************************************************************************/
 static void OLEDTask2(void *pvParameters)
@@ -253,37 +211,19 @@ static void OLEDTask2(void *pvParameters)
 
 	for(;;)
 	{
-		// mutex semaphore
-		// task must go through SPISemaphore to access SPI
-		// only one task is able to enter this statement
-		// OLEDTask1 and OLEDTask2 will take turns
-		if (xSemaphoreTake(SPISemaphore, 1000)){
-
-			PutStringOLED((uint8_t*)"                ", 0);
-			vTaskDelay((portTickType)100);
-			PutStringOLED((uint8_t*)"                ", 1);
-			vTaskDelay((portTickType)100);
-			PutStringOLED((uint8_t*)"                ", 2);
-			// gives the semaphore back once done in here
-			xSemaphoreGive(SPISemaphore);
-		}
-
-		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms*10);
-
-		/*
-		PutStringOLED((uint8_t*)"                ", 0);
+		Display_PutLine(0, "");
 		vTaskDelay((portTickType)100);
-		PutStringOLED((uint8_t*)"                ", 1);
+		Display_PutLine(1, "");
 		vTaskDelay((portTickType)100);
-		PutStringOLED((uint8_t*)"                ", 2);
-		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
-		*/
+		Display_PutLine(2, "");
+
+		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms*10);
 	}
 }
 
 
 /******************************************************************************
- * Description:	This task makes the top four lines of the OLED a char
+ * Description:	This task makes the top three lines of the OLED a char
  *
  *****************************************************************************/
 static void OLEDTask3(void *pvParameters)
@@ -295,32 +235,12 @@ static void OLEDTask3(void *pvParameters)
 
 	for(;;)
 	{
-		// mutex semaphore
-		// task must go through SPISemaphore to access SPI
-		// only one task is able to enter this statement
-		// OLEDTask1 and OLEDTask2 will take turns
-		if (xSemaphoreTake(SPISemaphore, 1000)){
-
-			PutStringOLED((uint8_t*)"<<<<<<<<<<<<<<< ", 0);
-			PutStringOLED((uint8_t*)" >>>>>>>>>>>>>>>", 1);
-			vTaskDelay((portTickType)400);
-			PutStringOLED((uint8_t*)"<<<<<<<<<<<<<<< ", 2);
-
-			// gives the semaphore back once done in here
-			xSemaphoreGive(SPISemaphore);
-		}
-
-		//vTaskDelay(TaskPeriodms);
-		vTaskDelayUntil(&LastExecutionTime,TaskPeriodms*10);
-
-		/*
-		PutStringOLED((uint8_t*)"<<<<<<<<<<<<<<< ", 0);
-		PutStringOLED((uint8_t*)" >>>>>>>>>>>>>>>", 1);
+		Display_PutLine(0, "<<<<<<<<<<<<<<< ");
+		Display_PutLine(1, " >>>>>>>>>>>>>>>");
 		vTaskDelay((portTickType)400);
-		PutStringOLED((uint8_t*)"<<<<<<<<<<<<<<< ", 2);
-		//vTaskDelay(TaskPeriodms);
-		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
-		*/
+		Display_PutLine(2, "<<<<<<<<<<<<<<< ");
+
+		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms*10);
 	}
 }
 
@@ -338,26 +258,6 @@ static void OLEDTask4(void *pvParameters)
 
 	for(;;)
 	{
-		// mutex semaphore
-		// task must go through SPISemaphore to access SPI
-		// only one task is able to enter this statement
-		// OLEDTask1 and OLEDTask2 will take turns
-		if (xSemaphoreTake(SPISemaphore, 10)){
-			if (Up)
-				Buffer[ID] = '+';
-			else
-				Buffer[ID] = '-';
-
-			if (ID == 15) { ID = 0; Up = !Up; }
-			else { ++ID; }
-			// gives the semaphore back once done in here
-			xSemaphoreGive(SPISemaphore);
-			PutStringOLED((uint8_t*)Buffer, 3);
-		}
-
-		vTaskDelay(TaskPeriodms);
-
-		/*_
 		if (Up)
 			Buffer[ID] = '+';
 		else
@@ -366,10 +266,9 @@ static void OLEDTask4(void *pvParameters)
 		if (ID == 15) { ID = 0; Up = !Up; }
 		else { ++ID; }
 
-		PutStringOLED((uint8_t*)Buffer, 3);
+		Display_PutLine(3, Buffer);
 
 		vTaskDelay(TaskPeriodms);
-		*/
 	}
 }
 
@@ -379,107 +278,106 @@ static void OLEDTask4(void *pvParameters)
 
 /******************************************************************************
  * Description:	This task displays the running time every five seconds
- * 				Not currently running
+ *
  *****************************************************************************/
 static void OLEDTask5(void *pvParameters)
 {
 	const portTickType TaskPeriodms = 5000UL / portTICK_RATE_MS;
 	char Buffer[17];
+	char *Next;
+	Uptime_Clock_t Clock;
 	portTickType LastExecutionTime;
 	(void)pvParameters;
 	LastExecutionTime = xTaskGetTickCount();
 
 	for(;;)
 	{
-		// mutex semaphore
-		// task must go through SPISemaphore to access SPI
-		// only one task is able to enter this statement
-		// OLEDTask1 and OLEDTask2 will take turns
-		if (xSemaphoreTake(SPISemaphore, 1000)){
-
-			// remove critical?
-			// Critical to prevent time variables being changed to while writing
-			//taskENTER_CRITICAL();
-				if ((Hours < 10) && (Minutes < 10) && (Seconds < 10))	sprintf(Buffer, "Time:  0%d:0%d:0%d", (int)Hours, Minutes, Seconds);
-				else if ((Hours < 10) && (Minutes < 10))				sprintf(Buffer, "Time:  0%d:0%d:%d", (int)Hours, Minutes, Seconds);
-				else if ((Hours < 10) && (Seconds < 10))				sprintf(Buffer, "Time:  0%d:%d:0%d", (int)Hours, Minutes, Seconds);
-				else if ((Minutes < 10) && (Seconds < 10))				sprintf(Buffer, "Time:  %d:0%d:0%d", (int)Hours, Minutes, Seconds);
-				else if (Seconds < 10)									sprintf(Buffer, "Time:  %d:%d:0%d", (int)Hours, Minutes, Seconds);
-				else if (Minutes < 10)									sprintf(Buffer, "Time:  %d:0%d:%d", (int)Hours, Minutes, Seconds);
-				else if (Hours < 10)									sprintf(Buffer, "Time:  0%d:%d:%d", (int)Hours, Minutes, Seconds);
-				else 													sprintf(Buffer, "Time:  %d:%d:%d", (int)Hours, Minutes, Seconds);
-			//taskEXIT_CRITICAL();
-
-			PutStringOLED((uint8_t*)Buffer, 6);
-
-			// gives the semaphore back once done in here
-			xSemaphoreGive(SPISemaphore);
-		}
+		Uptime_ToClock(Uptime_Micros(), &Clock);
+		Next = Fmt_Text(Buffer, "Time:  ", 0);
+		Next = Fmt_Unsigned(Next, Clock.Hours, 2, '0');
+		*Next++ = ':';
+		Next = Fmt_Unsigned(Next, Clock.Minutes, 2, '0');
+		*Next++ = ':';
+		Next = Fmt_Unsigned(Next, Clock.Seconds, 2, '0');
+		*Next = '\0';
 
+		Display_PutLine(6, Buffer);
 
 		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
-
-		/*
-		// Critical to prevent time variables being changed to while writing
-		taskENTER_CRITICAL();
-			if ((Hours < 10) && (Minutes < 10) && (Seconds < 10))	sprintf(Buffer, "Time:  0%d:0%d:0%d", (int)Hours, Minutes, Seconds);
-			else if ((Hours < 10) && (Minutes < 10))				sprintf(Buffer, "Time:  0%d:0%d:%d", (int)Hours, Minutes, Seconds);
-			else if ((Hours < 10) && (Seconds < 10))				sprintf(Buffer, "Time:  0%d:%d:0%d", (int)Hours, Minutes, Seconds);
-			else if ((Minutes < 10) && (Seconds < 10))				sprintf(Buffer, "Time:  %d:0%d:0%d", (int)Hours, Minutes, Seconds);
-			else if (Seconds < 10)									sprintf(Buffer, "Time:  %d:%d:0%d", (int)Hours, Minutes, Seconds);
-			else if (Minutes < 10)									sprintf(Buffer, "Time:  %d:0%d:%d", (int)Hours, Minutes, Seconds);
-			else if (Hours < 10)									sprintf(Buffer, "Time:  0%d:%d:%d", (int)Hours, Minutes, Seconds);
-			else 													sprintf(Buffer, "Time:  %d:%d:%d", (int)Hours, Minutes, Seconds);
-		taskEXIT_CRITICAL();
-
-		PutStringOLED((uint8_t*)Buffer, 6);
-
-		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
-		*/
 	}
 }
 
 
 /******************************************************************************
- * Description:	This task starts the tune playing, and displays its
- * 				current state on the OLED
+ * Description:	This task starts the playlist when asked to, and displays
+ * 				its current state on the OLED. It sleeps until the
+ * 				playlist has something to report.
  *****************************************************************************/
-
-struct song {
-	uint8_t *sample; // The wav file array
-	uint32_t sampleLength; // Length of the array
-};
-struct song playList[2];
-uint8_t playListIndex = 0;
-
 static void TuneTask(void *pvParameters)
 {
-	const portTickType TaskPeriodms =10UL / portTICK_RATE_MS;
-	uint8_t SongStarted = 1;
+	Playlist_Event_t Event;
 	(void)pvParameters;
 
 	for(;;)
 	{
-		// Pressing both buttons at same time (left and right)
-		if ((((GPIO_ReadValue(0) >> 4) & 0x01) == 0) && (((GPIO_ReadValue(1) >> 31) & 0x01) == 0) && (WavPlayer_IsPlaying() == 0))
-		{
-			PutStringOLED((uint8_t*)" Tune: Playing  ", 4);
-			SongStarted = 1;
+		Playlist_WaitEvent(&Event, portMAX_DELAY);
 
-			// Play tune
-			WavPlayer_Play(playList[playListIndex].sample, playList[playListIndex].sampleLength);
-			// Move the play list pointer onto the next song (only two songs atm)
-			//if(playListIndex == 0){ playListIndex = 1; }else{ playListIndex = 0; }
+		switch (Event.Type)
+		{
+			case PLAYLIST_EVENT_START:
+				// Pressing both buttons at same time (left and right)
+				if (WavPlayer_IsPlaying() == 0)
+					Playlist_Play();
+				break;
+			case PLAYLIST_EVENT_TRACK:
+				Display_PutLine(4, " Tune: Playing  ");
+				break;
+			case PLAYLIST_EVENT_END:
+			case PLAYLIST_EVENT_STOPPED:
+				Display_PutLine(4, " Tune: Stopped  ");
+				break;
+		}
+	}
+}
 
-			// gives the semaphore back once done in here
+/******************************************************************************
+ * Description:	Every second, collects how many cycles each instrumented
+ *				interrupt has used and works out its share of the CPU, and
+ *				how quickly and cheaply the display kept up, how busy the
+ *				SPI bus was and how long routes took to reach the motors.
+ *				Optionally
+ *				cycles through the interrupt sources on one OLED line.
+ *****************************************************************************/
+static void DiagnosticTask(void *pvParameters)
+{
+	const portTickType TaskPeriodms = 1000UL / portTICK_RATE_MS;
+	portTickType LastExecutionTime;
+#ifdef DIAGNOSTICS_OLED_LINE
+	char Buffer[17];
+	char *Next;
+	uint8_t Source = 0;
+#endif
+	(void)pvParameters;
 
-		} else if ((WavPlayer_IsPlaying() == 0) && (SongStarted == 1)) {
-			PutStringOLED((uint8_t*)" Tune: Stopped  ", 4);
-			SongStarted = 0;
-			// If just left button is pressed
-		}
+	LastExecutionTime = xTaskGetTickCount();
 
-		vTaskDelay(TaskPeriodms);
+	for(;;)
+	{
+		vTaskDelayUntil(&LastExecutionTime, TaskPeriodms);
+		IsrProfile_Report(&IsrLoad);
+		Display_Report(&DisplayLoad);
+		Spi_Report(&SpiLoad);
+		RouteLatency_Report(&RouteLoad);
+
+#ifdef DIAGNOSTICS_OLED_LINE
+		Next = Fmt_Text(Buffer, IsrProfile_Name(Source), 6);
+		*Next++ = ' ';
+		Next = Fmt_Fixed(Next, IsrLoad.Load[Source], 1, 5);
+		*Next++ = '%';
+		*Next = '\0';
+		Display_PutLine(DIAGNOSTICS_OLED_LINE, Buffer);
+		Source = (Source + 1) % ISRPROFILE_SOURCES;
+#endif
 	}
 }
 
@@ -505,21 +403,27 @@ struct motorInstruction {
 int finalGridPosition[2] = {0, 0};
 //struct motorInstruction queuedMotorInstructions[4];
 uint8_t motorInstructionIndex = 0;
+uint8_t motorInstructionCount = 0; // Instructions in the route being driven
+
+enum compass {NORTH, EAST, SOUTH, WEST};
+enum compass currentDirection = NORTH;
+
+// Cycles and search states the last route plan took (watch them in the debugger)
+uint32_t PlanCycles = 0;
+uint16_t PlanExpanded = 0;
 /******************************************************************************
- * Description:	Movement control. This task creates the movement objects required to reach the destination
+ * Description:	Movement control. This task plans the way round the shelves to the destination
+ *				and hands it to the motor task as movement objects.
+ *				It sleeps until the centre press hands it the joystick commands.
  *****************************************************************************/
 static void RoutingTask(void *pvParameters)
 {
-	const portTickType TaskPeriodms =10UL / portTICK_RATE_MS;
 	(void)pvParameters;
 
-	int xMovement;
-	int yMovement;
-
-	struct motorInstruction a1;
-	struct motorInstruction a2;
-	struct motorInstruction a3;
-	struct motorInstruction a4;
+	GridPlanner_Plan_t plan;
+	struct motorInstruction mi;
+	uint32_t planStart;
+	uint8_t planned;
 
 	int joystickCommands;
 
@@ -527,13 +431,16 @@ static void RoutingTask(void *pvParameters)
 
 	for(;;)
 	{
+		xSemaphoreTake(routingWakeSemaphore, portMAX_DELAY);
+
 		if(currentState == ROUTING){
 			// Reset expected grid position
 			finalGridPosition[X] = gridLocation[X];
 			finalGridPosition[Y] = gridLocation[Y];
 
-			for(i = 0; i < 20; i++){
-				if(xQueueReceive(joystickToRoutingQueueHandle, &joystickCommands, 10)){
+			// EINT3 queued every move before the centre press, so take exactly those without waiting
+			for(i = (uint8_t)uxQueueMessagesWaiting(joystickToRoutingQueueHandle); i > 0; i--){
+				if(xQueueReceive(joystickToRoutingQueueHandle, &joystickCommands, 0)){
 					switch(joystickCommands){
 						case FORWARDS:
 							finalGridPosition[Y]++;
@@ -551,93 +458,60 @@ static void RoutingTask(void *pvParameters)
 				}
 			}
 
-			xMovement = finalGridPosition[X] - gridLocation[X];
-			yMovement = finalGridPosition[Y] - gridLocation[Y];
-			motorInstructionIndex = 0;
-
-			if(xMovement > 0){
-				// Rotate right 90 degrees
-				a1.action_type = CLOCKWISE;
-				a1.magnitude = 90;
-				xQueueSend(routingToMotorQueueHandle, &a1, 1000);
-
-				// Move forward
-				a2.action_type = FORWARDS;
-				a2.magnitude = abs(xMovement);
-				xQueueSend(routingToMotorQueueHandle, &a2, 1000);
-
-				// Rotate left 90 degrees
-				a3.action_type = ANTICLOCKWISE;
-				a3.magnitude = 90;
-				xQueueSend(routingToMotorQueueHandle, &a3, 1000);
-
-			}else if(xMovement < 0){
-				// Rotate left 90 degrees
-				a1.action_type = ANTICLOCKWISE;
-				a1.magnitude = 90;
-				xQueueSend(routingToMotorQueueHandle, &a1, 1000);
-
-				// Move forward
-				a2.action_type = FORWARDS;
-				a2.magnitude = abs(xMovement);
-				xQueueSend(routingToMotorQueueHandle, &a2, 1000);
-
-				// Rotate right 90 degrees
-				a3.action_type = CLOCKWISE;
-				a3.magnitude = 90;
-				xQueueSend(routingToMotorQueueHandle, &a3, 1000);
-			}else{
-				// No X Movement
-				a1.action_type = NA;
-				a1.magnitude = 0;
-				xQueueSend(routingToMotorQueueHandle, &a1, 1000);
-
-				a2.action_type = NA;
-				a2.magnitude = 0;
-				xQueueSend(routingToMotorQueueHandle, &a2, 1000);
-
-				a3.action_type = NA;
-				a3.magnitude = 0;
-				xQueueSend(routingToMotorQueueHandle, &a3, 1000);
+			// Plan from where the robot is and the way it faces, with the fewest turns of the shortest ways
+			planStart = IsrProfile_Now();
+			planned = GridPlanner_Plan(gridLocation[X], gridLocation[Y], (uint8_t)currentDirection, finalGridPosition[X], finalGridPosition[Y], &plan);
+			PlanCycles = IsrProfile_Now() - planStart;
+			PlanExpanded = plan.Expanded;
+
+			motorInstructionIndex = 0; // Reset the index for the motor control task
+			motorInstructionCount = planned ? plan.Length : 0;
+
+			for(i = 0; i < motorInstructionCount; i++){
+				switch(plan.Steps[i].Action){
+					case GRIDPLANNER_FORWARD:
+						mi.action_type = FWD;
+						mi.magnitude = plan.Steps[i].Count;
+						break;
+					case GRIDPLANNER_BACKWARD:
+						mi.action_type = BKWD;
+						mi.magnitude = plan.Steps[i].Count;
+						break;
+					case GRIDPLANNER_CLOCKWISE:
+						mi.action_type = CLOCKWISE;
+						mi.magnitude = 90;
+						break;
+					default:
+						mi.action_type = ANTICLOCKWISE;
+						mi.magnitude = 90;
+						break;
+				}
+				// The queue holds a whole plan, and the motor task emptied it finishing the last one
+				xQueueSend(routingToMotorQueueHandle, &mi, 0);
 			}
 
-			if(yMovement > 0){
-				// Move forward
-				a4.action_type = FORWARDS;
-				a4.magnitude = abs(yMovement);
-				xQueueSend(routingToMotorQueueHandle, &a4, 1000);
-
-			}else if(yMovement < 0){
-				// Move backwards
-				a4.action_type = BACKWARDS;
-				a4.magnitude = abs(yMovement);
-				xQueueSend(routingToMotorQueueHandle, &a4, 1000);
+			if(motorInstructionCount == 0){
+				// Already there, or no way there round the shelves
+				ROUTELATENCY_NO_ROUTE();
+				currentState = JOYSTICK;
 			}else{
-				a4.action_type = NA;
-				a4.magnitude = 0;
-				xQueueSend(routingToMotorQueueHandle, &a4, 1000);
+				ROUTELATENCY_MARK(ROUTELATENCY_ROUTED);
+				currentState = MOTOR;
+				xSemaphoreGive(motorWakeSemaphore);
+				WavPlayer_PlayTune(RouteTune, AUDIOMIXER_UNITY / 2);
 			}
-
-			currentState = MOTOR;
-			motorInstructionIndex = 0; // Reset the index for the motor control task
-
 		}
-
-		// Delay the for loop
-		vTaskDelay(TaskPeriodms*2); //10ms
 	}
 }
 
 uint8_t movementSpeed = 20;
 /******************************************************************************
- * Description:	Moves the motors according to the movement structs, with encoder feedback
+ * Description:	Moves the motors according to the movement structs, with encoder feedback.
+ *				It sleeps until the route is ready or the encoders finish a movement.
  *****************************************************************************/
 enum movements currentMovement;
-enum compass {NORTH, EAST, SOUTH, WEST};
-enum compass currentDirection = NORTH;
 static void MotorControlTask(void *pvParameters)
 {
-	const portTickType TaskPeriodms =10UL / portTICK_RATE_MS;
 	(void)pvParameters;
 
 	uint8_t distance;
@@ -646,16 +520,20 @@ static void MotorControlTask(void *pvParameters)
 
 	for(;;)
 	{
+		xSemaphoreTake(motorWakeSemaphore, portMAX_DELAY);
+
 		if(currentState == MOTOR){
 			DFR_RobotInit();
 			DFR_IncGear();
 			DFR_IncGear();
 			// Move onto next action
 			if(xQueueReceive(routingToMotorQueueHandle, &mi, 10)){
+				ROUTELATENCY_MARK(ROUTELATENCY_DEQUEUED);
 				//switch(queuedMotorInstructions[motorInstructionIndex].action_type){
 				switch(mi.action_type){
-					case FORWARDS:
+					case FWD:
 						DFR_DriveForward(movementSpeed);
+						ROUTELATENCY_MARK(ROUTELATENCY_DRIVEN);
 						// Set left and right wheel magnitude for a given action
 						//DFR_SetRightWheelDestination(queuedMotorInstructions[motorInstructionIndex].magnitude);
 						//DFR_SetLeftWheelDestination(queuedMotorInstructions[motorInstructionIndex].magnitude);
@@ -664,8 +542,9 @@ static void MotorControlTask(void *pvParameters)
 						currentMovement = FORWARDS;
 						currentState = ENCODER;
 						break;
-					case BACKWARDS:
+					case BKWD:
 						DFR_DriveBackward(movementSpeed);
+						ROUTELATENCY_MARK(ROUTELATENCY_DRIVEN);
 						//DFR_SetRightWheelDestination(queuedMotorInstructions[motorInstructionIndex].magnitude);
 						//DFR_SetLeftWheelDestination(queuedMotorInstructions[motorInstructionIndex].magnitude);
 						DFR_SetRightWheelDestination(mi.magnitude);
@@ -675,6 +554,7 @@ static void MotorControlTask(void *pvParameters)
 						break;
 					case CLOCKWISE:
 						DFR_DriveRight(movementSpeed);
+						ROUTELATENCY_MARK(ROUTELATENCY_DRIVEN);
 						// If the magnitude is, for example, 90 degrees, this will correspond to a wheel destination of
 						//distance = queuedMotorInstructions[motorInstructionIndex].magnitude / 22.5;
 						distance = mi.magnitude / 22.5;
@@ -686,6 +566,7 @@ static void MotorControlTask(void *pvParameters)
 						break;
 					case ANTICLOCKWISE:
 						DFR_DriveLeft(movementSpeed);
+						ROUTELATENCY_MARK(ROUTELATENCY_DRIVEN);
 						//distance = queuedMotorInstructions[motorInstructionIndex].magnitude / 22.5;
 						distance = mi.magnitude / 22.5;
 						DFR_SetRightWheelDestination(distance);
@@ -697,19 +578,19 @@ static void MotorControlTask(void *pvParameters)
 					case NA:
 						// Go onto the next one
 						motorInstructionIndex++;
-						if(motorInstructionIndex == 4){
+						if(motorInstructionIndex == motorInstructionCount){
 							gridLocation[X] = finalGridPosition[X];
 							gridLocation[Y] = finalGridPosition[Y];
 							currentState = JOYSTICK;
 						}else{
+							// Straight on to the next one
 							currentState = MOTOR;
+							xSemaphoreGive(motorWakeSemaphore);
 						}
 						break;
 				}
 			}
 		}
-
-		vTaskDelay(TaskPeriodms);
 	}
 }
 
@@ -766,10 +647,22 @@ int main(void)
 
 	// Init OLED
 	OLED_Init(SPIPort);
-	OLED_ClearScreen(OLED_COLOR_WHITE);
+
+	// Init the interrupt cost counters before any of the interrupts are enabled
+	IsrProfile_Init();
+
+	// Start the uptime clock, which also times the input trace and the route latency
+	Uptime_Init();
+	InputTrace_Init();
+	RouteLatency_Init();
+
+	// Init the GPDMA, shared by the DAC and the SPI, then hand the SPI over to it now the OLED is set up
+	GPDMA_Init();
+	Spi_Init();
 
 	// Init wav player
 	WavPlayer_Init();
+	Playlist_Init();
 
 	// Joystick Init
 	joystick_init();
@@ -780,6 +673,9 @@ int main(void)
 	// Init Chassis Driver
 	DFR_RobotInit();
 
+	// Load the shelves for the route planner
+	GridPlanner_Load(WarehouseMap, WAREHOUSE_WIDTH, WAREHOUSE_HEIGHT, WAREHOUSE_LEFT, WAREHOUSE_BOTTOM);
+
 	// Port 0
 	// Left switch | Joystick DOWN P0[15] | Joystick RIGHT P0[16] | Joystick CENTER P0[17]
 	GPIO_IntCmd(0, 1 << 4 | 1 << 15 | 1 << 16 | 1 << 17, 0);
@@ -791,23 +687,20 @@ int main(void)
 	// Enable GPIO Interrupts
 	NVIC_EnableIRQ(EINT3_IRQn);
 
-	// create mutex semaphore -- has to give the semaphore back after it is taken for it to be used elsewhere
-	//SPISemaphore = xSemaphoreCreateMutex();
-	SPISemaphore = xSemaphoreCreateRecursiveMutex();
+	// Init the display server, which shares the SPI with the 7 segment display through the SPI driver
+	Display_Init();
 
 	//(queue length ie, how many items you can send to the queue before xQueueSend gives a FALSE return, size of one item)
 	joystickToRoutingQueueHandle = xQueueCreate(20, sizeof(int));  // create a queue handle to send items to the queue
 
 	struct motorInstruction ref;
-	routingToMotorQueueHandle = xQueueCreate(4, sizeof(ref));
+	routingToMotorQueueHandle = xQueueCreate(GRIDPLANNER_MAX_STEPS, sizeof(ref));
 
-	// Create a software timer
-	SoftwareTimer = xTimerCreate((const int8_t*)"TIMER",   // Just a text name to associate with the timer, useful for debugging, but not used by the kernel.
-				 SOFTWARE_TIMER_PERIOD_MS, // The period of the timer.
-				 pdTRUE,                   // This timer will autoreload, so uxAutoReload is set to pdTRUE.
-				 NULL,                     // The timer ID is not used, so can be set to NULL.
-				 SoftwareTimerCallback);   // The callback function executed each time the timer expires.
-	xTimerStart(SoftwareTimer, portMAX_DELAY);
+	// Both start taken: there is nothing to route or drive yet
+	vSemaphoreCreateBinary(routingWakeSemaphore);
+	xSemaphoreTake(routingWakeSemaphore, 0);
+	vSemaphoreCreateBinary(motorWakeSemaphore);
+	xSemaphoreTake(motorWakeSemaphore, 0);
 
 	// Create the Seven Segment task
 	xTaskCreate(SevenSegmentTask,               // The task that uses the SPI peripheral and seven segment display.
@@ -825,6 +718,10 @@ int main(void)
 	xTaskCreate(OLEDTask4, 			(const int8_t* const)"OLED4", 		configMINIMAL_STACK_SIZE*2, NULL, 0U, NULL);
 	xTaskCreate(OLEDTask5, 			(const int8_t* const)"OLED5", 		configMINIMAL_STACK_SIZE*2, NULL, 4U, NULL);
 	xTaskCreate(TuneTask,  			(const int8_t* const)"TUNE",  		configMINIMAL_STACK_SIZE*2, NULL, 6U, NULL);
+	xTaskCreate(WavPlayer_Task,		(const int8_t* const)"AUDIO", 		configMINIMAL_STACK_SIZE*2, NULL, 1U, NULL);
+	xTaskCreate(DiagnosticTask,		(const int8_t* const)"DIAG", 		configMINIMAL_STACK_SIZE*2, NULL, 0U, NULL);
+	xTaskCreate(Amplifier_Task,		(const int8_t* const)"AMP", 		configMINIMAL_STACK_SIZE, NULL, 0U, NULL);
+	xTaskCreate(Display_Task,		(const int8_t* const)"DISPLAY", 	configMINIMAL_STACK_SIZE*2, NULL, 5U, NULL);
 
 	// Create the tasks we made
 	//xTaskCreate(JoystickTask,  		(const int8_t* const)"JoyStick",  			configMINIMAL_STACK_SIZE*2, NULL, 0U, NULL);
@@ -834,17 +731,9 @@ int main(void)
 	// Initial state of the system
 	currentState = JOYSTICK;
 
-	// Create the songs
-	//struct song s1;
-	//s1.sample	= WavPlayer_Sample;
-	//s1.sampleLength = WavPlayer_SampleLength;
-
-	struct song s2;
-	s2.sample 	= cantinaBandSample;
-	s2.sampleLength = cantinaBandSampleLength;
 	// Add the songs to the playlist
-	playList[0] = s2;
-	//playList[1] = s2;
+	//Playlist_EnqueueWav(WavPlayer_Sample, WavPlayer_SampleLength);
+	Playlist_EnqueueWav(cantinaBandSample, cantinaBandSampleLength);
 
 	// Start the FreeRTOS scheduler.
 	vTaskStartScheduler();
@@ -867,6 +756,10 @@ void EINT3_IRQHandler (void)
 	int inc = 0;
 
 	char Buffy[17];
+	char *Next;
+	portBASE_TYPE HigherPriorityTaskWoken = pdFALSE;
+	ISRPROFILE_ENTER();
+	INPUTTRACE_RECORD();
 
 	// Initialise them all to NONE. If NONE isn't a movement type, the array will be initialised to all LEFT movements
 	//enum movements joystickCommands[20] = {NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE,NONE};
@@ -913,11 +806,12 @@ void EINT3_IRQHandler (void)
 			DFR_ClearWheelCounts();
 			motorInstructionIndex++;
 
-			if(motorInstructionIndex == 4){
+			if(motorInstructionIndex == motorInstructionCount){
 				DFR_DriveStop();
 				currentState = JOYSTICK;
 			}else{
 				currentState = MOTOR;
+				xSemaphoreGiveFromISR(motorWakeSemaphore, &HigherPriorityTaskWoken);
 			}
 		}
 	}
@@ -926,44 +820,52 @@ void EINT3_IRQHandler (void)
 
 		// Joystick Up
 		if ((((LPC_GPIOINT->IO2IntStatR) >> 3)& 0x1) == ENABLE){
-			xQueueSend(joystickToRoutingQueueHandle, &fd, 1000);
+			xQueueSendToBackFromISR(joystickToRoutingQueueHandle, &fd, &HigherPriorityTaskWoken);
 
 		// Joystick Down
 		}else if ((((LPC_GPIOINT->IO0IntStatR) >> 15)& 0x1) == ENABLE){
-			xQueueSend(joystickToRoutingQueueHandle, &bd, 1000);
+			xQueueSendToBackFromISR(joystickToRoutingQueueHandle, &bd, &HigherPriorityTaskWoken);
 
 		// Joystick Left
 		}else if ((((LPC_GPIOINT->IO2IntStatR) >> 4)& 0x1) == ENABLE){
-			xQueueSend(joystickToRoutingQueueHandle, &lt, 1000);
+			xQueueSendToBackFromISR(joystickToRoutingQueueHandle, &lt, &HigherPriorityTaskWoken);
 
 		// Joystick Right
 		}else if ((((LPC_GPIOINT->IO0IntStatR) >> 16)& 0x1) == ENABLE){
-			xQueueSend(joystickToRoutingQueueHandle, &rt, 1000);
+			xQueueSendToBackFromISR(joystickToRoutingQueueHandle, &rt, &HigherPriorityTaskWoken);
 
 		// Joystick Center
 		}else if ((((LPC_GPIOINT->IO0IntStatR) >> 17)& 0x1) == ENABLE){
 			// Loop through all the queued movements
+			ROUTELATENCY_MARK(ROUTELATENCY_PRESS);
 			currentState = ROUTING;
+			xSemaphoreGiveFromISR(routingWakeSemaphore, &HigherPriorityTaskWoken);
 		}
 
 	}
-	uint8_t k;
-	for(k = 0; k < 17; k++){
-		Buffy[k] = ' ';
-	}
-	sprintf(Buffy, "X: %d Y: %d      ", (int)gridLocation[0], gridLocation[1]);
-	PutStringOLED((uint8_t*)Buffy, 5);
+	// Fixed width fields keep the digits still, so only the ones that change are redrawn
+	Next = Fmt_Text(Buffy, "X: ", 0);
+	Next = Fmt_Signed(Next, gridLocation[0], 4);
+	Next = Fmt_Text(Next, "  Y: ", 0);
+	Next = Fmt_Signed(Next, gridLocation[1], 4);
+	*Next = '\0';
+	Display_PutLineFromISR(5, Buffy);
 	//for(k = 0; k < 17; k++){
 	//	Buffy[k] = ' ';
 	//}
 
 	// Left button
 	if ((((LPC_GPIOINT->IO0IntStatR) >> 4)& 0x1) == ENABLE){
-		togglePauseSong();
-		if(getIsPaused() == 1){
-			PutStringOLED((uint8_t*)" Tune: Paused   ", 4);
-		}else{
-			PutStringOLED((uint8_t*)" Tune: Playing  ", 4);
+		if (((GPIO_ReadValue(1) >> 31) & 0x01) == 0) {
+			// Right button held as well: start the playlist
+			Playlist_RequestStartFromISR();
+		} else {
+			togglePauseSong();
+			if(getIsPaused() == 1){
+				Display_PutLineFromISR(4, " Tune: Paused   ");
+			}else{
+				Display_PutLineFromISR(4, " Tune: Playing  ");
+			}
 		}
 	}
 
@@ -974,8 +876,32 @@ void EINT3_IRQHandler (void)
     // Port 2
     // Joystick UP | Encoder(Left) | Encoder(Right) | Joystick LEFT
     GPIO_ClearInt(2,1 << 3 | 1 << 11 | 1 << 12 | 1 << 4 );
+
+    ISRPROFILE_EXIT(ISRPROFILE_EINT3);
+    portEND_SWITCHING_ISR(HigherPriorityTaskWoken);
 }
 
+// The GPDMA has one interrupt for all its channels: the DAC on channel 0, the SPI on 1 and 2
+void DMA_IRQHandler(void)
+{
+	ISRPROFILE_ENTER();
+#ifdef WAVPLAYER_USE_DMA
+	WavPlayer_DMAHandler();
+#endif
+	Spi_DMAHandler();
+	ISRPROFILE_EXIT(ISRPROFILE_DMA);
+}
+
+
+/******************************************************************************
+ * Description:	Measures idle time for DiagnosticTask. Needs
+ *				configUSE_IDLE_HOOK set to 1 in FreeRTOSConfig.h, and must
+ *				not block.
+ *****************************************************************************/
+void vApplicationIdleHook(void)
+{
+	IsrProfile_Idle();
+}
 
 /******************************************************************************
  * Error Checking Routines
@@ -28,6 +28,7 @@
 #include "stdio.h"
 #include "LPC17xx.h"
 #include "LPC17xx_GPIO.h"
+#include "LPC17xx_GPDMA.h"
 
 /******************************************************************************
  * Defines and typedefs
@@ -45,6 +46,7 @@
 #include "joystick.h"
 #include "OLED.h"
 #include "WavPlayer.h"
+#include "Amplifier.h"
 
 extern const uint8_t cantinaBandSample[];
 extern const uint32_t cantinaBandSampleLength;
@@ -731,7 +733,8 @@ int main(void)
 	OLED_Init(SPIPort);
 	OLED_ClearScreen(OLED_COLOR_WHITE);
 
-	// Init wav player
+	// Init the GPDMA, which feeds the DAC, then the wav player
+	GPDMA_Init();
 	WavPlayer_Init();
 
 	// Joystick Init
@@ -758,6 +761,10 @@ int main(void)
 				 SoftwareTimerCallback);   // The callback function executed each time the timer expires.
 	xTimerStart(SoftwareTimer, portMAX_DELAY);
 
+	// Create the audio task, which decodes ahead of the DAC, and the amplifier task; without them nothing plays
+	xTaskCreate(WavPlayer_Task,		(const int8_t* const)"AUDIO", 		configMINIMAL_STACK_SIZE*2, NULL, 1U, NULL);
+	xTaskCreate(Amplifier_Task,		(const int8_t* const)"AMP", 		configMINIMAL_STACK_SIZE, NULL, 0U, NULL);
+
 	// Create the Seven Segment task
 	xTaskCreate(SevenSegmentTask,               // The task that uses the SPI peripheral and seven segment display.
 		(const int8_t* const)"7SEG",    // Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself.
@@ -848,6 +855,14 @@ void EINT3_IRQHandler (void)
 }
 
 
+// The GPDMA has one interrupt for all its channels; only the DAC uses it here
+void DMA_IRQHandler(void)
+{
+#ifdef WAVPLAYER_USE_DMA
+	WavPlayer_DMAHandler();
+#endif
+}
+
 /******************************************************************************
  * Error Checking Routines
  *****************************************************************************/
@@ -0,0 +1,456 @@
+/**************************************************************************//**
+ *
+ * @file		Sim.c
+ * @brief		Host simulation: simulated time, interrupts and the entry point
+ * @version		1.0
+ *
+ * Usage:	firmware-sim [-t seconds] [-o directory] [-i script | -p trace]
+ *						[-r trace] [-s ms] [-v]
+ *
+ * The firmware's main is built as App_Main. This main sets up the board
+ * models, creates the SIM task and hands over to App_Main, which creates the
+ * firmware's tasks and starts the scheduler as it would on the board.
+ *
+ * The SIM task runs at the highest priority and plays the part of the
+ * interrupt controller. Once per tick it advances simulated time and steps
+ * the timers, the scripted or replayed inputs and the DAC's DMA; whatever they raise is
+ * delivered by calling the firmware's handler directly. While it runs no
+ * other task can, and a task inside a critical section holds off the tick,
+ * so handlers see the same exclusion they would on the board. Interrupts
+ * raised by a task (an SPI transfer it has just started) wake the SIM task,
+ * which runs as soon as that task blocks.
+ *
+ * Handlers run in order of interrupt number rather than NVIC priority, and
+ * one handler cannot interrupt another.
+ *
+ * At the end the OLED is saved as oled.pbm and oled.txt, the DAC output is
+ * in dac.wav, events are in sim.log, and a summary goes to stdout. With -r
+ * the firmware's own input trace is saved too, ready to replay with -p.
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Task.h"
+#include "FreeRTOS_Semaphore.h"
+
+#include "Sim.h"
+#include "IsrProfile.h"
+#include "Display.h"
+#include "Spi.h"
+#include "RouteLatency.h"
+#include "WavPlayer.h"
+
+// The firmware's main is renamed App_Main on the command line; this is the real one
+#undef main
+int App_Main(void);
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIM_DEFAULT_SECONDS		60
+#define SIM_MAX_ROUNDS			10000		// Handler runs in one delivery before giving up on a stuck source
+#define SIM_PATH_LENGTH			512
+
+typedef void (*Sim_Handler_t)(void);
+
+//------------------------------------------------------------------------------
+
+// Local variables
+void TIMER0_IRQHandler(void) __attribute__((weak));
+void TIMER1_IRQHandler(void) __attribute__((weak));
+void TIMER2_IRQHandler(void) __attribute__((weak));
+void TIMER3_IRQHandler(void) __attribute__((weak));
+void EINT3_IRQHandler(void) __attribute__((weak));
+void DMA_IRQHandler(void) __attribute__((weak));
+
+// Figures main.c's DiagnosticTask leaves behind, if this firmware has them
+extern IsrProfile_Report_t IsrLoad __attribute__((weak));
+extern Display_Stats_t DisplayLoad __attribute__((weak));
+extern Spi_Report_t SpiLoad __attribute__((weak));
+
+static Sim_Options_t Options = {SIM_DEFAULT_SECONDS, ".", 0, 0, 0, 0, 0};
+static xTaskHandle SimTask = 0;
+static xSemaphoreHandle Wake = 0;
+static uint32_t Enabled = 0;				// NVIC enable bits
+static uint32_t Pending = 0;				// NVIC pending bits
+static uint8_t Delivering = 0;				// A handler is running
+static uint64_t Micros = 0;					// Simulated time at the start of the current tick
+static uint64_t PclkNow = 0;				// Finer position within the tick, in peripheral clocks
+static uint64_t NextSnapshot = 0;
+static FILE *Log = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static Sim_Handler_t Sim_Handler(uint8_t IRQn)
+{
+	switch (IRQn)
+	{
+		case TIMER0_IRQn:	return TIMER0_IRQHandler;
+		case TIMER1_IRQn:	return TIMER1_IRQHandler;
+		case TIMER2_IRQn:	return TIMER2_IRQHandler;
+		case TIMER3_IRQn:	return TIMER3_IRQHandler;
+		case EINT3_IRQn:	return EINT3_IRQHandler;
+		case DMA_IRQn:		return DMA_IRQHandler;
+		default:			return 0;
+	}
+}
+
+// Run every pending, enabled handler until nothing is left, including the
+// completion of any SPI transfer the handlers start
+static void Sim_Deliver(void)
+{
+	Sim_Handler_t Handler;
+	uint32_t Ready;
+	uint32_t Rounds;
+	uint8_t Busy;
+	uint8_t IRQn;
+
+	Delivering = 1;
+	for (Rounds = 0; Rounds < SIM_MAX_ROUNDS; ++Rounds)
+	{
+		Busy = SimDma_Complete();
+		Ready = Pending & Enabled;
+		if ((Busy == 0) && (Ready == 0))
+			break;
+
+		for (IRQn = 0; Ready != 0; ++IRQn)
+		{
+			if ((Ready & (1UL << IRQn)) == 0)
+				continue;
+			Ready &= ~(1UL << IRQn);
+			Pending &= ~(1UL << IRQn);
+			Handler = Sim_Handler(IRQn);
+			if (Handler != 0)
+				Handler();
+		}
+	}
+	Delivering = 0;
+
+	if (Rounds == SIM_MAX_ROUNDS)
+		Sim_Log("interrupts still pending after %u handler runs", SIM_MAX_ROUNDS);
+}
+
+static void Sim_Report(FILE *Out)
+{
+	RouteLatency_Report_t Route;
+	Display_Stats_t Display;
+	Spi_Report_t Spi;
+	Spi_ClientStats_t *Client;
+	uint32_t Count;
+	double Output;
+	uint8_t i;
+
+	fprintf(Out, "Simulated %.3f s\n", (double)Micros / 1e6);
+	SimOled_Report(Out);
+	SimBoard_Report(Out);
+	SimDma_Report(Out);
+	SimAudio_Report(Out);
+	SimTrace_Report(Out);
+
+	// Over the whole run, against the time the DAC was actually playing: the
+	// DMA path interrupts once per half buffer, the Timer0 path once per sample
+	Count = WavPlayer_GetInterruptCount();
+	Output = SimAudio_Seconds();
+	fprintf(Out, "Audio %u interrupts, %.1f per second of output\n", (unsigned)Count, (Output > 0) ? (double)Count / Output : 0.0);
+
+	// The last one second window the firmware measured
+	if (&IsrLoad != 0)
+	{
+		for (i = 0; i < ISRPROFILE_SOURCES; ++i)
+			fprintf(Out, "ISR %-6s %5u runs, %u.%u%% load\n", IsrProfile_Name(i), (unsigned)IsrLoad.Stats[i].Count, IsrLoad.Load[i] / 10, IsrLoad.Load[i] % 10);
+		fprintf(Out, "ISR total %u.%u%% load, idle %u.%u%%\n", IsrLoad.TotalLoad / 10, IsrLoad.TotalLoad % 10, IsrLoad.IdleLoad / 10, IsrLoad.IdleLoad % 10);
+	}
+	if (&DisplayLoad != 0)
+	{
+		fprintf(Out, "Display %u drawn, %u dropped, %u late, latency max %u us, %u SPI bytes\n", (unsigned)DisplayLoad.Drawn,
+			(unsigned)DisplayLoad.Dropped, (unsigned)DisplayLoad.Late, (unsigned)DisplayLoad.LatencyMax, (unsigned)DisplayLoad.Bytes);
+	}
+	// The whole run, taken now: the firmware's own figures start again every second
+	Display_Totals(&Display);
+	fprintf(Out, "Display run %u drawn, %u dropped, %u flushes, %u SPI bytes in %u transactions, %u bytes saved\n", (unsigned)Display.Drawn,
+		(unsigned)Display.Dropped, (unsigned)Display.Flushes, (unsigned)Display.Bytes, (unsigned)Display.Transactions, (unsigned)Display.BytesSaved);
+	fprintf(Out, "Display run %u cells drawn, %u cells skipped\n", (unsigned)Display.CellsDrawn, (unsigned)Display.CellsSkipped);
+	if (&SpiLoad != 0)
+		fprintf(Out, "SPI %u transactions, %u bytes, %u.%u%% busy\n", (unsigned)SpiLoad.Transactions, (unsigned)SpiLoad.Bytes, SpiLoad.Load / 10, SpiLoad.Load % 10);
+
+	// Each client over the whole run: the 7 segment digit is due within 10 ms of every 1200 ms tick
+	Spi_Totals(&Spi);
+	for (i = 0; i < Spi.ClientCount; ++i)
+	{
+		Client = &Spi.Clients[i];
+		fprintf(Out, "SPI run %-5s %5u transactions, %6u bytes, wait max %u us, mean %u us, %u missed, %u over rate\n",
+			Spi_ClientName(i), (unsigned)Client->Transactions, (unsigned)Client->Bytes, (unsigned)Client->WaitMax,
+			(Client->Transactions != 0) ? (unsigned)(Client->WaitTotal / Client->Transactions) : 0U, (unsigned)Client->Missed,
+			(unsigned)Client->OverRate);
+	}
+
+	// Not windowed, so taken now rather than from the firmware's last report
+	RouteLatency_Report(&Route);
+	fprintf(Out, "Route %u presses, %u without a route, %u unfinished\n", (unsigned)Route.Stats[ROUTELATENCY_PRESS].Count,
+		(unsigned)Route.NoRoute, (unsigned)Route.Unfinished);
+	for (i = ROUTELATENCY_PRESS + 1; i < ROUTELATENCY_STAGES; ++i)
+	{
+		fprintf(Out, "Route %-7s %4u runs, p50 %u us, p99 %u us, max %u us\n", RouteLatency_Name(i), (unsigned)Route.Stats[i].Count,
+			(unsigned)Route.Stats[i].P50, (unsigned)Route.Stats[i].P99, (unsigned)Route.Stats[i].Max);
+	}
+}
+
+static void Sim_Finish(void)
+{
+	SimOled_Save("oled");
+	SimAudio_Close();
+	if ((Options.Record != 0) && !SimTrace_Save(Options.Record))
+		fprintf(stderr, "Cannot write %s in %s\n", Options.Record, Options.Directory);
+	Sim_Report(stdout);
+	if (Log != 0)
+	{
+		Sim_Report(Log);
+		fclose(Log);
+	}
+	fflush(stdout);
+	exit(0);
+}
+
+// One tick of simulated time
+static void Sim_Step(void)
+{
+	uint64_t TickStart = Micros * (SIM_PCLK_HZ / 1000000UL);
+	uint32_t Cycles;
+	char Name[32];
+
+	Micros += SIM_TICK_US;
+
+	// Nothing in the simulation costs CPU time, but the cycle counter still has to keep up with the clock
+	Cycles = (uint32_t)(Micros * (SIM_CCLK_HZ / 1000000UL));
+	if ((int32_t)(Cycles - IsrProfile_HostCycles) > 0)
+		IsrProfile_HostAdvance(Cycles - IsrProfile_HostCycles);
+
+	// Timers first, so TIMER2 is at this tick when the inputs are traced or replayed
+	SimBoard_Step(TickStart);
+	SimGpio_Step(Micros);
+	SimTrace_Step(Micros);
+	SimDma_Step(TickStart);
+	PclkNow = TickStart + SIM_TICK_PCLK;
+
+	if ((Options.SnapshotMs != 0) && (Micros >= NextSnapshot))
+	{
+		snprintf(Name, sizeof(Name), "oled-%06u", (unsigned)(Micros / 1000));
+		SimOled_Save(Name);
+		NextSnapshot += (uint64_t)Options.SnapshotMs * 1000;
+	}
+
+	if (Micros >= ((uint64_t)Options.Seconds * 1000000))
+		Sim_Finish();
+}
+
+/******************************************************************************
+ * Description:	Stands in for the interrupt controller. Advances simulated
+ *				time once per tick and delivers whatever interrupts the
+ *				board models raise; also woken early by tasks that start an
+ *				SPI transfer.
+ *****************************************************************************/
+static void Sim_Task(void *pvParameters)
+{
+	portTickType Stepped;
+
+	(void)pvParameters;
+	Stepped = xTaskGetTickCount();
+
+	for(;;)
+	{
+		xSemaphoreTake(Wake, 1);
+
+		while (Stepped != xTaskGetTickCount())
+		{
+			++Stepped;
+			Sim_Step();
+		}
+		Sim_Deliver();
+	}
+}
+
+static void Sim_Usage(const char *Name)
+{
+	fprintf(stderr, "Usage: %s [-t seconds] [-o directory] [-i script | -p trace] [-r trace] [-s ms] [-v]\n", Name);
+	exit(2);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Simulated time at the start of the current tick
+uint64_t Sim_Micros(void)
+{
+	return Micros;
+}
+
+// Simulated time in peripheral clocks, as finely as the model being stepped knows it
+uint64_t Sim_Pclk(void)
+{
+	return PclkNow;
+}
+
+void Sim_SetPclk(uint64_t Pclk)
+{
+	PclkNow = Pclk;
+}
+
+// Called by the lockstep kernel while every task is blocked, for each pass of
+// the idle loop: the cycle counter moves on towards the next tick, where the
+// SIM task would otherwise jump it
+uint8_t SimKernel_IdleStep(void)
+{
+	uint32_t Tick = (uint32_t)((Micros + SIM_TICK_US) * (SIM_CCLK_HZ / 1000000UL));
+	int32_t Left = (int32_t)(Tick - IsrProfile_HostCycles);
+
+	if (Left <= 0)
+		return 0;
+	IsrProfile_HostAdvance((Left < SIM_IDLE_LOOP) ? (uint32_t)Left : SIM_IDLE_LOOP);
+	return 1;
+}
+
+// Make an interrupt pending. From a handler or a board model it is delivered
+// before the SIM task moves on; from a task, once that task blocks.
+void Sim_Raise(IRQn_Type IRQn)
+{
+	Pending |= (1UL << IRQn);
+
+	if (xTaskGetCurrentTaskHandle() != SimTask)
+		Sim_Wake();
+	else if (Delivering == 0)
+		Sim_Deliver();
+}
+
+// Have the SIM task look for work as soon as the calling task blocks
+void Sim_Wake(void)
+{
+	portBASE_TYPE HigherPriorityTaskWoken = pdFALSE;
+
+	// May be called inside a critical section, so never switch from here
+	if ((Wake != 0) && (xTaskGetCurrentTaskHandle() != SimTask))
+		xSemaphoreGiveFromISR(Wake, &HigherPriorityTaskWoken);
+	(void)HigherPriorityTaskWoken;
+}
+
+// Add a line to sim.log, stamped with the simulated time
+void Sim_Log(const char *Format, ...)
+{
+	va_list Arguments;
+
+	if (Log != 0)
+	{
+		fprintf(Log, "%10.3f ", (double)Micros / 1e6);
+		va_start(Arguments, Format);
+		vfprintf(Log, Format, Arguments);
+		va_end(Arguments);
+		fputc('\n', Log);
+	}
+
+	if (Options.Verbose)
+	{
+		printf("%10.3f ", (double)Micros / 1e6);
+		va_start(Arguments, Format);
+		vprintf(Format, Arguments);
+		va_end(Arguments);
+		putchar('\n');
+	}
+}
+
+// Open Name in the output directory
+FILE* Sim_Create(const char *Name, const char *Mode)
+{
+	char Path[SIM_PATH_LENGTH];
+
+	snprintf(Path, sizeof(Path), "%s/%s", Options.Directory, Name);
+	return fopen(Path, Mode);
+}
+
+void NVIC_SetPriorityGrouping(uint32_t PriorityGroup)
+{
+	(void)PriorityGroup;
+}
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t Priority)
+{
+	(void)IRQn;
+	(void)Priority;
+}
+
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+	Enabled |= (1UL << IRQn);
+	if (Pending & (1UL << IRQn))
+		Sim_Wake();
+}
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+	Enabled &= ~(1UL << IRQn);
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+	Sim_Raise(IRQn);
+}
+
+int main(int argc, char *argv[])
+{
+	int Option;
+
+	while ((Option = getopt(argc, argv, "t:o:i:p:r:s:v")) != -1)
+	{
+		switch (Option)
+		{
+			case 't':	Options.Seconds = (uint32_t)strtoul(optarg, 0, 10);		break;
+			case 'o':	Options.Directory = optarg;								break;
+			case 'i':	Options.Script = optarg;								break;
+			case 'p':	Options.Replay = optarg;								break;
+			case 'r':	Options.Record = optarg;								break;
+			case 's':	Options.SnapshotMs = (uint32_t)strtoul(optarg, 0, 10);	break;
+			case 'v':	Options.Verbose = 1;									break;
+			default:	Sim_Usage(argv[0]);
+		}
+	}
+	if ((optind != argc) || (Options.Seconds == 0) || ((Options.Script != 0) && (Options.Replay != 0)))
+		Sim_Usage(argv[0]);
+
+	Log = Sim_Create("sim.log", "w");
+	if (Log == 0)
+	{
+		fprintf(stderr, "Cannot write to %s\n", Options.Directory);
+		return 1;
+	}
+
+	SimGpio_Init();
+	if ((Options.Script != 0) && !SimGpio_Load(Options.Script))
+	{
+		fprintf(stderr, "Cannot read the script %s\n", Options.Script);
+		return 1;
+	}
+	if ((Options.Replay != 0) && !SimTrace_Load(Options.Replay))
+	{
+		fprintf(stderr, "Cannot read the trace %s\n", Options.Replay);
+		return 1;
+	}
+	if (!SimAudio_Open("dac.wav"))
+	{
+		fprintf(stderr, "Cannot write dac.wav in %s\n", Options.Directory);
+		return 1;
+	}
+	NextSnapshot = (uint64_t)Options.SnapshotMs * 1000;
+
+	vSemaphoreCreateBinary(Wake);
+	xSemaphoreTake(Wake, 0);
+	xTaskCreate(Sim_Task, (const int8_t* const)"SIM", configMINIMAL_STACK_SIZE*2, NULL, configMAX_PRIORITIES - 1, &SimTask);
+
+	return App_Main();
+}
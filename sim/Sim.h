@@ -0,0 +1,106 @@
+/**************************************************************************//**
+ *
+ * @file		Sim.h
+ * @brief		Header file shared by the parts of the host simulation
+ * @version		1.0
+ *
+ * The firmware runs unchanged on the FreeRTOS POSIX port, with the board's
+ * driver library and peripherals replaced by the models in this directory.
+ * Sim.c owns simulated time and stands in for the NVIC; the others model
+ * one part of the board each and are stepped by it once per tick.
+ *
+******************************************************************************/
+
+#ifndef SIM_H
+#define SIM_H
+
+// Includes
+#include <stdio.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIM_CCLK_HZ				configCPU_CLOCK_HZ
+#define SIM_PCLK_HZ				(SIM_CCLK_HZ / 4)				// Every peripheral clock, as after reset
+#define SIM_TICK_US				(1000000UL / configTICK_RATE_HZ)
+#define SIM_TICK_PCLK			(SIM_PCLK_HZ / configTICK_RATE_HZ)
+#define SIM_SPI_HZ				4000000UL						// SSP1 bit rate, for the time a transfer keeps the bus busy
+#define SIM_IDLE_LOOP			64								// Cycles for one pass of the idle task's loop, hook included
+
+#define SIM_OLED_CS_PORT		0								// Same pins as Framebuffer.c's device
+#define SIM_OLED_CS_PIN			(1 << 6)
+#define SIM_OLED_DC_PORT		2
+#define SIM_OLED_DC_PIN			(1 << 7)
+#define SIM_7SEG_CS_PORT		2
+#define SIM_7SEG_CS_PIN			(1 << 2)
+
+#define SIM_ENCODER_PORT		2
+#define SIM_ENCODER_LEFT		(1 << 11)
+#define SIM_ENCODER_RIGHT		(1 << 12)
+#define SIM_ENCODER_US			20000							// Between encoder slots while the wheels turn
+
+typedef struct {
+	uint32_t Seconds;			// How long to run
+	const char *Directory;		// Where the output files go
+	const char *Script;			// Input script, 0 for none
+	uint32_t SnapshotMs;		// Save the OLED this often, 0 for only the last frame
+	uint8_t Verbose;			// Copy the log to stdout
+	const char *Record;			// Save the firmware's input trace here, 0 for not
+	const char *Replay;			// Input trace to replay, 0 for none
+} Sim_Options_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Sim.c
+uint64_t Sim_Micros(void);
+uint64_t Sim_Pclk(void);
+void Sim_SetPclk(uint64_t Pclk);
+void Sim_Raise(IRQn_Type IRQn);
+void Sim_Wake(void);
+void Sim_Log(const char *Format, ...);
+FILE* Sim_Create(const char *Name, const char *Mode);
+
+// SimGpio.c
+void SimGpio_Init(void);
+void SimGpio_Drive(uint8_t Port, uint32_t Pins, uint8_t High);
+uint8_t SimGpio_Edge(uint8_t Port, uint32_t Pins);
+uint8_t SimGpio_Load(const char *Path);
+void SimGpio_Step(uint64_t Micros);
+
+// SimBoard.c
+void SimBoard_Step(uint64_t TickStart);
+void SimBoard_Encoders(uint8_t Enable);
+void SimBoard_SevenSegment(uint8_t Segments);
+void SimBoard_Report(FILE *Out);
+
+// SimDma.c
+void SimDma_Shift(const uint8_t *Bytes, uint32_t Length);
+uint8_t SimDma_Complete(void);
+void SimDma_Step(uint64_t TickStart);
+void SimDma_Report(FILE *Out);
+
+// SimOled.c
+void SimOled_Write(uint8_t Byte, uint8_t Data);
+uint8_t SimOled_Save(const char *Name);
+void SimOled_Report(FILE *Out);
+
+// SimAudio.c
+uint8_t SimAudio_Open(const char *Name);
+void SimAudio_Sample(uint32_t Value);
+void SimAudio_Close(void);
+double SimAudio_Seconds(void);
+void SimAudio_Report(FILE *Out);
+
+// SimTrace.c
+uint8_t SimTrace_Load(const char *Path);
+void SimTrace_Step(uint64_t Micros);
+uint8_t SimTrace_Save(const char *Name);
+void SimTrace_Report(FILE *Out);
+
+#endif // SIM_H
@@ -0,0 +1,139 @@
+/**************************************************************************//**
+ *
+ * @file		SimAudio.c
+ * @brief		Host simulation: record the DAC as a WAV file
+ * @version		1.0
+ *
+ * Every value written to the DAC becomes one 16-bit mono sample, centred on
+ * the DAC's mid-scale. The firmware paces its output against the peripheral
+ * clock, so the rate in the header is measured from the time between
+ * samples rather than assumed. Only the time while the output runs counts:
+ * a gap longer than SIMAUDIO_GAP means the DMA channel or timer stopped
+ * between sounds, and the silence is left out of the file as well as the
+ * rate. A run that plays at more than one rate is recorded at their average.
+ *
+******************************************************************************/
+
+// Includes
+#include <string.h>
+
+#include "Sim.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIMAUDIO_HEADER			44
+#define SIMAUDIO_MIDSCALE		512			// The DAC is 10 bits
+#define SIMAUDIO_GAIN			64			// 10 bits to 16
+#define SIMAUDIO_GAP			(SIM_PCLK_HZ / 1000)	// Longer between samples than any rate the DAC is paced at
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static FILE *Wav = 0;
+static uint32_t Count = 0;
+static uint32_t Runs = 0;					// Stretches of output with no gap
+static uint64_t Running = 0;				// Peripheral clocks between samples within a run
+static uint64_t Last = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static void SimAudio_Put16(uint8_t *Out, uint16_t Value)
+{
+	Out[0] = (uint8_t)Value;
+	Out[1] = (uint8_t)(Value >> 8);
+}
+
+static void SimAudio_Put32(uint8_t *Out, uint32_t Value)
+{
+	SimAudio_Put16(Out, (uint16_t)Value);
+	SimAudio_Put16(Out + 2, (uint16_t)(Value >> 16));
+}
+
+// Each run of N samples spans N - 1 sample periods
+static uint32_t SimAudio_Rate(void)
+{
+	if (Running == 0)
+		return 8000;
+	return (uint32_t)(((uint64_t)(Count - Runs) * SIM_PCLK_HZ + (Running / 2)) / Running);
+}
+
+static void SimAudio_Header(void)
+{
+	uint8_t Header[SIMAUDIO_HEADER];
+	uint32_t Rate = SimAudio_Rate();
+	uint32_t Bytes = Count * 2;
+
+	memcpy(Header, "RIFF", 4);
+	SimAudio_Put32(Header + 4, 36 + Bytes);
+	memcpy(Header + 8, "WAVEfmt ", 8);
+	SimAudio_Put32(Header + 16, 16);
+	SimAudio_Put16(Header + 20, 1);					// PCM
+	SimAudio_Put16(Header + 22, 1);					// Mono
+	SimAudio_Put32(Header + 24, Rate);
+	SimAudio_Put32(Header + 28, Rate * 2);
+	SimAudio_Put16(Header + 32, 2);
+	SimAudio_Put16(Header + 34, 16);
+	memcpy(Header + 36, "data", 4);
+	SimAudio_Put32(Header + 40, Bytes);
+
+	fseek(Wav, 0, SEEK_SET);
+	fwrite(Header, 1, sizeof(Header), Wav);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+uint8_t SimAudio_Open(const char *Name)
+{
+	Wav = Sim_Create(Name, "wb");
+	if (Wav == 0)
+		return 0;
+
+	// Written again with the real sizes and rate on close
+	SimAudio_Header();
+	return 1;
+}
+
+// A 10-bit value reaching the DAC output
+void SimAudio_Sample(uint32_t Value)
+{
+	uint8_t Sample[2];
+	uint64_t Now = Sim_Pclk();
+
+	if (Wav == 0)
+		return;
+
+	if ((Count == 0) || (Now - Last > SIMAUDIO_GAP))
+		++Runs;
+	else
+		Running += Now - Last;
+	Last = Now;
+	++Count;
+
+	SimAudio_Put16(Sample, (uint16_t)(int16_t)(((int32_t)(Value & 0x3FF) - SIMAUDIO_MIDSCALE) * SIMAUDIO_GAIN));
+	fwrite(Sample, 1, sizeof(Sample), Wav);
+}
+
+void SimAudio_Close(void)
+{
+	if (Wav == 0)
+		return;
+
+	SimAudio_Header();
+	fclose(Wav);
+	Wav = 0;
+}
+
+// Time the DAC spent playing, gaps between sounds left out
+double SimAudio_Seconds(void)
+{
+	return (double)Count / (double)SimAudio_Rate();
+}
+
+void SimAudio_Report(FILE *Out)
+{
+	fprintf(Out, "DAC %u samples at %u Hz, %.3f s of output in %u runs\n", (unsigned)Count, (unsigned)SimAudio_Rate(), SimAudio_Seconds(),
+		(unsigned)Runs);
+}
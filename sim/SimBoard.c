@@ -0,0 +1,471 @@
+/**************************************************************************//**
+ *
+ * @file		SimBoard.c
+ * @brief		Host simulation: timers, the robot base and the rest of the board
+ * @version		1.0
+ *
+ * The timers count peripheral clocks through their prescaler as the chip's
+ * do, jumping from one match to the next rather than counting one by one. A
+ * match sets IR and the handler runs there and then, so a handler that moves
+ * its match register gets the next match from the new value. Tasks see TC
+ * move at each tick and at each match.
+ *
+ * The robot base stands in for the DFRobot driver: while it is driving, both
+ * wheel encoders pulse every SIM_ENCODER_US, which the firmware counts in
+ * EINT3 as it would on the floor.
+ *
+******************************************************************************/
+
+// Includes
+#include <string.h>
+
+#include "Sim.h"
+#include "LPC17xx_Timer.h"
+#include "LPC17xx_SSP.h"
+#include "LPC17xx_PinSelect.h"
+#include "LPC17xx_ClkPwr.h"
+#include "FreeRTOS_IO.h"
+#include "dfrobot.h"
+#include "joystick.h"
+#include "pca9532.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIMBOARD_TIMERS			4
+#define SIMBOARD_CHANNELS		4
+#define SIMBOARD_NO_MATCH		0x100000000ULL		// Counts to a match register equal to TC: a full lap
+
+#define SIMBOARD_MCR_INT		(1UL << 0)			// MCR has these three bits for each match channel
+#define SIMBOARD_MCR_RESET		(1UL << 1)
+#define SIMBOARD_MCR_STOP		(1UL << 2)
+
+typedef enum {
+	SIMBOARD_STOPPED,
+	SIMBOARD_FORWARD,
+	SIMBOARD_BACKWARD,
+	SIMBOARD_LEFT,
+	SIMBOARD_RIGHT
+} SimBoard_Motion_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+LPC_DAC_TypeDef SimBoard_Dac;
+LPC_TIM_TypeDef SimBoard_Tim[SIMBOARD_TIMERS];
+LPC_GPIOINT_TypeDef SimBoard_GpioInt;
+LPC_SSP_TypeDef SimBoard_Ssp1;
+
+static const IRQn_Type TimerIRQn[SIMBOARD_TIMERS] = {TIMER0_IRQn, TIMER1_IRQn, TIMER2_IRQn, TIMER3_IRQn};
+static const char *const MotionName[] = {"stop", "forward", "backward", "left", "right"};
+
+static uint8_t ResetPending[SIMBOARD_TIMERS];		// A reset on match takes effect on the next count
+static uint32_t Matches[SIMBOARD_TIMERS];
+
+static SimBoard_Motion_t Motion = SIMBOARD_STOPPED;
+static uint8_t Speed = 0;
+static uint8_t Gear = 0;
+static uint32_t LeftCount = 0;
+static uint32_t RightCount = 0;
+static uint32_t LeftDestination = 0;
+static uint32_t RightDestination = 0;
+static uint8_t Encoders = 1;					// Pulse the encoders while driving
+static uint64_t NextEncoder = 0;
+static uint32_t EncoderPulses = 0;
+static uint32_t Drives = 0;
+
+// Where main.c thinks the robot is, if this firmware keeps it there
+extern int gridLocation[2] __attribute__((weak));
+
+static uint8_t SevenSegment = 0xFF;
+static uint32_t SevenSegmentWrites = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static volatile uint32_t* SimBoard_Match(LPC_TIM_TypeDef *Timer, uint8_t Channel)
+{
+	return &Timer->MR0 + Channel;
+}
+
+// Move TC on by Counts timer counts
+static void SimBoard_Count(uint8_t Index, uint64_t Counts)
+{
+	LPC_TIM_TypeDef *Timer = &SimBoard_Tim[Index];
+
+	if (Counts == 0)
+		return;
+
+	if (ResetPending[Index])
+	{
+		Timer->TC = (uint32_t)(Counts - 1);
+		ResetPending[Index] = 0;
+	}
+	else
+	{
+		Timer->TC += (uint32_t)Counts;
+	}
+}
+
+// Counts until the nearest match with anything to do
+static uint64_t SimBoard_Nearest(uint8_t Index)
+{
+	LPC_TIM_TypeDef *Timer = &SimBoard_Tim[Index];
+	uint64_t Nearest = SIMBOARD_NO_MATCH;
+	uint64_t Distance;
+	uint8_t c;
+
+	for (c = 0; c < SIMBOARD_CHANNELS; ++c)
+	{
+		if (((Timer->MCR >> (c * 3)) & 0x7) == 0)
+			continue;
+
+		if (ResetPending[Index])
+			Distance = (uint64_t)*SimBoard_Match(Timer, c) + 1;
+		else
+			Distance = (uint32_t)(*SimBoard_Match(Timer, c) - Timer->TC);
+		if (Distance == 0)
+			Distance = SIMBOARD_NO_MATCH;
+		if (Distance < Nearest)
+			Nearest = Distance;
+	}
+	return Nearest;
+}
+
+// TC has just reached one or more match registers
+static void SimBoard_Matched(uint8_t Index)
+{
+	LPC_TIM_TypeDef *Timer = &SimBoard_Tim[Index];
+	uint32_t Control;
+	uint8_t Raise = 0;
+	uint8_t c;
+
+	for (c = 0; c < SIMBOARD_CHANNELS; ++c)
+	{
+		if (*SimBoard_Match(Timer, c) != Timer->TC)
+			continue;
+
+		Control = (Timer->MCR >> (c * 3)) & 0x7;
+		if (Control & SIMBOARD_MCR_INT)
+		{
+			Timer->IR |= (1UL << c);
+			Raise = 1;
+		}
+		if (Control & SIMBOARD_MCR_RESET)
+			ResetPending[Index] = 1;
+		if (Control & SIMBOARD_MCR_STOP)
+			Timer->TCR = 0;
+	}
+
+	if (Raise)
+	{
+		++Matches[Index];
+		Sim_Raise(TimerIRQn[Index]);
+	}
+}
+
+// Run one timer through the tick starting at TickStart
+static void SimBoard_Timer(uint8_t Index, uint64_t TickStart)
+{
+	LPC_TIM_TypeDef *Timer = &SimBoard_Tim[Index];
+	uint64_t Now = TickStart;
+	uint64_t Budget = SIM_TICK_PCLK;
+	uint64_t Step;
+	uint64_t Counts;
+	uint64_t Nearest;
+	uint64_t Used;
+
+	while ((Timer->TCR & 1) && (Budget != 0))
+	{
+		// PC holds the clocks since the last count
+		Step = (uint64_t)Timer->PR + 1;
+		Counts = (Timer->PC + Budget) / Step;
+		Nearest = SimBoard_Nearest(Index);
+
+		if (Nearest > Counts)
+		{
+			SimBoard_Count(Index, Counts);
+			Timer->PC = (uint32_t)((Timer->PC + Budget) % Step);
+			break;
+		}
+
+		Used = (Nearest * Step) - Timer->PC;
+		Budget -= Used;
+		Now += Used;
+		Timer->PC = 0;
+		SimBoard_Count(Index, Nearest);
+
+		Sim_SetPclk(Now);
+		SimBoard_Matched(Index);
+	}
+}
+
+static void SimBoard_Drive(SimBoard_Motion_t Next, uint8_t NewSpeed)
+{
+	if ((Next != Motion) || (NewSpeed != Speed))
+	{
+		if (gridLocation != 0)
+			Sim_Log("DFR %s at speed %u, gear %u, from (%d, %d)", MotionName[Next], NewSpeed, Gear, gridLocation[0], gridLocation[1]);
+		else
+			Sim_Log("DFR %s at speed %u, gear %u", MotionName[Next], NewSpeed, Gear);
+	}
+
+	if ((Motion == SIMBOARD_STOPPED) && (Next != SIMBOARD_STOPPED))
+	{
+		NextEncoder = Sim_Micros() + SIM_ENCODER_US;
+		++Drives;
+	}
+	Motion = Next;
+	Speed = NewSpeed;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Run the timers and the robot base through the tick starting at TickStart,
+// in peripheral clocks
+void SimBoard_Step(uint64_t TickStart)
+{
+	uint8_t i;
+
+	for (i = 0; i < SIMBOARD_TIMERS; ++i)
+		SimBoard_Timer(i, TickStart);
+
+	while (Encoders && (Motion != SIMBOARD_STOPPED) && (NextEncoder <= Sim_Micros()))
+	{
+		++EncoderPulses;
+		SimGpio_Drive(SIM_ENCODER_PORT, SIM_ENCODER_LEFT | SIM_ENCODER_RIGHT, 0);
+		SimGpio_Drive(SIM_ENCODER_PORT, SIM_ENCODER_LEFT | SIM_ENCODER_RIGHT, 1);
+		NextEncoder += SIM_ENCODER_US;
+	}
+}
+
+// Turn the robot's own encoder pulses off when something else drives the pins
+void SimBoard_Encoders(uint8_t Enable)
+{
+	Encoders = Enable;
+}
+
+// A byte shifted into the seven segment display's register
+void SimBoard_SevenSegment(uint8_t Segments)
+{
+	++SevenSegmentWrites;
+	if (Segments != SevenSegment)
+		Sim_Log("7seg 0x%02X", Segments);
+	SevenSegment = Segments;
+}
+
+void SimBoard_Report(FILE *Out)
+{
+	uint8_t i;
+
+	fprintf(Out, "Robot %s, %u drives, %u encoder pulses, wheels at %u/%u and %u/%u\n", MotionName[Motion],
+		(unsigned)Drives, (unsigned)EncoderPulses, (unsigned)LeftCount, (unsigned)LeftDestination, (unsigned)RightCount, (unsigned)RightDestination);
+	if (gridLocation != 0)
+		fprintf(Out, "Grid location (%d, %d)\n", gridLocation[0], gridLocation[1]);
+	fprintf(Out, "Seven segment 0x%02X after %u writes\n", SevenSegment, (unsigned)SevenSegmentWrites);
+	for (i = 0; i < SIMBOARD_TIMERS; ++i)
+	{
+		if (Matches[i] != 0)
+			fprintf(Out, "TIMER%u %u match interrupts, TC %u\n", i, (unsigned)Matches[i], (unsigned)SimBoard_Tim[i].TC);
+	}
+}
+
+void TIM_Init(LPC_TIM_TypeDef *TIMx, uint8_t TimerCounterMode, void *TIM_ConfigStruct)
+{
+	TIM_TIMERCFG_Type *Config = (TIM_TIMERCFG_Type*)TIM_ConfigStruct;
+	uint8_t Index = (uint8_t)(TIMx - SimBoard_Tim);
+
+	(void)TimerCounterMode;
+	memset((void*)TIMx, 0, sizeof(*TIMx));
+	ResetPending[Index] = 0;
+
+	if (Config->PrescaleOption == TIM_PRESCALE_USVAL)
+		TIMx->PR = ((SIM_PCLK_HZ / 1000000UL) * Config->PrescaleValue) - 1;
+	else
+		TIMx->PR = Config->PrescaleValue - 1;
+}
+
+void TIM_DeInit(LPC_TIM_TypeDef *TIMx)
+{
+	TIMx->TCR = 0;
+}
+
+void TIM_ConfigMatch(LPC_TIM_TypeDef *TIMx, TIM_MATCHCFG_Type *TIM_MatchConfigStruct)
+{
+	uint8_t Channel = TIM_MatchConfigStruct->MatchChannel;
+	uint32_t Control = 0;
+
+	if (TIM_MatchConfigStruct->IntOnMatch)
+		Control |= SIMBOARD_MCR_INT;
+	if (TIM_MatchConfigStruct->ResetOnMatch)
+		Control |= SIMBOARD_MCR_RESET;
+	if (TIM_MatchConfigStruct->StopOnMatch)
+		Control |= SIMBOARD_MCR_STOP;
+
+	*SimBoard_Match(TIMx, Channel) = TIM_MatchConfigStruct->MatchValue;
+	TIMx->MCR = (TIMx->MCR & ~(0x7UL << (Channel * 3))) | (Control << (Channel * 3));
+}
+
+void TIM_UpdateMatchValue(LPC_TIM_TypeDef *TIMx, uint8_t MatchChannel, uint32_t MatchValue)
+{
+	*SimBoard_Match(TIMx, MatchChannel) = MatchValue;
+}
+
+void TIM_ResetCounter(LPC_TIM_TypeDef *TIMx)
+{
+	TIMx->TC = 0;
+	TIMx->PC = 0;
+	ResetPending[TIMx - SimBoard_Tim] = 0;
+}
+
+void TIM_Cmd(LPC_TIM_TypeDef *TIMx, FunctionalState NewState)
+{
+	TIMx->TCR = (NewState == ENABLE) ? 1 : 0;
+}
+
+FlagStatus TIM_GetIntStatus(LPC_TIM_TypeDef *TIMx, TIM_INT_TYPE IntFlag)
+{
+	return (TIMx->IR & (1UL << IntFlag)) ? SET : RESET;
+}
+
+void TIM_ClearIntPending(LPC_TIM_TypeDef *TIMx, TIM_INT_TYPE IntFlag)
+{
+	TIMx->IR &= ~(1UL << IntFlag);
+}
+
+void DFR_RobotInit(void)
+{
+	Gear = 0;
+}
+
+void DFR_IncGear(void)
+{
+	++Gear;
+}
+
+void DFR_DecGear(void)
+{
+	if (Gear != 0)
+		--Gear;
+}
+
+void DFR_DriveForward(uint8_t Speed)
+{
+	SimBoard_Drive(SIMBOARD_FORWARD, Speed);
+}
+
+void DFR_DriveBackward(uint8_t Speed)
+{
+	SimBoard_Drive(SIMBOARD_BACKWARD, Speed);
+}
+
+void DFR_DriveLeft(uint8_t Speed)
+{
+	SimBoard_Drive(SIMBOARD_LEFT, Speed);
+}
+
+void DFR_DriveRight(uint8_t Speed)
+{
+	SimBoard_Drive(SIMBOARD_RIGHT, Speed);
+}
+
+void DFR_DriveStop(void)
+{
+	SimBoard_Drive(SIMBOARD_STOPPED, 0);
+}
+
+void DFR_SetLeftWheelDestination(uint32_t Count)
+{
+	LeftDestination = Count;
+}
+
+void DFR_SetRightWheelDestination(uint32_t Count)
+{
+	RightDestination = Count;
+}
+
+uint32_t DFR_GetLeftWheelDestination(void)
+{
+	return LeftDestination;
+}
+
+uint32_t DFR_GetRightWheelDestination(void)
+{
+	return RightDestination;
+}
+
+void DFR_IncLeftWheelCount(void)
+{
+	++LeftCount;
+}
+
+void DFR_IncRightWheelCount(void)
+{
+	++RightCount;
+}
+
+uint32_t DFR_GetLeftWheelCount(void)
+{
+	return LeftCount;
+}
+
+uint32_t DFR_GetRightWheelCount(void)
+{
+	return RightCount;
+}
+
+void DFR_ClearWheelCounts(void)
+{
+	LeftCount = 0;
+	RightCount = 0;
+}
+
+// The only port the firmware opens is SSP1, which Spi.c then drives through the DMA
+Peripheral_Descriptor_t FreeRTOS_open(const int8_t *pcPath, const uint32_t ulFlags)
+{
+	(void)ulFlags;
+	Sim_Log("open %s", (const char*)pcPath);
+	return (Peripheral_Descriptor_t)LPC_SSP1;
+}
+
+size_t FreeRTOS_write(Peripheral_Descriptor_t const pxPeripheral, const void *pvBuffer, const size_t xBytes)
+{
+	(void)pxPeripheral;
+	SimDma_Shift((const uint8_t*)pvBuffer, (uint32_t)xBytes);
+	return xBytes;
+}
+
+void SSP_DMACmd(LPC_SSP_TypeDef *SSPx, uint32_t DMAMode, FunctionalState NewState)
+{
+	if (NewState == ENABLE)
+		SSPx->DMACR |= DMAMode;
+	else
+		SSPx->DMACR &= ~DMAMode;
+}
+
+// The receive FIFO is always empty: the DMA takes everything as it arrives
+FlagStatus SSP_GetStatus(LPC_SSP_TypeDef *SSPx, uint32_t FlagType)
+{
+	return (SSPx->SR & FlagType) ? SET : RESET;
+}
+
+void joystick_init(void)
+{
+}
+
+void pca9532_init(void)
+{
+}
+
+void PINSEL_ConfigPin(PINSEL_CFG_Type *PinCfg)
+{
+	(void)PinCfg;
+}
+
+uint32_t CLKPWR_GetPCLK(uint32_t ClkType)
+{
+	(void)ClkType;
+	return SIM_PCLK_HZ;
+}
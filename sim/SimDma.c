@@ -0,0 +1,316 @@
+/**************************************************************************//**
+ *
+ * @file		SimDma.c
+ * @brief		Host simulation: GPDMA, SSP1 and the DAC
+ * @version		1.0
+ *
+ * A channel feeding SSP1 shifts its bytes out as soon as it is enabled, to
+ * whichever device has its chip select low. The transfer then occupies the
+ * bus for as long as it would at SIM_SPI_HZ: SimDma_Complete, called by the
+ * SIM task before it delivers interrupts, moves the cycle counter on by that
+ * much and finishes both the transmit and the receive channel.
+ *
+ * A channel feeding the DAC takes one word each time the DAC counter runs
+ * out, walking its linked list block by block; a block with the I bit set
+ * raises the DMA interrupt when it ends, at the sample it ends on.
+ *
+ * Addresses in the channel setup are 32 bits, as the firmware stores them,
+ * which is why the simulation is built with -m32.
+ *
+******************************************************************************/
+
+// Includes
+#include <string.h>
+
+#include "Sim.h"
+#include "IsrProfile.h"
+#include "LPC17xx_GPIO.h"
+#include "LPC17xx_GPDMA.h"
+#include "LPC17xx_DAC.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIMDMA_CHANNELS			8
+#define SIMDMA_CONTROL_SIZE		0xFFF
+
+#define SimDma_Pointer(Address)	((void*)(uintptr_t)(Address))
+
+typedef struct {
+	GPDMA_Channel_CFG_Type Config;
+	uint8_t Enabled;
+	uint32_t Source;			// Current block of a DAC channel
+	uint32_t Remaining;
+	uint32_t Next;
+	uint8_t Interrupt;
+} SimDma_Channel_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static SimDma_Channel_t Channels[SIMDMA_CHANNELS];
+static uint32_t IntTC = 0;
+static uint32_t IntErr = 0;
+static int8_t InFlight = -1;			// SSP1 transmit channel whose bytes are on the wire
+static uint32_t InFlightBytes = 0;
+static uint64_t DacDue = 0;				// When the DAC counter next runs out, in peripheral clocks
+
+static uint32_t SpiTransfers = 0;
+static uint32_t SpiBytes = 0;
+static uint32_t SpiUnselected = 0;		// Bytes sent with no chip select low
+static uint32_t DacWords = 0;
+static uint32_t DacBlocks = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static uint32_t SimDma_DacPeriod(void)
+{
+	return LPC_DAC->CNTVAL + 1;
+}
+
+static void SimDma_Finish(uint8_t Channel)
+{
+	Channels[Channel].Enabled = 0;
+	IntTC |= (1UL << Channel);
+}
+
+// Take the next block of a DAC channel from its linked list, or stop it
+static void SimDma_NextBlock(SimDma_Channel_t *Channel)
+{
+	const GPDMA_LLI_Type *Item = (const GPDMA_LLI_Type*)SimDma_Pointer(Channel->Next);
+
+	if (Item == 0)
+	{
+		Channel->Enabled = 0;
+		return;
+	}
+
+	Channel->Source = Item->SrcAddr;
+	Channel->Remaining = Item->Control & SIMDMA_CONTROL_SIZE;
+	Channel->Interrupt = (Item->Control & GPDMA_DMACCxControl_I) ? 1 : 0;
+	Channel->Next = Item->NextLLI;
+	++DacBlocks;
+}
+
+// One DAC request: move a word from the block to the DAC
+static void SimDma_DacWord(uint8_t Index)
+{
+	SimDma_Channel_t *Channel = &Channels[Index];
+	uint32_t Word = *(const uint32_t*)SimDma_Pointer(Channel->Source);
+
+	LPC_DAC->CR = Word;
+	SimAudio_Sample((Word >> 6) & 0x3FF);
+	Channel->Source += sizeof(uint32_t);
+	++DacWords;
+
+	if (--Channel->Remaining == 0)
+	{
+		if (Channel->Interrupt)
+		{
+			IntTC |= (1UL << Index);
+			Sim_Raise(DMA_IRQn);
+		}
+		if (Channel->Enabled)
+			SimDma_NextBlock(Channel);
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Bytes on SSP1, to whichever device is selected
+void SimDma_Shift(const uint8_t *Bytes, uint32_t Length)
+{
+	uint8_t Data = (GPIO_ReadValue(SIM_OLED_DC_PORT) & SIM_OLED_DC_PIN) ? 1 : 0;
+	uint8_t Oled = (GPIO_ReadValue(SIM_OLED_CS_PORT) & SIM_OLED_CS_PIN) ? 0 : 1;
+	uint8_t Segments = (GPIO_ReadValue(SIM_7SEG_CS_PORT) & SIM_7SEG_CS_PIN) ? 0 : 1;
+	uint32_t i;
+
+	SpiBytes += Length;
+	if (!Oled && !Segments)
+		SpiUnselected += Length;
+
+	for (i = 0; i < Length; ++i)
+	{
+		if (Oled)
+			SimOled_Write(Bytes[i], Data);
+		if (Segments)
+			SimBoard_SevenSegment(Bytes[i]);
+	}
+}
+
+// Finish the SPI transfer on the wire, if there is one. Returns 1 if it did.
+uint8_t SimDma_Complete(void)
+{
+	uint8_t c;
+
+	if (InFlight < 0)
+		return 0;
+
+	// The bus is busy for as long as the bytes take to clock out
+	IsrProfile_HostAdvance(InFlightBytes * 8 * (SIM_CCLK_HZ / SIM_SPI_HZ));
+
+	SimDma_Finish((uint8_t)InFlight);
+	for (c = 0; c < SIMDMA_CHANNELS; ++c)
+	{
+		if (Channels[c].Enabled && (Channels[c].Config.SrcConn == GPDMA_CONN_SSP1_Rx) && (Channels[c].Config.TransferType == GPDMA_TRANSFERTYPE_P2M))
+			SimDma_Finish(c);
+	}
+	InFlight = -1;
+
+	Sim_Raise(DMA_IRQn);
+	return 1;
+}
+
+// Run the DAC's channel through the tick starting at TickStart, in peripheral clocks
+void SimDma_Step(uint64_t TickStart)
+{
+	uint64_t End = TickStart + SIM_TICK_PCLK;
+	uint8_t c;
+
+	if ((LPC_DAC->CTRL & (DAC_CNT_ENA | DAC_DMA_ENA)) != (DAC_CNT_ENA | DAC_DMA_ENA))
+		return;
+
+	for (c = 0; c < SIMDMA_CHANNELS; ++c)
+	{
+		if (Channels[c].Enabled && (Channels[c].Config.DstConn == GPDMA_CONN_DAC))
+			break;
+	}
+	if (c == SIMDMA_CHANNELS)
+		return;
+
+	if (DacDue < TickStart)
+		DacDue = TickStart + SimDma_DacPeriod();
+
+	while (Channels[c].Enabled && (DacDue <= End))
+	{
+		Sim_SetPclk(DacDue);
+		SimDma_DacWord(c);
+		// The handler may have changed the period for the next block
+		DacDue += SimDma_DacPeriod();
+	}
+}
+
+void SimDma_Report(FILE *Out)
+{
+	fprintf(Out, "SPI %u transfers, %u bytes, %u with nothing selected\n", (unsigned)SpiTransfers, (unsigned)SpiBytes, (unsigned)SpiUnselected);
+	if (DacBlocks != 0)
+		fprintf(Out, "DAC DMA %u blocks, %u samples\n", (unsigned)DacBlocks, (unsigned)DacWords);
+}
+
+void GPDMA_Init(void)
+{
+	memset(Channels, 0, sizeof(Channels));
+	IntTC = 0;
+	IntErr = 0;
+	InFlight = -1;
+}
+
+Status GPDMA_Setup(GPDMA_Channel_CFG_Type *GPDMAChannelConfig)
+{
+	SimDma_Channel_t *Channel;
+
+	if (GPDMAChannelConfig->ChannelNum >= SIMDMA_CHANNELS)
+		return ERROR;
+
+	Channel = &Channels[GPDMAChannelConfig->ChannelNum];
+	if (Channel->Enabled)
+		return ERROR;
+
+	// The driver always sets the I bit on the first block
+	Channel->Config = *GPDMAChannelConfig;
+	Channel->Source = GPDMAChannelConfig->SrcMemAddr;
+	Channel->Remaining = GPDMAChannelConfig->TransferSize;
+	Channel->Next = GPDMAChannelConfig->DMALLI;
+	Channel->Interrupt = 1;
+	IntTC &= ~(1UL << GPDMAChannelConfig->ChannelNum);
+	IntErr &= ~(1UL << GPDMAChannelConfig->ChannelNum);
+	return SUCCESS;
+}
+
+void GPDMA_ChannelCmd(uint8_t channelNum, FunctionalState NewState)
+{
+	SimDma_Channel_t *Channel;
+
+	if (channelNum >= SIMDMA_CHANNELS)
+		return;
+
+	Channel = &Channels[channelNum];
+	if (NewState != ENABLE)
+	{
+		Channel->Enabled = 0;
+		if (InFlight == channelNum)
+			InFlight = -1;
+		return;
+	}
+
+	Channel->Enabled = 1;
+	if ((Channel->Config.TransferType == GPDMA_TRANSFERTYPE_M2P) && (Channel->Config.DstConn == GPDMA_CONN_SSP1_Tx))
+	{
+		++SpiTransfers;
+		SimDma_Shift((const uint8_t*)SimDma_Pointer(Channel->Source), Channel->Remaining);
+		InFlight = (int8_t)channelNum;
+		InFlightBytes = Channel->Remaining;
+		Sim_Wake();
+	}
+	else if (Channel->Config.DstConn == GPDMA_CONN_DAC)
+	{
+		++DacBlocks;
+		DacDue = Sim_Pclk() + SimDma_DacPeriod();
+	}
+}
+
+IntStatus GPDMA_IntGetStatus(GPDMA_Status_Type type, uint8_t channel)
+{
+	uint32_t Mask = 1UL << channel;
+
+	switch (type)
+	{
+		case GPDMA_STAT_INT:
+		case GPDMA_STAT_RAWINTTC:
+		case GPDMA_STAT_RAWINTERR:
+			return ((IntTC | IntErr) & Mask) ? SET : RESET;
+		case GPDMA_STAT_INTTC:
+			return (IntTC & Mask) ? SET : RESET;
+		case GPDMA_STAT_INTERR:
+			return (IntErr & Mask) ? SET : RESET;
+		case GPDMA_STAT_ENABLED_CH:
+			return Channels[channel].Enabled ? SET : RESET;
+		default:
+			return RESET;
+	}
+}
+
+void GPDMA_ClearIntPending(GPDMA_StateClear_Type type, uint8_t channel)
+{
+	if (type == GPDMA_STATCLR_INTTC)
+		IntTC &= ~(1UL << channel);
+	else
+		IntErr &= ~(1UL << channel);
+}
+
+void DAC_Init(LPC_DAC_TypeDef *DACx)
+{
+	memset((void*)DACx, 0, sizeof(*DACx));
+}
+
+// The timer path writes the 10-bit value directly
+void DAC_UpdateValue(LPC_DAC_TypeDef *DACx, uint32_t dac_value)
+{
+	DACx->CR = DAC_VALUE(dac_value);
+	SimAudio_Sample(dac_value & 0x3FF);
+}
+
+void DAC_SetDMATimeOut(LPC_DAC_TypeDef *DACx, uint32_t time_out)
+{
+	DACx->CNTVAL = time_out;
+}
+
+void DAC_ConfigDAConverterControl(LPC_DAC_TypeDef *DACx, DAC_CONVERTER_CFG_Type *DAC_ConverterConfigStruct)
+{
+	DACx->CTRL = (DAC_ConverterConfigStruct->DBLBUF_ENA ? (1UL << 1) : 0)
+			   | (DAC_ConverterConfigStruct->CNT_ENA ? DAC_CNT_ENA : 0)
+			   | (DAC_ConverterConfigStruct->DMA_ENA ? DAC_DMA_ENA : 0);
+}
@@ -0,0 +1,318 @@
+/**************************************************************************//**
+ *
+ * @file		SimGpio.c
+ * @brief		Host simulation: GPIO ports, pin interrupts and scripted inputs
+ * @version		1.0
+ *
+ * Every pin starts high, as the board's pull-ups leave the joystick and
+ * buttons. A change on port 0 or 2 whose edge is enabled sets the matching
+ * status bit in LPC_GPIOINT and raises EINT3, as on the chip.
+ *
+ * The input script has one event per line:
+ *
+ *		<ms> <input> [hold ms]
+ *
+ * where input is up, down, left, right, center, lbutton or rbutton. The pin
+ * is pulled low at <ms> and released after the hold, 100 ms by default; the
+ * firmware acts on the rising edge of the release. '#' starts a comment.
+ *
+******************************************************************************/
+
+// Includes
+#include <stdlib.h>
+#include <string.h>
+
+#include "Sim.h"
+#include "LPC17xx_GPIO.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIMGPIO_PORTS			5
+#define SIMGPIO_MAX_EVENTS		1024
+#define SIMGPIO_DEFAULT_HOLD	100			// ms
+#define SIMGPIO_LINE			128
+
+typedef struct {
+	const char *Name;
+	uint8_t Port;
+	uint32_t Pin;
+} SimGpio_Input_t;
+
+typedef struct {
+	uint64_t Micros;
+	uint8_t Port;
+	uint32_t Pin;
+	uint8_t High;
+} SimGpio_Event_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+
+// The joystick and buttons as main.c wires them
+static const SimGpio_Input_t Inputs[] = {
+	{"up",		2, 1UL << 3},
+	{"down",	0, 1UL << 15},
+	{"left",	2, 1UL << 4},
+	{"right",	0, 1UL << 16},
+	{"center",	0, 1UL << 17},
+	{"lbutton",	0, 1UL << 4},
+	{"rbutton",	1, 1UL << 31},
+};
+
+static uint32_t Level[SIMGPIO_PORTS];
+static uint32_t Direction[SIMGPIO_PORTS];
+static SimGpio_Event_t Events[SIMGPIO_MAX_EVENTS];
+static uint32_t EventCount = 0;
+static uint32_t NextEvent = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Latch the enabled ones of these edges on port 0 or 2. Returns 1 if any were.
+static uint8_t SimGpio_Latch(uint8_t Port, uint32_t Rising, uint32_t Falling)
+{
+	if (Port == 0)
+	{
+		Rising &= LPC_GPIOINT->IO0IntEnR;
+		Falling &= LPC_GPIOINT->IO0IntEnF;
+		LPC_GPIOINT->IO0IntStatR |= Rising;
+		LPC_GPIOINT->IO0IntStatF |= Falling;
+	}
+	else if (Port == 2)
+	{
+		Rising &= LPC_GPIOINT->IO2IntEnR;
+		Falling &= LPC_GPIOINT->IO2IntEnF;
+		LPC_GPIOINT->IO2IntStatR |= Rising;
+		LPC_GPIOINT->IO2IntStatF |= Falling;
+	}
+	else
+	{
+		return 0;
+	}
+
+	if ((Rising | Falling) == 0)
+		return 0;
+
+	LPC_GPIOINT->IntStatus |= (Port == 0) ? (1UL << 0) : (1UL << 2);
+	return 1;
+}
+
+// Set the pins in Pins to High, and raise EINT3 for any enabled edges this makes
+static void SimGpio_Set(uint8_t Port, uint32_t Pins, uint8_t High)
+{
+	uint32_t Before;
+
+	if (Port >= SIMGPIO_PORTS)
+		return;
+
+	Before = Level[Port];
+	Level[Port] = High ? (Before | Pins) : (Before & ~Pins);
+	if (SimGpio_Latch(Port, ~Before & Level[Port], Before & ~Level[Port]))
+		Sim_Raise(EINT3_IRQn);
+}
+
+static const SimGpio_Input_t* SimGpio_Find(const char *Name)
+{
+	uint8_t i;
+
+	for (i = 0; i < sizeof(Inputs) / sizeof(Inputs[0]); ++i)
+	{
+		if (strcmp(Inputs[i].Name, Name) == 0)
+			return &Inputs[i];
+	}
+	return 0;
+}
+
+static uint8_t SimGpio_Add(uint64_t Micros, const SimGpio_Input_t *Input, uint8_t High)
+{
+	if (EventCount == SIMGPIO_MAX_EVENTS)
+		return 0;
+
+	Events[EventCount].Micros = Micros;
+	Events[EventCount].Port = Input->Port;
+	Events[EventCount].Pin = Input->Pin;
+	Events[EventCount].High = High;
+	++EventCount;
+	return 1;
+}
+
+// Stable, so a press and release at the same time keep their script order
+static void SimGpio_Sort(void)
+{
+	SimGpio_Event_t Event;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 1; i < EventCount; ++i)
+	{
+		Event = Events[i];
+		for (j = i; (j > 0) && (Events[j - 1].Micros > Event.Micros); --j)
+			Events[j] = Events[j - 1];
+		Events[j] = Event;
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void SimGpio_Init(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < SIMGPIO_PORTS; ++i)
+	{
+		Level[i] = 0xFFFFFFFF;
+		Direction[i] = 0;
+	}
+	memset((void*)LPC_GPIOINT, 0, sizeof(*LPC_GPIOINT));
+	EventCount = 0;
+	NextEvent = 0;
+}
+
+// Drive pins from outside the chip, as the joystick or the wheel encoders do
+void SimGpio_Drive(uint8_t Port, uint32_t Pins, uint8_t High)
+{
+	if (Port < SIMGPIO_PORTS)
+		SimGpio_Set(Port, Pins & ~Direction[Port], High);
+}
+
+// Latch a rising edge on Pins, as a pulse too short to see would, without
+// raising EINT3, so edges on both ports can reach one handler run as they do
+// on the chip. Returns 1 if any of them are enabled.
+uint8_t SimGpio_Edge(uint8_t Port, uint32_t Pins)
+{
+	return SimGpio_Latch(Port, Pins, 0);
+}
+
+// Read an input script. Returns 1 if every line made sense.
+uint8_t SimGpio_Load(const char *Path)
+{
+	const SimGpio_Input_t *Input;
+	char Line[SIMGPIO_LINE];
+	char Name[SIMGPIO_LINE];
+	unsigned long At;
+	unsigned long Hold;
+	uint32_t Number = 0;
+	int Fields;
+	char *Comment;
+	FILE *Script = fopen(Path, "r");
+
+	if (Script == 0)
+		return 0;
+
+	while (fgets(Line, sizeof(Line), Script) != 0)
+	{
+		++Number;
+		Comment = strchr(Line, '#');
+		if (Comment != 0)
+			*Comment = '\0';
+
+		Hold = SIMGPIO_DEFAULT_HOLD;
+		Fields = sscanf(Line, "%lu %127s %lu", &At, Name, &Hold);
+		if (Fields <= 0)
+			continue;
+
+		Input = (Fields >= 2) ? SimGpio_Find(Name) : 0;
+		if ((Input == 0) || !SimGpio_Add((uint64_t)At * 1000, Input, 0) || !SimGpio_Add((uint64_t)(At + Hold) * 1000, Input, 1))
+		{
+			fprintf(stderr, "%s:%u: cannot use this line\n", Path, (unsigned)Number);
+			fclose(Script);
+			return 0;
+		}
+	}
+
+	fclose(Script);
+	SimGpio_Sort();
+	return 1;
+}
+
+// Play the script up to Micros
+void SimGpio_Step(uint64_t Micros)
+{
+	SimGpio_Event_t *Event;
+
+	while ((NextEvent < EventCount) && (Events[NextEvent].Micros <= Micros))
+	{
+		Event = &Events[NextEvent++];
+		Sim_Log("P%u.%u %s", Event->Port, (unsigned)__builtin_ctz(Event->Pin), Event->High ? "released" : "pressed");
+		SimGpio_Drive(Event->Port, Event->Pin, Event->High);
+	}
+}
+
+void GPIO_SetDir(uint8_t portNum, uint32_t bitValue, uint8_t dir)
+{
+	if (portNum >= SIMGPIO_PORTS)
+		return;
+
+	if (dir)
+		Direction[portNum] |= bitValue;
+	else
+		Direction[portNum] &= ~bitValue;
+}
+
+void GPIO_SetValue(uint8_t portNum, uint32_t bitValue)
+{
+	SimGpio_Set(portNum, bitValue, 1);
+}
+
+void GPIO_ClearValue(uint8_t portNum, uint32_t bitValue)
+{
+	SimGpio_Set(portNum, bitValue, 0);
+}
+
+uint32_t GPIO_ReadValue(uint8_t portNum)
+{
+	return (portNum < SIMGPIO_PORTS) ? Level[portNum] : 0;
+}
+
+// edgeState 0 enables the rising edge, 1 the falling edge
+void GPIO_IntCmd(uint8_t portNum, uint32_t bitValue, uint8_t edgeState)
+{
+	if (portNum == 0)
+	{
+		if (edgeState == 0)
+			LPC_GPIOINT->IO0IntEnR |= bitValue;
+		else
+			LPC_GPIOINT->IO0IntEnF |= bitValue;
+	}
+	else if (portNum == 2)
+	{
+		if (edgeState == 0)
+			LPC_GPIOINT->IO2IntEnR |= bitValue;
+		else
+			LPC_GPIOINT->IO2IntEnF |= bitValue;
+	}
+}
+
+FunctionalState GPIO_GetIntStatus(uint8_t portNum, uint32_t pinNum, uint8_t edgeState)
+{
+	uint32_t Status = 0;
+
+	if (portNum == 0)
+		Status = (edgeState == 0) ? LPC_GPIOINT->IO0IntStatR : LPC_GPIOINT->IO0IntStatF;
+	else if (portNum == 2)
+		Status = (edgeState == 0) ? LPC_GPIOINT->IO2IntStatR : LPC_GPIOINT->IO2IntStatF;
+
+	return ((Status >> pinNum) & 1) ? ENABLE : DISABLE;
+}
+
+void GPIO_ClearInt(uint8_t portNum, uint32_t bitValue)
+{
+	if (portNum == 0)
+	{
+		LPC_GPIOINT->IO0IntStatR &= ~bitValue;
+		LPC_GPIOINT->IO0IntStatF &= ~bitValue;
+		if ((LPC_GPIOINT->IO0IntStatR | LPC_GPIOINT->IO0IntStatF) == 0)
+			LPC_GPIOINT->IntStatus &= ~(1UL << 0);
+	}
+	else if (portNum == 2)
+	{
+		LPC_GPIOINT->IO2IntStatR &= ~bitValue;
+		LPC_GPIOINT->IO2IntStatF &= ~bitValue;
+		if ((LPC_GPIOINT->IO2IntStatR | LPC_GPIOINT->IO2IntStatF) == 0)
+			LPC_GPIOINT->IntStatus &= ~(1UL << 2);
+	}
+}
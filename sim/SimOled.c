@@ -0,0 +1,125 @@
+/**************************************************************************//**
+ *
+ * @file		SimOled.c
+ * @brief		Host simulation: the OLED controller
+ * @version		1.0
+ *
+ * Keeps the controller's 132 column by 8 page RAM and follows the page and
+ * column address commands Framebuffer.c sends; every other command is
+ * counted and ignored. Data bytes land at the column address, which moves
+ * on by one each time. Only columns 18 to 113 are on the glass, and those
+ * are what gets saved: a PBM bitmap, and a text picture with '#' for each
+ * dark pixel, the firmware's ink, for reading in a terminal or diffing runs.
+ *
+******************************************************************************/
+
+// Includes
+#include <string.h>
+
+#include "Sim.h"
+#include "OLED.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIMOLED_PAGES			8
+#define SIMOLED_COLUMNS			132
+#define SIMOLED_FIRST			18			// First column on the glass
+#define SIMOLED_WIDTH			96
+#define SIMOLED_HEIGHT			(SIMOLED_PAGES * 8)
+#define SIMOLED_NAME			64
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static uint8_t Ram[SIMOLED_PAGES][SIMOLED_COLUMNS];
+static uint8_t Page = 0;
+static uint8_t Column = 0;
+static uint32_t DataBytes = 0;
+static uint32_t Commands = 0;
+static uint32_t Saves = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static uint8_t SimOled_Pixel(uint8_t X, uint8_t Y)
+{
+	return (Ram[Y >> 3][SIMOLED_FIRST + X] >> (Y & 7)) & 1;
+}
+
+static uint8_t SimOled_SaveFile(const char *Name, const char *Extension, uint8_t Picture)
+{
+	char File[SIMOLED_NAME];
+	FILE *Out;
+	uint8_t X;
+	uint8_t Y;
+
+	snprintf(File, sizeof(File), "%s.%s", Name, Extension);
+	Out = Sim_Create(File, "w");
+	if (Out == 0)
+		return 0;
+
+	// PBM has 1 for black, so a lit pixel is 0
+	if (!Picture)
+		fprintf(Out, "P1\n%u %u\n", SIMOLED_WIDTH, SIMOLED_HEIGHT);
+
+	for (Y = 0; Y < SIMOLED_HEIGHT; ++Y)
+	{
+		for (X = 0; X < SIMOLED_WIDTH; ++X)
+		{
+			if (Picture)
+				fputc(SimOled_Pixel(X, Y) ? '.' : '#', Out);
+			else
+				fputs(SimOled_Pixel(X, Y) ? "0 " : "1 ", Out);
+		}
+		fputc('\n', Out);
+	}
+
+	fclose(Out);
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// A byte on the SPI with the OLED selected; Data is the data/command line
+void SimOled_Write(uint8_t Byte, uint8_t Data)
+{
+	if (Data)
+	{
+		++DataBytes;
+		if (Column < SIMOLED_COLUMNS)
+			Ram[Page][Column++] = Byte;
+		return;
+	}
+
+	++Commands;
+	if ((Byte & 0xF0) == 0xB0)
+		Page = Byte & 0x07;
+	else if ((Byte & 0xF0) == 0x00)
+		Column = (Column & 0xF0) | (Byte & 0x0F);
+	else if ((Byte & 0xF0) == 0x10)
+		Column = (Column & 0x0F) | ((Byte & 0x0F) << 4);
+}
+
+// Save the glass as Name.pbm and Name.txt. Returns 1 if both were written.
+uint8_t SimOled_Save(const char *Name)
+{
+	++Saves;
+	return SimOled_SaveFile(Name, "pbm", 0) & SimOled_SaveFile(Name, "txt", 1);
+}
+
+void SimOled_Report(FILE *Out)
+{
+	fprintf(Out, "OLED %u data bytes, %u commands, %u pictures saved\n", (unsigned)DataBytes, (unsigned)Commands, (unsigned)Saves);
+}
+
+// The panel comes up blank; the firmware's Framebuffer does the rest
+void OLED_Init(Peripheral_Descriptor_t SPIPort)
+{
+	(void)SPIPort;
+	memset(Ram, 0, sizeof(Ram));
+	Page = 0;
+	Column = 0;
+}
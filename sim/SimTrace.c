@@ -0,0 +1,143 @@
+/**************************************************************************//**
+ *
+ * @file		SimTrace.c
+ * @brief		Host simulation: record and replay InputTrace files
+ * @version		1.0
+ *
+ * Replay reads a trace made on the board or by an earlier run, and at each
+ * record's time latches its edges and raises EINT3 once, so the handler sees
+ * the same inputs together that it saw when they were recorded. The right
+ * button is held or released to match before each one. The robot base's own
+ * encoder pulses are turned off, since the trace has the real ones.
+ *
+ * Records land on the first tick at or after their time; a trace recorded by
+ * the simulation is timed in whole ticks already, so it replays exactly.
+ *
+******************************************************************************/
+
+// Includes
+#include <stdlib.h>
+#include <string.h>
+
+#include "Sim.h"
+#include "InputTrace.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+typedef struct {
+	uint64_t Micros;
+	uint16_t Inputs;
+} SimTrace_Event_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static SimTrace_Event_t *Events = 0;
+static uint32_t EventCount = 0;
+static uint32_t NextEvent = 0;
+static uint32_t Dropped = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static uint32_t SimTrace_Get32(const uint8_t *In)
+{
+	return (uint32_t)In[0] | ((uint32_t)In[1] << 8) | ((uint32_t)In[2] << 16) | ((uint32_t)In[3] << 24);
+}
+
+static void SimTrace_Apply(uint16_t Inputs)
+{
+	const InputTrace_Pin_t *Pin = &InputTrace_Pins[INPUTTRACE_RBUTTON];
+	uint8_t Raise = 0;
+	uint8_t i;
+
+	SimGpio_Drive(Pin->Port, Pin->Pin, (Inputs & (1U << INPUTTRACE_RBUTTON)) ? 0 : 1);
+
+	for (i = 0; i < INPUTTRACE_RBUTTON; ++i)
+	{
+		if (Inputs & (1U << i))
+			Raise |= SimGpio_Edge(InputTrace_Pins[i].Port, InputTrace_Pins[i].Pin);
+	}
+	if (Raise)
+		Sim_Raise(EINT3_IRQn);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+
+// Read a trace to replay. Returns 1 if it is a whole trace.
+uint8_t SimTrace_Load(const char *Path)
+{
+	uint8_t Header[INPUTTRACE_HEADER];
+	uint8_t Record[INPUTTRACE_RECORD_BYTES];
+	uint64_t Micros = 0;
+	uint32_t Count;
+	uint32_t i;
+	FILE *Trace = fopen(Path, "rb");
+
+	if (Trace == 0)
+		return 0;
+
+	if ((fread(Header, 1, sizeof(Header), Trace) != sizeof(Header)) || (memcmp(Header, INPUTTRACE_MAGIC, 4) != 0))
+	{
+		fclose(Trace);
+		return 0;
+	}
+
+	Count = SimTrace_Get32(&Header[4]);
+	Dropped = SimTrace_Get32(&Header[8]);
+	Events = calloc((Count != 0) ? Count : 1, sizeof(SimTrace_Event_t));
+	if (Events == 0)
+	{
+		fclose(Trace);
+		return 0;
+	}
+
+	for (i = 0; i < Count; ++i)
+	{
+		if (fread(Record, 1, sizeof(Record), Trace) != sizeof(Record))
+			break;
+		Micros += SimTrace_Get32(Record);
+		Events[i].Micros = Micros;
+		Events[i].Inputs = (uint16_t)(Record[4] | (Record[5] << 8));
+	}
+	fclose(Trace);
+
+	EventCount = i;
+	NextEvent = 0;
+	SimBoard_Encoders(0);
+	return (EventCount == Count);
+}
+
+// Replay the trace up to Micros
+void SimTrace_Step(uint64_t Micros)
+{
+	while ((NextEvent < EventCount) && (Events[NextEvent].Micros <= Micros))
+		SimTrace_Apply(Events[NextEvent++].Inputs);
+}
+
+// Write the firmware's own trace of this run to Name in the output directory
+uint8_t SimTrace_Save(const char *Name)
+{
+	uint32_t Length = InputTrace_Length();
+	FILE *Trace = Sim_Create(Name, "wb");
+	uint8_t Written;
+
+	if (Trace == 0)
+		return 0;
+
+	Written = (fwrite(InputTrace_Log, 1, Length, Trace) == Length);
+	return (fclose(Trace) == 0) && Written;
+}
+
+void SimTrace_Report(FILE *Out)
+{
+	if (EventCount != 0)
+	{
+		fprintf(Out, "Trace replayed %u of %u records%s\n", (unsigned)NextEvent, (unsigned)EventCount,
+			(Dropped != 0) ? ", recording was cut short" : "");
+	}
+	fprintf(Out, "Trace recorded %u records, %u dropped\n", (unsigned)SimTrace_Get32(&InputTrace_Log[4]), (unsigned)SimTrace_Get32(&InputTrace_Log[8]));
+}
@@ -0,0 +1,54 @@
+/**************************************************************************//**
+ *
+ * @file		FreeRTOSConfig.h
+ * @brief		Kernel configuration for the host simulation on the POSIX port
+ * @version		1.0
+ *
+ * Only used by the simulation; the board build keeps its own. The firmware
+ * still uses the FreeRTOS 7 names (xSemaphoreHandle, portTickType, ...), so
+ * the backward compatibility names are switched on.
+ *
+******************************************************************************/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+// Includes
+#include <assert.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define configUSE_PREEMPTION					1
+#define configUSE_IDLE_HOOK						1
+#define configUSE_TICK_HOOK						0
+#define configCPU_CLOCK_HZ						100000000UL		// The LPC1769's, for the cycle figures; not the host's
+#define configTICK_RATE_HZ						1000
+#define configMAX_PRIORITIES					8				// The top one is the simulated interrupt controller
+#define configMINIMAL_STACK_SIZE				((unsigned short)4096)	// Words; each task is a thread, which needs at least 16 KB
+#define configTOTAL_HEAP_SIZE					(1024 * 1024)	// Unused with heap_3
+#define configMAX_TASK_NAME_LEN					16
+#define configUSE_16_BIT_TICKS					0
+#define configIDLE_SHOULD_YIELD					1
+#define configUSE_MUTEXES						1
+#define configUSE_RECURSIVE_MUTEXES				1
+#define configUSE_COUNTING_SEMAPHORES			1
+#define configQUEUE_REGISTRY_SIZE				0
+#define configCHECK_FOR_STACK_OVERFLOW			0				// Host threads overflow into a guard page instead
+#define configUSE_MALLOC_FAILED_HOOK			1
+#define configUSE_TIMERS						0
+#define configSUPPORT_DYNAMIC_ALLOCATION		1
+#define configSUPPORT_STATIC_ALLOCATION			0
+#define configENABLE_BACKWARD_COMPATIBILITY		1
+
+#define INCLUDE_vTaskDelay						1
+#define INCLUDE_vTaskDelayUntil					1
+#define INCLUDE_xTaskDelayUntil					1
+#define INCLUDE_vTaskDelete						1
+#define INCLUDE_vTaskSuspend					1
+#define INCLUDE_xTaskGetCurrentTaskHandle		1
+#define INCLUDE_uxTaskGetStackHighWaterMark		1
+
+#define configASSERT(x)							assert(x)
+
+#endif // FREERTOS_CONFIG_H
@@ -0,0 +1,37 @@
+/**************************************************************************//**
+ *
+ * @file		FreeRTOS_IO.h
+ * @brief		Simulation: FreeRTOS+IO and the base board's pin assignments
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef FREERTOS_IO_H
+#define FREERTOS_IO_H
+
+// Includes
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "LPC17xx_GPIO.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define board_SSP_PORT				((const int8_t*)"/SSP1/")
+#define boardGPIO_OUTPUT			1
+#define boardGPIO_INPUT				0
+
+#define board7SEG_CS_PORT			2
+#define board7SEG_CS_PIN			(1 << 2)
+#define board7SEG_ASSERT_CS()		GPIO_ClearValue(board7SEG_CS_PORT, board7SEG_CS_PIN)
+#define board7SEG_DEASSERT_CS()		GPIO_SetValue(board7SEG_CS_PORT, board7SEG_CS_PIN)
+
+typedef void* Peripheral_Descriptor_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+Peripheral_Descriptor_t FreeRTOS_open(const int8_t *pcPath, const uint32_t ulFlags);
+size_t FreeRTOS_write(Peripheral_Descriptor_t const pxPeripheral, const void *pvBuffer, const size_t xBytes);
+
+#endif // FREERTOS_IO_H
@@ -0,0 +1,16 @@
+/**************************************************************************//**
+ *
+ * @file		FreeRTOS_Queue.h
+ * @brief		Simulation: the board's name for the kernel's queue.h
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef FREERTOS_QUEUE_H
+#define FREERTOS_QUEUE_H
+
+// Includes
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#endif // FREERTOS_QUEUE_H
@@ -0,0 +1,16 @@
+/**************************************************************************//**
+ *
+ * @file		FreeRTOS_Semaphore.h
+ * @brief		Simulation: the board's name for the kernel's semphr.h
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef FREERTOS_SEMAPHORE_H
+#define FREERTOS_SEMAPHORE_H
+
+// Includes
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#endif // FREERTOS_SEMAPHORE_H
@@ -0,0 +1,16 @@
+/**************************************************************************//**
+ *
+ * @file		FreeRTOS_Task.h
+ * @brief		Simulation: the board's name for the kernel's task.h
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+// Includes
+#include "FreeRTOS.h"
+#include "task.h"
+
+#endif // FREERTOS_TASK_H
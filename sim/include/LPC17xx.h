@@ -0,0 +1,106 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx.h
+ * @brief		Simulation: the peripherals the firmware touches directly
+ * @version		1.0
+ *
+ * The register blocks are ordinary variables in SimBoard.c rather than fixed
+ * addresses, with only the registers the firmware or the simulation use. The
+ * NVIC calls decide which of the simulated interrupts are delivered.
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_H
+#define LPC17XX_H
+
+// Includes
+#include <stdint.h>
+#include "lpc_types.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+typedef enum {
+	TIMER0_IRQn = 1,
+	TIMER1_IRQn = 2,
+	TIMER2_IRQn = 3,
+	TIMER3_IRQn = 4,
+	SSP1_IRQn = 15,
+	EINT3_IRQn = 21,
+	DMA_IRQn = 26
+} IRQn_Type;
+
+typedef struct {
+	__IO uint32_t CR;
+	__IO uint32_t CTRL;
+	__IO uint32_t CNTVAL;
+} LPC_DAC_TypeDef;
+
+typedef struct {
+	__IO uint32_t IR;
+	__IO uint32_t TCR;
+	__IO uint32_t TC;
+	__IO uint32_t PR;
+	__IO uint32_t PC;
+	__IO uint32_t MCR;
+	__IO uint32_t MR0;
+	__IO uint32_t MR1;
+	__IO uint32_t MR2;
+	__IO uint32_t MR3;
+	__IO uint32_t CCR;
+	__IO uint32_t CR0;
+	__IO uint32_t CR1;
+	__IO uint32_t EMR;
+	__IO uint32_t CTCR;
+} LPC_TIM_TypeDef;
+
+typedef struct {
+	__IO uint32_t IntStatus;
+	__IO uint32_t IO0IntStatR;
+	__IO uint32_t IO0IntStatF;
+	__IO uint32_t IO0IntClr;
+	__IO uint32_t IO0IntEnR;
+	__IO uint32_t IO0IntEnF;
+	__IO uint32_t IO2IntStatR;
+	__IO uint32_t IO2IntStatF;
+	__IO uint32_t IO2IntClr;
+	__IO uint32_t IO2IntEnR;
+	__IO uint32_t IO2IntEnF;
+} LPC_GPIOINT_TypeDef;
+
+typedef struct {
+	__IO uint32_t CR0;
+	__IO uint32_t CR1;
+	__IO uint32_t DR;
+	__IO uint32_t SR;
+	__IO uint32_t CPSR;
+	__IO uint32_t IMSC;
+	__IO uint32_t RIS;
+	__IO uint32_t MIS;
+	__IO uint32_t ICR;
+	__IO uint32_t DMACR;
+} LPC_SSP_TypeDef;
+
+extern LPC_DAC_TypeDef SimBoard_Dac;
+extern LPC_TIM_TypeDef SimBoard_Tim[4];
+extern LPC_GPIOINT_TypeDef SimBoard_GpioInt;
+extern LPC_SSP_TypeDef SimBoard_Ssp1;
+
+#define LPC_DAC					(&SimBoard_Dac)
+#define LPC_TIM0				(&SimBoard_Tim[0])
+#define LPC_TIM1				(&SimBoard_Tim[1])
+#define LPC_TIM2				(&SimBoard_Tim[2])
+#define LPC_TIM3				(&SimBoard_Tim[3])
+#define LPC_GPIOINT				(&SimBoard_GpioInt)
+#define LPC_SSP1				(&SimBoard_Ssp1)
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void NVIC_SetPriorityGrouping(uint32_t PriorityGroup);
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t Priority);
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+void NVIC_SetPendingIRQ(IRQn_Type IRQn);
+
+#endif // LPC17XX_H
@@ -0,0 +1,30 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx_ClkPwr.h
+ * @brief		Simulation: peripheral clocks, all at the reset default of CCLK / 4
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_CLKPWR_H
+#define LPC17XX_CLKPWR_H
+
+// Includes
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define CLKPWR_PCLKSEL_TIMER0		2
+#define CLKPWR_PCLKSEL_TIMER1		4
+#define CLKPWR_PCLKSEL_SSP1			20
+#define CLKPWR_PCLKSEL_DAC			22
+#define CLKPWR_PCLKSEL_TIMER2		44
+#define CLKPWR_PCLKSEL_TIMER3		46
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+uint32_t CLKPWR_GetPCLK(uint32_t ClkType);
+
+#endif // LPC17XX_CLKPWR_H
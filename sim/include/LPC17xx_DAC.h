@@ -0,0 +1,37 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx_DAC.h
+ * @brief		Simulation: DAC driver, backed by SimDma.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_DAC_H
+#define LPC17XX_DAC_H
+
+// Includes
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define DAC_VALUE(n)				(((n) & 0x3FF) << 6)		// VALUE field of CR
+#define DAC_CNT_ENA					(1 << 2)					// CTRL bits
+#define DAC_DMA_ENA					(1 << 3)
+
+typedef struct {
+	uint8_t DBLBUF_ENA;
+	uint8_t CNT_ENA;
+	uint8_t DMA_ENA;
+	uint8_t RESERVED;
+} DAC_CONVERTER_CFG_Type;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void DAC_Init(LPC_DAC_TypeDef *DACx);
+void DAC_UpdateValue(LPC_DAC_TypeDef *DACx, uint32_t dac_value);
+void DAC_SetDMATimeOut(LPC_DAC_TypeDef *DACx, uint32_t time_out);
+void DAC_ConfigDAConverterControl(LPC_DAC_TypeDef *DACx, DAC_CONVERTER_CFG_Type *DAC_ConverterConfigStruct);
+
+#endif // LPC17XX_DAC_H
@@ -0,0 +1,85 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx_GPDMA.h
+ * @brief		Simulation: GPDMA driver, backed by SimDma.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_GPDMA_H
+#define LPC17XX_GPDMA_H
+
+// Includes
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define GPDMA_CONN_SSP0_Tx						0
+#define GPDMA_CONN_SSP0_Rx						1
+#define GPDMA_CONN_SSP1_Tx						2
+#define GPDMA_CONN_SSP1_Rx						3
+#define GPDMA_CONN_ADC							4
+#define GPDMA_CONN_DAC							7
+
+#define GPDMA_TRANSFERTYPE_M2M					0
+#define GPDMA_TRANSFERTYPE_M2P					1
+#define GPDMA_TRANSFERTYPE_P2M					2
+#define GPDMA_TRANSFERTYPE_P2P					3
+
+#define GPDMA_WIDTH_BYTE						0
+#define GPDMA_WIDTH_HALFWORD					1
+#define GPDMA_WIDTH_WORD						2
+
+#define GPDMA_DMACCxControl_TransferSize(n)		(((n) & 0xFFF) << 0)
+#define GPDMA_DMACCxControl_SBSize(n)			(((n) & 0x07) << 12)
+#define GPDMA_DMACCxControl_DBSize(n)			(((n) & 0x07) << 15)
+#define GPDMA_DMACCxControl_SWidth(n)			(((n) & 0x07) << 18)
+#define GPDMA_DMACCxControl_DWidth(n)			(((n) & 0x07) << 21)
+#define GPDMA_DMACCxControl_SI					(1UL << 26)
+#define GPDMA_DMACCxControl_DI					(1UL << 27)
+#define GPDMA_DMACCxControl_I					(1UL << 31)
+
+typedef enum {
+	GPDMA_STAT_INT,
+	GPDMA_STAT_INTTC,
+	GPDMA_STAT_INTERR,
+	GPDMA_STAT_RAWINTTC,
+	GPDMA_STAT_RAWINTERR,
+	GPDMA_STAT_ENABLED_CH
+} GPDMA_Status_Type;
+
+typedef enum {
+	GPDMA_STATCLR_INTTC,
+	GPDMA_STATCLR_INTERR
+} GPDMA_StateClear_Type;
+
+typedef struct {
+	uint32_t ChannelNum;
+	uint32_t TransferSize;
+	uint32_t TransferWidth;
+	uint32_t SrcMemAddr;
+	uint32_t DstMemAddr;
+	uint32_t TransferType;
+	uint32_t SrcConn;
+	uint32_t DstConn;
+	uint32_t DMALLI;
+} GPDMA_Channel_CFG_Type;
+
+typedef struct {
+	uint32_t SrcAddr;
+	uint32_t DstAddr;
+	uint32_t NextLLI;
+	uint32_t Control;
+} GPDMA_LLI_Type;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void GPDMA_Init(void);
+Status GPDMA_Setup(GPDMA_Channel_CFG_Type *GPDMAChannelConfig);
+void GPDMA_ChannelCmd(uint8_t channelNum, FunctionalState NewState);
+IntStatus GPDMA_IntGetStatus(GPDMA_Status_Type type, uint8_t channel);
+void GPDMA_ClearIntPending(GPDMA_StateClear_Type type, uint8_t channel);
+
+#endif // LPC17XX_GPDMA_H
@@ -0,0 +1,26 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx_GPIO.h
+ * @brief		Simulation: GPIO driver, backed by SimGpio.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_GPIO_H
+#define LPC17XX_GPIO_H
+
+// Includes
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void GPIO_SetDir(uint8_t portNum, uint32_t bitValue, uint8_t dir);
+void GPIO_SetValue(uint8_t portNum, uint32_t bitValue);
+void GPIO_ClearValue(uint8_t portNum, uint32_t bitValue);
+uint32_t GPIO_ReadValue(uint8_t portNum);
+void GPIO_IntCmd(uint8_t portNum, uint32_t bitValue, uint8_t edgeState);
+FunctionalState GPIO_GetIntStatus(uint8_t portNum, uint32_t pinNum, uint8_t edgeState);
+void GPIO_ClearInt(uint8_t portNum, uint32_t bitValue);
+
+#endif // LPC17XX_GPIO_H
@@ -0,0 +1,31 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx_PinSelect.h
+ * @brief		Simulation: pin function selection, which has nothing to do
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_PINSELECT_H
+#define LPC17XX_PINSELECT_H
+
+// Includes
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+typedef struct {
+	uint8_t Portnum;
+	uint8_t Pinnum;
+	uint8_t Funcnum;
+	uint8_t Pinmode;
+	uint8_t OpenDrain;
+} PINSEL_CFG_Type;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void PINSEL_ConfigPin(PINSEL_CFG_Type *PinCfg);
+
+#endif // LPC17XX_PINSELECT_H
@@ -0,0 +1,29 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx_SSP.h
+ * @brief		Simulation: SSP driver, backed by SimDma.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_SSP_H
+#define LPC17XX_SSP_H
+
+// Includes
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SSP_DMA_RX					(1 << 0)
+#define SSP_DMA_TX					(1 << 1)
+#define SSP_STAT_RXFIFO_NOTEMPTY	(1 << 2)
+#define SSP_STAT_BUSY				(1 << 4)
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void SSP_DMACmd(LPC_SSP_TypeDef *SSPx, uint32_t DMAMode, FunctionalState NewState);
+FlagStatus SSP_GetStatus(LPC_SSP_TypeDef *SSPx, uint32_t FlagType);
+
+#endif // LPC17XX_SSP_H
@@ -0,0 +1,60 @@
+/**************************************************************************//**
+ *
+ * @file		LPC17xx_Timer.h
+ * @brief		Simulation: timer driver, backed by SimBoard.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC17XX_TIMER_H
+#define LPC17XX_TIMER_H
+
+// Includes
+#include "LPC17xx.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define TIM_TIMER_MODE				0
+#define TIM_PRESCALE_TICKVAL		0			// PrescaleValue is in peripheral clock ticks
+#define TIM_PRESCALE_USVAL			1			// PrescaleValue is in microseconds
+#define TIM_EXTMATCH_NOTHING		0
+
+typedef enum {
+	TIM_MR0_INT = 0,
+	TIM_MR1_INT,
+	TIM_MR2_INT,
+	TIM_MR3_INT,
+	TIM_CR0_INT,
+	TIM_CR1_INT
+} TIM_INT_TYPE;
+
+typedef struct {
+	uint8_t PrescaleOption;
+	uint8_t Reserved[3];
+	uint32_t PrescaleValue;
+} TIM_TIMERCFG_Type;
+
+typedef struct {
+	uint8_t MatchChannel;
+	uint8_t IntOnMatch;
+	uint8_t StopOnMatch;
+	uint8_t ResetOnMatch;
+	uint8_t ExtMatchOutputType;
+	uint8_t Reserved[3];
+	uint32_t MatchValue;
+} TIM_MATCHCFG_Type;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void TIM_Init(LPC_TIM_TypeDef *TIMx, uint8_t TimerCounterMode, void *TIM_ConfigStruct);
+void TIM_DeInit(LPC_TIM_TypeDef *TIMx);
+void TIM_ConfigMatch(LPC_TIM_TypeDef *TIMx, TIM_MATCHCFG_Type *TIM_MatchConfigStruct);
+void TIM_UpdateMatchValue(LPC_TIM_TypeDef *TIMx, uint8_t MatchChannel, uint32_t MatchValue);
+void TIM_ResetCounter(LPC_TIM_TypeDef *TIMx);
+void TIM_Cmd(LPC_TIM_TypeDef *TIMx, FunctionalState NewState);
+FlagStatus TIM_GetIntStatus(LPC_TIM_TypeDef *TIMx, TIM_INT_TYPE IntFlag);
+void TIM_ClearIntPending(LPC_TIM_TypeDef *TIMx, TIM_INT_TYPE IntFlag);
+
+#endif // LPC17XX_TIMER_H
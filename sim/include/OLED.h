@@ -0,0 +1,28 @@
+/**************************************************************************//**
+ *
+ * @file		OLED.h
+ * @brief		Simulation: OLED driver, backed by the panel model in SimOled.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef OLED_H
+#define OLED_H
+
+// Includes
+#include "FreeRTOS_IO.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+typedef enum {
+	OLED_COLOR_BLACK,
+	OLED_COLOR_WHITE
+} oled_color_t;
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void OLED_Init(Peripheral_Descriptor_t SPIPort);
+
+#endif // OLED_H
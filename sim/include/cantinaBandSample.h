@@ -0,0 +1,21 @@
+/**************************************************************************//**
+ *
+ * @file		cantinaBandSample.h
+ * @brief		Simulation: the second song, from the 12 kHz clip in the repository
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef CANTINABANDSAMPLE_H
+#define CANTINABANDSAMPLE_H
+
+// Includes
+#include <stdint.h>
+#include "../../cantina_band_12kHz.h"
+
+//------------------------------------------------------------------------------
+
+// Local variables
+const uint32_t cantinaBandSampleLength = sizeof(cantinaBandSample);
+
+#endif // CANTINABANDSAMPLE_H
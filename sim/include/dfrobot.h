@@ -0,0 +1,36 @@
+/**************************************************************************//**
+ *
+ * @file		dfrobot.h
+ * @brief		Simulation: DFRobot chassis driver, backed by SimBoard.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef DFROBOT_H
+#define DFROBOT_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+void DFR_RobotInit(void);
+void DFR_IncGear(void);
+void DFR_DecGear(void);
+void DFR_DriveForward(uint8_t Speed);
+void DFR_DriveBackward(uint8_t Speed);
+void DFR_DriveLeft(uint8_t Speed);
+void DFR_DriveRight(uint8_t Speed);
+void DFR_DriveStop(void);
+void DFR_SetLeftWheelDestination(uint32_t Count);
+void DFR_SetRightWheelDestination(uint32_t Count);
+uint32_t DFR_GetLeftWheelDestination(void);
+uint32_t DFR_GetRightWheelDestination(void);
+void DFR_IncLeftWheelCount(void);
+void DFR_IncRightWheelCount(void);
+uint32_t DFR_GetLeftWheelCount(void);
+uint32_t DFR_GetRightWheelCount(void);
+void DFR_ClearWheelCounts(void);
+
+#endif // DFROBOT_H
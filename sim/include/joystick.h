@@ -0,0 +1,15 @@
+/**************************************************************************//**
+ *
+ * @file		joystick.h
+ * @brief		Simulation: joystick driver; the switches are plain GPIO in SimGpio.c
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef JOYSTICK_H
+#define JOYSTICK_H
+
+// Public Functions
+void joystick_init(void);
+
+#endif // JOYSTICK_H
@@ -0,0 +1,31 @@
+/**************************************************************************//**
+ *
+ * @file		lpc_types.h
+ * @brief		Simulation: the driver library's common types
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef LPC_TYPES_H
+#define LPC_TYPES_H
+
+// Includes
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, IntStatus, SetState;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} Status;
+
+#ifndef TRUE
+#define TRUE					1
+#endif
+#ifndef FALSE
+#define FALSE					0
+#endif
+
+#define __IO					volatile
+
+#endif // LPC_TYPES_H
@@ -0,0 +1,15 @@
+/**************************************************************************//**
+ *
+ * @file		pca9532.h
+ * @brief		Simulation: LED driver, which has nothing to drive
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef PCA9532_H
+#define PCA9532_H
+
+// Public Functions
+void pca9532_init(void);
+
+#endif // PCA9532_H
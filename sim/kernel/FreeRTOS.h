@@ -0,0 +1,69 @@
+/**************************************************************************//**
+ *
+ * @file		FreeRTOS.h
+ * @brief		Lockstep kernel: types and port macros
+ * @version		1.0
+ *
+ * The simulation's deterministic stand-in for the FreeRTOS kernel headers,
+ * covering the FreeRTOS 7 API the firmware uses. See SimKernel.c.
+ *
+******************************************************************************/
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+// Includes
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOSConfig.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+
+typedef struct SimKernel_Task* TaskHandle_t;
+typedef struct SimKernel_Queue* QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void *pvParameters);
+
+// The FreeRTOS 7 names the firmware uses
+#define portTickType				TickType_t
+#define portBASE_TYPE				BaseType_t
+#define portSTACK_TYPE				StackType_t
+#define xTaskHandle					TaskHandle_t
+#define xQueueHandle				QueueHandle_t
+#define xSemaphoreHandle			SemaphoreHandle_t
+#define pdTASK_CODE					TaskFunction_t
+
+#define pdFALSE						((BaseType_t)0)
+#define pdTRUE						((BaseType_t)1)
+#define pdFAIL						pdFALSE
+#define pdPASS						pdTRUE
+#define errQUEUE_EMPTY				pdFALSE
+#define errQUEUE_FULL				pdFALSE
+
+#define portMAX_DELAY				((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS			((TickType_t)1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS			portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(Ms)			((TickType_t)(((TickType_t)(Ms) * configTICK_RATE_HZ) / 1000))
+
+// Only one task runs at a time and ticks only happen between tasks, so there is nothing to mask
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskDISABLE_INTERRUPTS()
+#define taskENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+#define portSET_INTERRUPT_MASK_FROM_ISR()			0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(Mask)		(void)(Mask)
+
+// Handlers run on the SIM task, which is above every other; a woken task runs when it blocks
+#define portEND_SWITCHING_ISR(Switch)				(void)(Switch)
+#define portYIELD_FROM_ISR(Switch)					(void)(Switch)
+
+#endif // INC_FREERTOS_H
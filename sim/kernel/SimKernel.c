@@ -0,0 +1,494 @@
+/**************************************************************************//**
+ *
+ * @file		SimKernel.c
+ * @brief		Lockstep kernel: a deterministic stand-in for FreeRTOS
+ * @version		1.0
+ *
+ * Built in place of the FreeRTOS kernel and the POSIX port when a run has to
+ * come out the same every time, such as replaying an input trace. Each task
+ * is a thread, but only one runs at any time and control only passes
+ * between them here, in an order fixed by priority and by when each became
+ * ready.
+ *
+ * The tick does not come from a host timer. When every task is blocked, the
+ * thread that started the scheduler moves the tick on by one and readies
+ * whatever that wakes, so simulated time runs as fast as the host can run the
+ * tasks rather than in step with the wall clock. A task that never blocks
+ * stops time altogether; none of the firmware's do.
+ *
+ * Scheduling follows FreeRTOS: the highest priority ready task runs, and a
+ * task that readies a higher one gives way at once. Within a priority the
+ * task that has been ready longest goes first. There is no time slicing,
+ * since nothing runs while the tick moves.
+ *
+ * Until the tick moves, the scheduler thread stands in for the idle task. It
+ * calls vApplicationIdleHook once for every pass of the idle loop that
+ * SimKernel_IdleStep lets go by on the simulation's cycle counter, so
+ * IsrProfile_Idle sees the time every task spent blocked.
+ *
+******************************************************************************/
+
+// Includes
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define SIMKERNEL_TASKS			32
+
+typedef enum {
+	SIMKERNEL_READY,
+	SIMKERNEL_DELAYED,			// Until Wake
+	SIMKERNEL_BLOCKED			// On Queue, until Wake unless it waits forever
+} SimKernel_State_t;
+
+struct SimKernel_Task {
+	const char *Name;
+	UBaseType_t Priority;
+	SimKernel_State_t State;
+	uint64_t Ready;				// When it last became ready, for the order within a priority
+	TickType_t Wake;
+	uint8_t Forever;			// Blocked with portMAX_DELAY
+	struct SimKernel_Queue *Queue;
+	TaskFunction_t Code;
+	void *Parameters;
+	pthread_t Thread;
+	pthread_cond_t Turn;
+};
+
+struct SimKernel_Queue {
+	uint8_t *Items;
+	UBaseType_t Length;
+	UBaseType_t Size;			// 0 for a semaphore
+	UBaseType_t Count;
+	UBaseType_t Head;
+};
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static struct SimKernel_Task Tasks[SIMKERNEL_TASKS];
+static uint8_t TaskCount = 0;
+static struct SimKernel_Task *Running = 0;		// 0 while every task is blocked
+static uint8_t Started = 0;
+static uint64_t ReadySequence = 0;
+static TickType_t Ticks = 0;
+
+static pthread_mutex_t Lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t Idle = PTHREAD_COND_INITIALIZER;
+
+// The simulation's cycle counter, if it has one, and the firmware's idle hook
+uint8_t SimKernel_IdleStep(void) __attribute__((weak));
+#if (configUSE_IDLE_HOOK == 1)
+void vApplicationIdleHook(void);
+#endif
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static void SimKernel_MakeReady(struct SimKernel_Task *Task)
+{
+	Task->State = SIMKERNEL_READY;
+	Task->Queue = 0;
+	Task->Ready = ++ReadySequence;
+}
+
+// The task that should run now, or 0 if none can
+static struct SimKernel_Task* SimKernel_Next(void)
+{
+	struct SimKernel_Task *Best = 0;
+	uint8_t i;
+
+	for (i = 0; i < TaskCount; ++i)
+	{
+		if (Tasks[i].State != SIMKERNEL_READY)
+			continue;
+		if ((Best == 0) || (Tasks[i].Priority > Best->Priority) || ((Tasks[i].Priority == Best->Priority) && (Tasks[i].Ready < Best->Ready)))
+			Best = &Tasks[i];
+	}
+	return Best;
+}
+
+// Hand the lock to whichever task should run, and wait until it is the
+// caller's turn again
+static void SimKernel_Switch(void)
+{
+	struct SimKernel_Task *Self = Running;
+	struct SimKernel_Task *Next = SimKernel_Next();
+
+	if (Next == Self)
+		return;
+
+	Running = Next;
+	if (Next != 0)
+		pthread_cond_signal(&Next->Turn);
+	else
+		pthread_cond_signal(&Idle);
+
+	while (Running != Self)
+		pthread_cond_wait(&Self->Turn, &Lock);
+}
+
+// Give way if something above the caller has become ready
+static void SimKernel_Preempt(void)
+{
+	struct SimKernel_Task *Next = SimKernel_Next();
+
+	if ((Running != 0) && (Next != 0) && (Next->Priority > Running->Priority))
+		SimKernel_Switch();
+}
+
+// Ready every task blocked on Queue, to try again. Returns pdTRUE if one is
+// above the running task.
+static BaseType_t SimKernel_Unblock(struct SimKernel_Queue *Queue)
+{
+	BaseType_t Higher = pdFALSE;
+	uint8_t i;
+
+	for (i = 0; i < TaskCount; ++i)
+	{
+		if ((Tasks[i].State == SIMKERNEL_BLOCKED) && (Tasks[i].Queue == Queue))
+		{
+			SimKernel_MakeReady(&Tasks[i]);
+			if ((Running != 0) && (Tasks[i].Priority > Running->Priority))
+				Higher = pdTRUE;
+		}
+	}
+	return Higher;
+}
+
+static BaseType_t SimKernel_Put(struct SimKernel_Queue *Queue, const void *Item)
+{
+	if (Queue->Count == Queue->Length)
+		return pdFALSE;
+
+	if (Queue->Size != 0)
+		memcpy(&Queue->Items[((Queue->Head + Queue->Count) % Queue->Length) * Queue->Size], Item, Queue->Size);
+	++Queue->Count;
+	return pdTRUE;
+}
+
+static BaseType_t SimKernel_Get(struct SimKernel_Queue *Queue, void *Item, uint8_t Remove)
+{
+	if (Queue->Count == 0)
+		return pdFALSE;
+
+	if ((Queue->Size != 0) && (Item != 0))
+		memcpy(Item, &Queue->Items[Queue->Head * Queue->Size], Queue->Size);
+	if (Remove)
+	{
+		Queue->Head = (Queue->Head + 1) % Queue->Length;
+		--Queue->Count;
+	}
+	return pdTRUE;
+}
+
+// Block the running task on Queue for up to Wait ticks. Returns pdFALSE if the
+// time ran out.
+static BaseType_t SimKernel_Block(struct SimKernel_Queue *Queue, TickType_t Wait, uint8_t *Blocked, TickType_t *Until)
+{
+	if (!*Blocked)
+	{
+		*Blocked = 1;
+		*Until = Ticks + Wait;
+	}
+	else if ((Wait != portMAX_DELAY) && ((int32_t)(Ticks - *Until) >= 0))
+	{
+		return pdFALSE;
+	}
+
+	Running->State = SIMKERNEL_BLOCKED;
+	Running->Queue = Queue;
+	Running->Wake = *Until;
+	Running->Forever = (Wait == portMAX_DELAY);
+	SimKernel_Switch();
+	return pdTRUE;
+}
+
+static BaseType_t SimKernel_Transfer(struct SimKernel_Queue *Queue, void *Item, TickType_t Wait, uint8_t Send, uint8_t Remove)
+{
+	uint8_t Waiting = 0;
+	TickType_t Until = 0;
+	BaseType_t Done;
+
+	pthread_mutex_lock(&Lock);
+	for (;;)
+	{
+		Done = Send ? SimKernel_Put(Queue, Item) : SimKernel_Get(Queue, Item, Remove);
+		if (Done)
+		{
+			if (Send || Remove)
+				SimKernel_Unblock(Queue);
+			SimKernel_Preempt();
+			break;
+		}
+		if ((Wait == 0) || (Running == 0) || !SimKernel_Block(Queue, Wait, &Waiting, &Until))
+			break;
+	}
+	pthread_mutex_unlock(&Lock);
+	return Done;
+}
+
+static BaseType_t SimKernel_TransferFromISR(struct SimKernel_Queue *Queue, void *Item, uint8_t Send, BaseType_t *Woken)
+{
+	BaseType_t Done;
+	BaseType_t Higher = pdFALSE;
+
+	// Never gives way: the handler's task carries on until it blocks
+	pthread_mutex_lock(&Lock);
+	Done = Send ? SimKernel_Put(Queue, Item) : SimKernel_Get(Queue, Item, 1);
+	if (Done)
+		Higher = SimKernel_Unblock(Queue);
+	pthread_mutex_unlock(&Lock);
+
+	if ((Woken != 0) && Higher)
+		*Woken = pdTRUE;
+	return Done;
+}
+
+static void* SimKernel_Run(void *Parameter)
+{
+	struct SimKernel_Task *Self = (struct SimKernel_Task*)Parameter;
+
+	pthread_mutex_lock(&Lock);
+	while (Running != Self)
+		pthread_cond_wait(&Self->Turn, &Lock);
+	pthread_mutex_unlock(&Lock);
+
+	Self->Code(Self->Parameters);
+
+	fprintf(stderr, "Task %s returned\n", Self->Name);
+	exit(1);
+	return 0;
+}
+
+// Every task is blocked: go round the idle loop until the tick is due. With no
+// cycle counter to move, that is one pass.
+static void SimKernel_Idle(void)
+{
+	do
+	{
+#if (configUSE_IDLE_HOOK == 1)
+		vApplicationIdleHook();
+#endif
+	} while ((SimKernel_IdleStep != 0) && SimKernel_IdleStep());
+}
+
+// Move time on by a tick and ready whatever that wakes
+static void SimKernel_Tick(void)
+{
+	uint8_t i;
+
+	++Ticks;
+	for (i = 0; i < TaskCount; ++i)
+	{
+		if ((Tasks[i].State == SIMKERNEL_DELAYED) || ((Tasks[i].State == SIMKERNEL_BLOCKED) && !Tasks[i].Forever))
+		{
+			if ((int32_t)(Ticks - Tasks[i].Wake) >= 0)
+				SimKernel_MakeReady(&Tasks[i]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const signed char * const pcName, uint16_t usStackDepth,
+	void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+	struct SimKernel_Task *Task;
+
+	(void)usStackDepth;
+	pthread_mutex_lock(&Lock);
+	if (TaskCount == SIMKERNEL_TASKS)
+	{
+		pthread_mutex_unlock(&Lock);
+		return pdFAIL;
+	}
+
+	Task = &Tasks[TaskCount++];
+	Task->Name = (const char*)pcName;
+	Task->Priority = (uxPriority < configMAX_PRIORITIES) ? uxPriority : (configMAX_PRIORITIES - 1);
+	Task->Code = pvTaskCode;
+	Task->Parameters = pvParameters;
+	pthread_cond_init(&Task->Turn, 0);
+	SimKernel_MakeReady(Task);
+	if (pxCreatedTask != 0)
+		*pxCreatedTask = Task;
+
+	if (pthread_create(&Task->Thread, 0, SimKernel_Run, Task) != 0)
+	{
+		--TaskCount;
+		pthread_mutex_unlock(&Lock);
+		return pdFAIL;
+	}
+
+	if (Started)
+		SimKernel_Preempt();
+	pthread_mutex_unlock(&Lock);
+	return pdPASS;
+}
+
+// Runs the tasks until every one is blocked, then moves the tick on. Never returns.
+void vTaskStartScheduler(void)
+{
+	pthread_mutex_lock(&Lock);
+	Started = 1;
+
+	for (;;)
+	{
+		Running = SimKernel_Next();
+		if (Running != 0)
+		{
+			pthread_cond_signal(&Running->Turn);
+			while (Running != 0)
+				pthread_cond_wait(&Idle, &Lock);
+		}
+		SimKernel_Idle();
+		SimKernel_Tick();
+	}
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+	pthread_mutex_lock(&Lock);
+	if (xTicksToDelay == 0)
+	{
+		// Behind the others of the same priority
+		SimKernel_MakeReady(Running);
+	}
+	else
+	{
+		Running->State = SIMKERNEL_DELAYED;
+		Running->Wake = Ticks + xTicksToDelay;
+	}
+	SimKernel_Switch();
+	pthread_mutex_unlock(&Lock);
+}
+
+void vTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+	pthread_mutex_lock(&Lock);
+	*pxPreviousWakeTime += xTimeIncrement;
+	if ((int32_t)(*pxPreviousWakeTime - Ticks) > 0)
+	{
+		Running->State = SIMKERNEL_DELAYED;
+		Running->Wake = *pxPreviousWakeTime;
+		SimKernel_Switch();
+	}
+	pthread_mutex_unlock(&Lock);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return Ticks;
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+	return Ticks;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return Running;
+}
+
+// Nothing else runs while a task does, so there is nothing to suspend
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+	return pdFALSE;
+}
+
+void taskYIELD(void)
+{
+	vTaskDelay(0);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+	struct SimKernel_Queue *Queue = calloc(1, sizeof(*Queue));
+
+	if (Queue == 0)
+		return 0;
+
+	Queue->Length = uxQueueLength;
+	Queue->Size = uxItemSize;
+	if (uxItemSize != 0)
+	{
+		Queue->Items = calloc(uxQueueLength, uxItemSize);
+		if (Queue->Items == 0)
+		{
+			free(Queue);
+			return 0;
+		}
+	}
+	return Queue;
+}
+
+SemaphoreHandle_t xQueueCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+	struct SimKernel_Queue *Queue = xQueueCreate(uxMaxCount, 0);
+
+	if (Queue != 0)
+		Queue->Count = uxInitialCount;
+	return Queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+	return SimKernel_Transfer(xQueue, (void*)pvItemToQueue, xTicksToWait, 1, 0);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	return SimKernel_TransferFromISR(xQueue, (void*)pvItemToQueue, 1, pxHigherPriorityTaskWoken);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+	return SimKernel_Transfer(xQueue, pvBuffer, xTicksToWait, 0, 1);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	return SimKernel_TransferFromISR(xQueue, pvBuffer, 0, pxHigherPriorityTaskWoken);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+	return SimKernel_Transfer(xQueue, pvBuffer, xTicksToWait, 0, 0);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+	return xQueue->Count;
+}
+
+UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t xQueue)
+{
+	return xQueue->Count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+	pthread_mutex_lock(&Lock);
+	xQueue->Count = 0;
+	xQueue->Head = 0;
+	SimKernel_Unblock(xQueue);
+	SimKernel_Preempt();
+	pthread_mutex_unlock(&Lock);
+	return pdPASS;
+}
@@ -0,0 +1,31 @@
+/**************************************************************************//**
+ *
+ * @file		queue.h
+ * @brief		Lockstep kernel: queues
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef INC_QUEUE_H
+#define INC_QUEUE_H
+
+// Includes
+#include "FreeRTOS.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait);
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t xQueue);
+BaseType_t xQueueReset(QueueHandle_t xQueue);
+
+#define xQueueSendToBack(Queue, Item, Wait)				xQueueSend((Queue), (Item), (Wait))
+#define xQueueSendToBackFromISR(Queue, Item, Woken)		xQueueSendFromISR((Queue), (Item), (Woken))
+
+#endif // INC_QUEUE_H
@@ -0,0 +1,30 @@
+/**************************************************************************//**
+ *
+ * @file		semphr.h
+ * @brief		Lockstep kernel: semaphores, which are queues of empty items
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef INC_SEMPHR_H
+#define INC_SEMPHR_H
+
+// Includes
+#include "queue.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+SemaphoreHandle_t xQueueCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+
+// As in FreeRTOS 7, a binary semaphore starts out given
+#define vSemaphoreCreateBinary(Semaphore)				((Semaphore) = xQueueCreateCounting(1, 1))
+#define xSemaphoreCreateBinary()						xQueueCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()							xQueueCreateCounting(1, 1)
+#define xSemaphoreCreateCounting(Max, Initial)			xQueueCreateCounting((Max), (Initial))
+#define xSemaphoreTake(Semaphore, Wait)					xQueueReceive((Semaphore), NULL, (Wait))
+#define xSemaphoreTakeFromISR(Semaphore, Woken)			xQueueReceiveFromISR((Semaphore), NULL, (Woken))
+#define xSemaphoreGive(Semaphore)						xQueueSend((Semaphore), NULL, 0)
+#define xSemaphoreGiveFromISR(Semaphore, Woken)			xQueueSendFromISR((Semaphore), NULL, (Woken))
+
+#endif // INC_SEMPHR_H
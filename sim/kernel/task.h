@@ -0,0 +1,35 @@
+/**************************************************************************//**
+ *
+ * @file		task.h
+ * @brief		Lockstep kernel: tasks and time
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+// Includes
+#include "FreeRTOS.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const signed char * const pcName, uint16_t usStackDepth,
+	void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask);
+void vTaskStartScheduler(void);
+void vTaskDelay(TickType_t xTicksToDelay);
+void vTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+void taskYIELD(void);
+
+// Supplied by the simulation, if it keeps a cycle counter: move it on by one
+// pass of the idle task's loop. Returns 0, without moving it, once the next
+// tick is due.
+uint8_t SimKernel_IdleStep(void);
+
+#endif // INC_TASK_H
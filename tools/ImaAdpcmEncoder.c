@@ -0,0 +1,156 @@
+/**************************************************************************//**
+ *
+ * @file		ImaAdpcmEncoder.c
+ * @brief		Host-side IMA-ADPCM encoder matching the firmware decoder
+ * @version		1.0
+ *
+ * Every candidate code is run through ImaAdpcm_Step, the decoder's own
+ * update, and the one landing nearest the input is kept. That costs nothing
+ * that matters on the host and keeps encoder and decoder in lock step.
+ *
+******************************************************************************/
+
+// Includes
+#include <stdlib.h>
+#include <string.h>
+
+#include "ImaAdpcmEncoder.h"
+#include "WavTool.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define IMAADPCMENCODER_FMT_SIZE		20		// PCM fields, cbSize and wSamplesPerBlock
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static uint8_t BestCode(int16_t Predictor, int8_t StepIndex, int16_t Target)
+{
+	uint8_t Code;
+	uint8_t Best = 0;
+	int32_t BestError = 0x7FFFFFFF;
+
+	for (Code = 0; Code < 16; ++Code)
+	{
+		int16_t TrialPredictor = Predictor;
+		int8_t TrialIndex = StepIndex;
+		int32_t Error = (int32_t)ImaAdpcm_Step(&TrialPredictor, &TrialIndex, Code) - Target;
+
+		if (Error < 0)
+			Error = -Error;
+		if (Error < BestError)
+		{
+			BestError = Error;
+			Best = Code;
+		}
+	}
+	return Best;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+// Bytes needed for Count samples, the last block cut short to what it holds
+uint32_t ImaAdpcmEncoder_Size(uint32_t Count, uint16_t BlockAlign)
+{
+	uint32_t PerBlock = IMAADPCM_SAMPLES_PER_BLOCK(BlockAlign);
+	uint32_t Full = Count / PerBlock;
+	uint32_t Rest = Count % PerBlock;
+	uint32_t Size = Full * BlockAlign;
+
+	if (Rest != 0)
+		Size += IMAADPCM_HEADER_SIZE + ((Rest - 1) / 2);
+	return Size;
+}
+
+uint32_t ImaAdpcmEncoder_Encode(const int16_t *Samples, uint32_t Count, uint16_t BlockAlign, uint8_t *Out)
+{
+	uint32_t PerBlock = IMAADPCM_SAMPLES_PER_BLOCK(BlockAlign);
+	uint32_t Written = 0;
+	uint32_t Start;
+	uint32_t i;
+	int16_t Predictor;
+	int8_t StepIndex = 0;
+
+	for (Start = 0; Start < Count; Start += PerBlock)
+	{
+		uint32_t InBlock = ((Count - Start) < PerBlock) ? (Count - Start) : PerBlock;
+		uint8_t *Block = Out + Written;
+
+		// The header carries the first sample verbatim
+		Predictor = Samples[Start];
+		WavTool_WriteU16(Block, (uint16_t)Predictor);
+		Block[2] = (uint8_t)StepIndex;
+		Block[3] = 0;
+
+		// A short final block stops at the last whole byte, as ImaAdpcmEncoder_Size expects
+		if (InBlock < PerBlock)
+			InBlock = 1 + (((InBlock - 1) / 2) * 2);
+		memset(Block + IMAADPCM_HEADER_SIZE, 0, (InBlock - 1) / 2);
+
+		for (i = 1; i < InBlock; ++i)
+		{
+			uint8_t Code = BestCode(Predictor, StepIndex, Samples[Start + i]);
+
+			ImaAdpcm_Step(&Predictor, &StepIndex, Code);
+			if (i & 1)
+				Block[IMAADPCM_HEADER_SIZE + ((i - 1) >> 1)] |= Code;
+			else
+				Block[IMAADPCM_HEADER_SIZE + ((i - 1) >> 1)] |= (uint8_t)(Code << 4);
+		}
+
+		Written += IMAADPCM_HEADER_SIZE + ((InBlock - 1) / 2);
+	}
+
+	return Written;
+}
+
+// Wrap encoded samples in a RIFF/WAVE image (fmt, fact, data) the player can parse
+uint8_t* ImaAdpcmEncoder_BuildWav(const int16_t *Samples, uint32_t Count, uint32_t SampleRate, uint16_t BlockAlign, uint32_t *Length)
+{
+	uint32_t DataSize = ImaAdpcmEncoder_Size(Count, BlockAlign);
+	uint32_t HeaderSize = 12 + (8 + IMAADPCMENCODER_FMT_SIZE) + (8 + 4) + 8;
+	uint32_t Total = HeaderSize + DataSize + (DataSize & 1);
+	uint16_t PerBlock = (uint16_t)IMAADPCM_SAMPLES_PER_BLOCK(BlockAlign);
+	uint8_t *Wav = calloc(1, Total);
+	uint8_t *p = Wav;
+
+	if (Wav == NULL)
+		return NULL;
+
+	// RIFF header
+	memcpy(p, "RIFF", 4);
+	WavTool_WriteU32(p + 4, Total - 8);
+	memcpy(p + 8, "WAVE", 4);
+	p += 12;
+
+	// Format chunk
+	memcpy(p, "fmt ", 4);
+	WavTool_WriteU32(p + 4, IMAADPCMENCODER_FMT_SIZE);
+	WavTool_WriteU16(p + 8, WAVFORMAT_IMA_ADPCM);
+	WavTool_WriteU16(p + 10, 1);
+	WavTool_WriteU32(p + 12, SampleRate);
+	WavTool_WriteU32(p + 16, (uint32_t)(((uint64_t)SampleRate * BlockAlign) / PerBlock));
+	WavTool_WriteU16(p + 20, BlockAlign);
+	WavTool_WriteU16(p + 22, 4);
+	WavTool_WriteU16(p + 24, 2);
+	WavTool_WriteU16(p + 26, PerBlock);
+	p += 8 + IMAADPCMENCODER_FMT_SIZE;
+
+	// Total sample count, as the last block may be short
+	memcpy(p, "fact", 4);
+	WavTool_WriteU32(p + 4, 4);
+	WavTool_WriteU32(p + 8, Count);
+	p += 12;
+
+	// Data chunk
+	memcpy(p, "data", 4);
+	WavTool_WriteU32(p + 4, DataSize);
+	p += 8;
+
+	ImaAdpcmEncoder_Encode(Samples, Count, BlockAlign, p);
+
+	*Length = Total;
+	return Wav;
+}
@@ -0,0 +1,29 @@
+/**************************************************************************//**
+ *
+ * @file		ImaAdpcmEncoder.h
+ * @brief		Host-side IMA-ADPCM encoder matching the firmware decoder
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef IMAADPCMENCODER_H
+#define IMAADPCMENCODER_H
+
+// Includes
+#include <stdint.h>
+
+#include "../ImaAdpcm.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define IMAADPCMENCODER_BLOCK_ALIGN		256		// 505 samples per block
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+uint32_t ImaAdpcmEncoder_Size(uint32_t Count, uint16_t BlockAlign);
+uint32_t ImaAdpcmEncoder_Encode(const int16_t *Samples, uint32_t Count, uint16_t BlockAlign, uint8_t *Out);
+uint8_t* ImaAdpcmEncoder_BuildWav(const int16_t *Samples, uint32_t Count, uint32_t SampleRate, uint16_t BlockAlign, uint32_t *Length);
+
+#endif // IMAADPCMENCODER_H
@@ -0,0 +1,127 @@
+/**************************************************************************//**
+ *
+ * @file		WavTool.c
+ * @brief		Shared helpers for the host-side asset tools
+ * @version		1.0
+ *
+ * Reading uses the same WavFormat_Parse as the firmware, so anything the
+ * tools accept is laid out the way the player expects.
+ *
+******************************************************************************/
+
+// Includes
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "WavTool.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+// Read a whole file into a malloc'd buffer
+uint8_t* WavTool_ReadFile(const char *Path, uint32_t *Length)
+{
+	FILE *File = fopen(Path, "rb");
+	uint8_t *Bytes;
+	long Size;
+
+	if (File == NULL)
+		return NULL;
+
+	fseek(File, 0, SEEK_END);
+	Size = ftell(File);
+	fseek(File, 0, SEEK_SET);
+
+	Bytes = (Size > 0) ? malloc((size_t)Size) : NULL;
+	if ((Bytes == NULL) || (fread(Bytes, 1, (size_t)Size, File) != (size_t)Size))
+	{
+		free(Bytes);
+		fclose(File);
+		return NULL;
+	}
+
+	fclose(File);
+	*Length = (uint32_t)Size;
+	return Bytes;
+}
+
+// Mix every frame of a PCM asset down to one signed 16-bit sample
+int16_t* WavTool_ToMono16(const WavFormat_Descriptor_t *Descriptor, uint32_t *Count)
+{
+	uint32_t Frames = Descriptor->DataLength / Descriptor->BlockAlign;
+	int16_t *Samples;
+	uint32_t i;
+	uint16_t Channel;
+
+	if (Descriptor->Format != WAVFORMAT_PCM)
+		return NULL;
+
+	Samples = malloc(((size_t)Frames + 1) * sizeof(int16_t));
+	if (Samples == NULL)
+		return NULL;
+
+	for (i = 0; i < Frames; ++i)
+	{
+		const uint8_t *Frame = Descriptor->Data + ((size_t)i * Descriptor->BlockAlign);
+		int32_t Sum = 0;
+
+		for (Channel = 0; Channel < Descriptor->Channels; ++Channel)
+		{
+			if (Descriptor->BitsPerSample == 8)
+				Sum += ((int32_t)Frame[Channel] - 128) * 256;
+			else
+				Sum += (int16_t)(Frame[Channel * 2] | (Frame[(Channel * 2) + 1] << 8));
+		}
+		Samples[i] = (int16_t)(Sum / Descriptor->Channels);
+	}
+
+	*Count = Frames;
+	return Samples;
+}
+
+void WavTool_WriteU16(uint8_t *Bytes, uint16_t Value)
+{
+	Bytes[0] = (uint8_t)Value;
+	Bytes[1] = (uint8_t)(Value >> 8);
+}
+
+void WavTool_WriteU32(uint8_t *Bytes, uint32_t Value)
+{
+	Bytes[0] = (uint8_t)Value;
+	Bytes[1] = (uint8_t)(Value >> 8);
+	Bytes[2] = (uint8_t)(Value >> 16);
+	Bytes[3] = (uint8_t)(Value >> 24);
+}
+
+// Emit a byte array in the layout of the existing sample headers
+void WavTool_WriteArray(FILE *File, const char *Name, const uint8_t *Bytes, uint32_t Length)
+{
+	uint32_t i;
+
+	fprintf(File, "const uint8_t %s[]={\n", Name);
+	for (i = 0; i < Length; ++i)
+	{
+		if ((i % 16) == 0)
+			fputc('\t', File);
+		fprintf(File, "%u,", Bytes[i]);
+		if (((i % 16) == 15) || (i == Length - 1))
+			fputc('\n', File);
+	}
+	fprintf(File, "};\n\n");
+	fprintf(File, "const uint32_t %sLength = sizeof(%s);\n", Name, Name);
+}
+
+// Turn "path/cantina band.wav" into a C identifier such as "cantina_band"
+void WavTool_NameFromPath(const char *Path, char *Name, size_t Size)
+{
+	const char *Start = strrchr(Path, '/');
+	size_t i = 0;
+
+	Start = (Start != NULL) ? Start + 1 : Path;
+	if (isdigit((unsigned char)*Start) && (i + 1 < Size))
+		Name[i++] = '_';
+	for (; (*Start != '\0') && (*Start != '.') && (i + 1 < Size); ++Start)
+		Name[i++] = isalnum((unsigned char)*Start) ? *Start : '_';
+	Name[i] = '\0';
+}
@@ -0,0 +1,28 @@
+/**************************************************************************//**
+ *
+ * @file		WavTool.h
+ * @brief		Shared helpers for the host-side asset tools
+ * @version		1.0
+ *
+******************************************************************************/
+
+#ifndef WAVTOOL_H
+#define WAVTOOL_H
+
+// Includes
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../WavFormat.h"
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+uint8_t* WavTool_ReadFile(const char *Path, uint32_t *Length);
+int16_t* WavTool_ToMono16(const WavFormat_Descriptor_t *Descriptor, uint32_t *Count);
+void WavTool_WriteU16(uint8_t *Bytes, uint16_t Value);
+void WavTool_WriteU32(uint8_t *Bytes, uint32_t Value);
+void WavTool_WriteArray(FILE *File, const char *Name, const uint8_t *Bytes, uint32_t Length);
+void WavTool_NameFromPath(const char *Path, char *Name, size_t Size);
+
+#endif // WAVTOOL_H
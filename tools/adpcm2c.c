@@ -0,0 +1,86 @@
+/**************************************************************************//**
+ *
+ * @file		adpcm2c.c
+ * @brief		Host tool: encode WAV files as IMA-ADPCM C arrays for WavPlayer
+ * @version		1.0
+ *
+ * Usage:	adpcm2c [-n name] input.wav output.h
+ *
+ * The input may be 8 or 16-bit PCM with any number of channels; it is mixed
+ * to mono and stored as 4-bit IMA-ADPCM at its own sample rate. The output
+ * header holds a RIFF/WAVE image that WavPlayer_Play accepts directly.
+ *
+ * Build:	gcc -O2 -o adpcm2c adpcm2c.c ImaAdpcmEncoder.c WavTool.c ../ImaAdpcm.c ../WavFormat.c
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ImaAdpcmEncoder.h"
+#include "WavTool.h"
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	WavFormat_Descriptor_t Descriptor;
+	char Name[64] = "";
+	uint8_t *Input;
+	uint8_t *Output;
+	int16_t *Samples;
+	uint32_t InputLength;
+	uint32_t OutputLength;
+	uint32_t Count;
+	FILE *File;
+	int Arg = 1;
+
+	if ((argc > 2) && (strcmp(argv[1], "-n") == 0))
+	{
+		strncpy(Name, argv[2], sizeof(Name) - 1);
+		Arg = 3;
+	}
+	if (argc - Arg != 2)
+	{
+		fprintf(stderr, "usage: %s [-n name] input.wav output.h\n", argv[0]);
+		return 1;
+	}
+	if (Name[0] == '\0')
+		WavTool_NameFromPath(argv[Arg], Name, sizeof(Name));
+
+	Input = WavTool_ReadFile(argv[Arg], &InputLength);
+	if ((Input == NULL) || !WavFormat_Parse(Input, InputLength, &Descriptor))
+	{
+		fprintf(stderr, "%s: not a readable WAV file\n", argv[Arg]);
+		return 1;
+	}
+
+	Samples = WavTool_ToMono16(&Descriptor, &Count);
+	if ((Samples == NULL) || (Count == 0))
+	{
+		fprintf(stderr, "%s: only non-empty PCM input is supported\n", argv[Arg]);
+		return 1;
+	}
+
+	Output = ImaAdpcmEncoder_BuildWav(Samples, Count, Descriptor.SampleRate, IMAADPCMENCODER_BLOCK_ALIGN, &OutputLength);
+	File = fopen(argv[Arg + 1], "w");
+	if ((Output == NULL) || (File == NULL))
+	{
+		fprintf(stderr, "%s: cannot write output\n", argv[Arg + 1]);
+		return 1;
+	}
+
+	fprintf(File, "/*\n*\n*  %s - IMA-ADPCM, mono, %u Hz\n*  %u samples in %u bytes (generated by tools/adpcm2c)\n*/\n\n",
+		Name, (unsigned)Descriptor.SampleRate, (unsigned)Count, (unsigned)OutputLength);
+	WavTool_WriteArray(File, Name, Output, OutputLength);
+	fclose(File);
+
+	printf("%s: %u samples, %u -> %u bytes\n", Name, (unsigned)Count, (unsigned)Descriptor.DataLength, (unsigned)OutputLength);
+
+	free(Output);
+	free(Samples);
+	free(Input);
+	return 0;
+}
@@ -0,0 +1,306 @@
+/**************************************************************************//**
+ *
+ * @file		audiobench.c
+ * @brief		Host tool: time the audio task's per-sample work
+ * @version		1.0
+ *
+ * Usage:	audiobench [seconds of audio]
+ *
+ * Encodes a test signal with the host encoder and times ImaAdpcm_Decode
+ * over it, decoding AUDIOMIXER_VOICE_BUFFER samples a call as the mixer's
+ * fill callbacks ask for them, and checks every sample comes back. Then it
+ * times AudioMixer_Mix, AUDIOMIXER_BLOCK samples a call, with none up to
+ * all AUDIOMIXER_VOICES voices playing 8-bit PCM, both at 12 kHz, so each
+ * is interpolated, and at the output rate. Last it times Synth_Fill for
+ * each of the oscillator's waveforms playing a looped arpeggio with its
+ * envelope running, again in fill-callback sized calls. Each result is given in
+ * nanoseconds per output sample and as a share of one 24 kHz output
+ * period, alongside a plain copy of the same number of 8-bit samples for
+ * scale.
+ *
+ * Cycles are estimated from a chain of dependent adds, one a cycle, timed
+ * first on x86 hosts. They are the host's cycles: it has caches, a branch
+ * predictor and several instructions a cycle, so the figures rank the work
+ * rather than predict the LPC1769's.
+ *
+ * Build:	gcc -O2 -o audiobench audiobench.c ImaAdpcmEncoder.c WavTool.c ../ImaAdpcm.c ../AudioMixer.c ../Synth.c ../WavFormat.c -lm
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "ImaAdpcmEncoder.h"
+#include "../ImaAdpcm.h"
+#include "../AudioMixer.h"
+#include "../Synth.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define AUDIOBENCH_SECONDS		10
+#define AUDIOBENCH_RATE			24000			// WAVPLAYER_OUTPUT_RATE
+#define AUDIOBENCH_MIN_TIME		0.25			// Seconds each figure is timed over, at least
+#define AUDIOBENCH_CALIBRATE	200000000UL		// Dependent adds timed to find the host clock
+
+//------------------------------------------------------------------------------
+
+typedef struct {
+	const uint8_t *Data;
+	uint32_t Length;
+	uint32_t Position;
+} AudioBench_Source_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static uint8_t Output[AUDIOMIXER_BLOCK];
+static volatile uint8_t Sink;					// Keeps the copy from being optimised away
+static double ClockHz = 0;						// Host clock, 0 if it could not be found
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static double AudioBench_Seconds(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (double)Now.tv_sec + ((double)Now.tv_nsec * 1e-9);
+}
+
+// Host cycles a second, from adds that each wait for the last
+static double AudioBench_Clock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	uint32_t Value = 0;
+	uint32_t i;
+	double Start = AudioBench_Seconds();
+
+	for (i = 0; i < AUDIOBENCH_CALIBRATE; ++i)
+		__asm__ volatile ("add $1, %0" : "+r" (Value));
+	return (double)AUDIOBENCH_CALIBRATE / (AudioBench_Seconds() - Start);
+#else
+	return 0;
+#endif
+}
+
+static void AudioBench_Print(const char *Name, double Seconds, double Samples)
+{
+	double Nanoseconds = (Seconds * 1e9) / Samples;
+
+	printf("%-24s %8.2f ns %8.1f %7.3f%%\n", Name, Nanoseconds, Nanoseconds * ClockHz * 1e-9, Nanoseconds * AUDIOBENCH_RATE * 1e-7);
+}
+
+// A sweep with a little noise, so the step index moves about as it would in music
+static int16_t *AudioBench_Signal(uint32_t Count)
+{
+	int16_t *Samples = malloc(Count * sizeof(int16_t));
+	double Phase = 0;
+	uint32_t Seed = 1;
+	uint32_t i;
+
+	for (i = 0; i < Count; ++i)
+	{
+		Phase += 2.0 * M_PI * (100.0 + (4000.0 * i / Count)) / AUDIOBENCH_RATE;
+		Seed = (Seed * 1103515245UL) + 12345UL;
+		Samples[i] = (int16_t)((12000.0 * sin(Phase)) + (double)(int32_t)((Seed >> 16) & 0x7FF) - 1024.0);
+	}
+	return Samples;
+}
+
+// Decode the whole of Data repeatedly for at least AUDIOBENCH_MIN_TIME
+static void AudioBench_Adpcm(const uint8_t *Data, uint32_t Length, uint32_t Count)
+{
+	ImaAdpcm_Decoder_t Decoder;
+	double Start = AudioBench_Seconds();
+	double Seconds;
+	double Samples = 0;
+	uint32_t Decoded;
+	uint32_t Got;
+
+	do
+	{
+		ImaAdpcm_Init(&Decoder, Data, Length, IMAADPCMENCODER_BLOCK_ALIGN);
+		Decoded = 0;
+		while ((Got = ImaAdpcm_Decode(&Decoder, Output, AUDIOMIXER_VOICE_BUFFER)) != 0)
+			Decoded += Got;
+		if (Decoded != Count)
+		{
+			fprintf(stderr, "Decoded %u samples of %u\n", (unsigned)Decoded, (unsigned)Count);
+			exit(1);
+		}
+		Samples += Decoded;
+		Seconds = AudioBench_Seconds() - Start;
+	} while (Seconds < AUDIOBENCH_MIN_TIME);
+
+	AudioBench_Print("IMA-ADPCM decode", Seconds, Samples);
+}
+
+// Copy Count 8-bit samples in callback-sized pieces, the least any fill can cost
+static void AudioBench_Copy(const uint8_t *Data, uint32_t Count)
+{
+	double Start = AudioBench_Seconds();
+	double Seconds;
+	double Samples = 0;
+	uint32_t i;
+
+	do
+	{
+		for (i = 0; i + AUDIOMIXER_VOICE_BUFFER <= Count; i += AUDIOMIXER_VOICE_BUFFER)
+		{
+			memcpy(Output, &Data[i], AUDIOMIXER_VOICE_BUFFER);
+			Sink ^= Output[0];
+		}
+		Samples += i;
+		Seconds = AudioBench_Seconds() - Start;
+	} while (Seconds < AUDIOBENCH_MIN_TIME);
+
+	AudioBench_Print("8-bit copy", Seconds, Samples);
+}
+
+// Mixer fill callback: the source's samples round and round, so a voice never ends
+static uint32_t AudioBench_Fill(void *Context, uint8_t *Samples, uint32_t Count)
+{
+	AudioBench_Source_t *Source = (AudioBench_Source_t *)Context;
+	uint32_t i;
+
+	for (i = 0; i < Count; ++i)
+	{
+		Samples[i] = Source->Data[Source->Position++];
+		if (Source->Position == Source->Length)
+			Source->Position = 0;
+	}
+	return Count;
+}
+
+// Run one oscillator through a looped tune for at least AUDIOBENCH_MIN_TIME
+static void AudioBench_Synth(uint8_t Waveform)
+{
+	static const char *Names[] = {"sine", "square", "saw", "triangle"};
+	// 60 ms ticks, a short attack and release around a decaying sustain, so every envelope stage is timed
+	uint8_t Tune[] = {0, 60, 2, 40, 160, 50, 72, 2, 76, 2, 79, 2, 84, 4, SYNTH_REST, 1, 60, 3, SYNTH_LOOP, 0};
+	Synth_t Synth;
+	double Start;
+	double Seconds;
+	double Samples = 0;
+	char Name[32];
+	uint32_t i;
+
+	Tune[0] = Waveform;
+	Synth_Init(&Synth, Tune, AUDIOBENCH_RATE);
+
+	Start = AudioBench_Seconds();
+	do
+	{
+		for (i = 0; i < 1000; ++i)
+		{
+			if (Synth_Fill(&Synth, Output, AUDIOMIXER_VOICE_BUFFER) != AUDIOMIXER_VOICE_BUFFER)
+			{
+				fprintf(stderr, "The %s tune ended\n", Names[Waveform]);
+				exit(1);
+			}
+			Sink ^= Output[0];
+		}
+		Samples += 1000.0 * AUDIOMIXER_VOICE_BUFFER;
+		Seconds = AudioBench_Seconds() - Start;
+	} while (Seconds < AUDIOBENCH_MIN_TIME);
+
+	snprintf(Name, sizeof(Name), "synth %s", Names[Waveform]);
+	AudioBench_Print(Name, Seconds, Samples);
+}
+
+// Mix Voices voices of Data at Rate for at least AUDIOBENCH_MIN_TIME
+static void AudioBench_Mix(const uint8_t *Data, uint32_t Count, uint8_t Voices, uint32_t Rate)
+{
+	static AudioMixer_t Mixer;
+	AudioBench_Source_t Sources[AUDIOMIXER_VOICES];
+	double Start;
+	double Seconds;
+	double Samples = 0;
+	char Name[32];
+	uint32_t i;
+	uint8_t v;
+
+	AudioMixer_Init(&Mixer, AUDIOBENCH_RATE);
+	for (v = 0; v < Voices; ++v)
+	{
+		// Each voice from a different place, so they do not all line up
+		Sources[v].Data = Data;
+		Sources[v].Length = Count;
+		Sources[v].Position = (Count / AUDIOMIXER_VOICES) * v;
+		AudioMixer_Start(&Mixer, v, AudioBench_Fill, &Sources[v], Rate, AUDIOMIXER_UNITY / 2);
+	}
+
+	Start = AudioBench_Seconds();
+	do
+	{
+		for (i = 0; i < 1000; ++i)
+			AudioMixer_Mix(&Mixer, Output, AUDIOMIXER_BLOCK);
+		Samples += 1000.0 * AUDIOMIXER_BLOCK;
+		Seconds = AudioBench_Seconds() - Start;
+	} while (Seconds < AUDIOBENCH_MIN_TIME);
+
+	if (AudioMixer_ActiveVoices(&Mixer) != Voices)
+	{
+		fprintf(stderr, "%u voices playing of %u\n", (unsigned)AudioMixer_ActiveVoices(&Mixer), (unsigned)Voices);
+		exit(1);
+	}
+
+	snprintf(Name, sizeof(Name), "mix %u at %u Hz", (unsigned)Voices, (unsigned)Rate);
+	AudioBench_Print(Name, Seconds, Samples);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+int main(int argc, char *argv[])
+{
+	uint32_t Seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 10) : AUDIOBENCH_SECONDS;
+	uint32_t Count;
+	uint32_t Length;
+	int16_t *Signal;
+	uint8_t *Encoded;
+	uint8_t *Pcm;
+	uint32_t i;
+	uint8_t v;
+
+	if ((Seconds == 0) || (Seconds > 600))
+	{
+		fprintf(stderr, "Usage: %s [seconds of audio, up to 600]\n", argv[0]);
+		return 2;
+	}
+
+	Count = Seconds * AUDIOBENCH_RATE;
+	Signal = AudioBench_Signal(Count);
+	Length = ImaAdpcmEncoder_Size(Count, IMAADPCMENCODER_BLOCK_ALIGN);
+	Encoded = malloc(Length);
+	ImaAdpcmEncoder_Encode(Signal, Count, IMAADPCMENCODER_BLOCK_ALIGN, Encoded);
+
+	ClockHz = AudioBench_Clock();
+	printf("Host clock about %.2f GHz; per sample, and the share of a %u Hz period\n", ClockHz * 1e-9, (unsigned)AUDIOBENCH_RATE);
+	printf("%-24s %11s %8s %8s\n", "", "time", "cycles", "period");
+	AudioBench_Copy((const uint8_t *)Signal, Count);
+	AudioBench_Adpcm(Encoded, Length, Count);
+
+	// The signal as the 8-bit samples a PCM voice plays
+	Pcm = malloc(Count);
+	for (i = 0; i < Count; ++i)
+		Pcm[i] = (uint8_t)((Signal[i] >> 8) + 128);
+	for (v = 0; v <= AUDIOMIXER_VOICES; ++v)
+		AudioBench_Mix(Pcm, Count, v, AUDIOBENCH_RATE / 2);
+	for (v = 1; v <= AUDIOMIXER_VOICES; ++v)
+		AudioBench_Mix(Pcm, Count, v, AUDIOBENCH_RATE);
+
+	for (v = SYNTH_SINE; v <= SYNTH_TRIANGLE; ++v)
+		AudioBench_Synth(v);
+
+	free(Pcm);
+	free(Encoded);
+	free(Signal);
+	return 0;
+}
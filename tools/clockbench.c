@@ -0,0 +1,115 @@
+/**************************************************************************//**
+ *
+ * @file		clockbench.c
+ * @brief		Host tool: check the rates SampleClock achieves
+ * @version		1.0
+ *
+ * Usage:	clockbench [seconds] [peripheral clock Hz]
+ *
+ * Runs SampleClock for the given number of seconds of output at 8, 12,
+ * 22.05 and 24 kHz, both one sample at a time as the Timer0 path asks for
+ * them and a DMA block at a time as the DMA path does, and prints the rate
+ * the periods add up to and its error in parts per million. The truncated
+ * fixed period the player used before SampleClock is shown for comparison,
+ * with the furthest the output drifts from the ideal sample times.
+ *
+ * The peripheral clock defaults to the board's 25 MHz (100 MHz CCLK / 4, as
+ * after reset). Nothing here depends on the host, so the figures are the
+ * board's.
+ *
+ * Build:	gcc -O2 -o clockbench clockbench.c ../SampleClock.c
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "../SampleClock.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define CLOCKBENCH_SECONDS		60
+#define CLOCKBENCH_PCLK_HZ		25000000UL
+#define CLOCKBENCH_DMA_BLOCK	256				// WAVPLAYER_DMA_BLOCK
+
+typedef struct {
+	double Rate;								// Samples per second achieved
+	double Ppm;									// Error against the rate asked for
+	double Drift;								// Furthest from the ideal sample times, in samples
+} ClockBench_Result_t;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Step through Seconds of output, Block samples at a time, with SampleClock or with the truncated period
+static void ClockBench_Run(uint32_t ClockHz, uint32_t Rate, uint32_t Block, uint32_t Seconds, uint8_t Fixed, ClockBench_Result_t *Result)
+{
+	SampleClock_t Clock;
+	uint64_t Samples = 0;
+	uint64_t Cycles = 0;
+	uint64_t Total = (uint64_t)Rate * Seconds;
+	double Drift;
+
+	SampleClock_Init(&Clock, ClockHz, Rate);
+	Result->Drift = 0;
+	while (Samples < Total)
+	{
+		Cycles += (uint64_t)Block * (Fixed ? Clock.Period : SampleClock_Next(&Clock, Block));
+		Samples += Block;
+
+		// Samples that should have been played by now, less those that were
+		Drift = ((double)Cycles * (double)Rate / (double)ClockHz) - (double)Samples;
+		if (Drift < 0)
+			Drift = -Drift;
+		if (Drift > Result->Drift)
+			Result->Drift = Drift;
+	}
+
+	Result->Rate = (double)Samples * (double)ClockHz / (double)Cycles;
+	Result->Ppm = (Result->Rate - (double)Rate) * 1e6 / (double)Rate;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+int main(int argc, char *argv[])
+{
+	// Of these only 8 kHz divides 25 MHz into whole periods
+	static const uint32_t Rates[] = {8000, 12000, 22050, 24000};
+	uint32_t Seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 10) : CLOCKBENCH_SECONDS;
+	uint32_t ClockHz = (argc > 2) ? (uint32_t)strtoul(argv[2], 0, 10) : CLOCKBENCH_PCLK_HZ;
+	ClockBench_Result_t Sample;
+	ClockBench_Result_t Block;
+	ClockBench_Result_t Fixed;
+	uint32_t i;
+
+	if ((Seconds == 0) || (ClockHz < 1000000UL))
+	{
+		fprintf(stderr, "Usage: %s [seconds] [peripheral clock Hz, at least 1000000]\n", argv[0]);
+		return 2;
+	}
+
+	printf("%u s at a %u Hz peripheral clock\n", (unsigned)Seconds, (unsigned)ClockHz);
+	printf("%-8s %14s %9s %14s %9s %14s %9s %9s\n", "rate", "per sample", "ppm", "per block", "ppm", "fixed", "ppm", "drift");
+	for (i = 0; i < sizeof(Rates) / sizeof(Rates[0]); ++i)
+	{
+		ClockBench_Run(ClockHz, Rates[i], 1, Seconds, 0, &Sample);
+		ClockBench_Run(ClockHz, Rates[i], CLOCKBENCH_DMA_BLOCK, Seconds, 0, &Block);
+		ClockBench_Run(ClockHz, Rates[i], 1, Seconds, 1, &Fixed);
+
+		printf("%-8u %14.6f %9.3f %14.6f %9.3f %14.6f %9.3f %9.1f\n", (unsigned)Rates[i], Sample.Rate, Sample.Ppm,
+			Block.Rate, Block.Ppm, Fixed.Rate, Fixed.Ppm, Fixed.Drift);
+
+		// The phase error is held within half a period, so the sample times never drift
+		if ((Sample.Drift > 1.0) || (Block.Drift > 1.0))
+		{
+			fprintf(stderr, "%u Hz drifted %.2f samples one at a time, %.2f a block at a time\n", (unsigned)Rates[i], Sample.Drift, Block.Drift);
+			return 1;
+		}
+	}
+	return 0;
+}
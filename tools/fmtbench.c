@@ -0,0 +1,207 @@
+/**************************************************************************//**
+ *
+ * @file		fmtbench.c
+ * @brief		Host tool: compare Fmt against sprintf for time and stack
+ * @version		1.0
+ *
+ * Usage:	fmtbench [iterations]
+ *
+ * Builds the three lines the firmware formats (the uptime clock, the grid
+ * coordinates and an interrupt load figure) with both Fmt and the C
+ * library's sprintf, checks they agree, and prints the time per line and the
+ * deepest stack each one reached. Stack depth is found by running the
+ * formatter on a thread whose stack was first filled with a pattern, and
+ * seeing how much of the pattern was overwritten.
+ *
+ * The host library is glibc rather than newlib, and the times are for the
+ * host CPU, so the figures are for comparing the two, not for the board.
+ *
+ * Build:	gcc -O2 -o fmtbench fmtbench.c ../Fmt.c -lpthread
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "../Fmt.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define FMTBENCH_ITERATIONS		5000000UL
+#define FMTBENCH_STACK_PROBE	65536			// Stack given to each measuring thread
+#define FMTBENCH_PATTERN		0xA5
+#define FMTBENCH_LINE			17
+
+typedef void (*FmtBench_Line_t)(char *Line, unsigned Seed);
+
+typedef struct {
+	const char *Name;
+	FmtBench_Line_t Fmt;
+	FmtBench_Line_t Printf;
+} FmtBench_Case_t;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static void Clock_Fmt(char *Line, unsigned Seed)
+{
+	char *Next = Fmt_Text(Line, "Time:  ", 0);
+
+	Next = Fmt_Unsigned(Next, (Seed / 3600) % 100, 2, '0');
+	*Next++ = ':';
+	Next = Fmt_Unsigned(Next, (Seed / 60) % 60, 2, '0');
+	*Next++ = ':';
+	Next = Fmt_Unsigned(Next, Seed % 60, 2, '0');
+	*Next = '\0';
+}
+
+static void Clock_Printf(char *Line, unsigned Seed)
+{
+	sprintf(Line, "Time:  %02u:%02u:%02u", (Seed / 3600) % 100, (Seed / 60) % 60, Seed % 60);
+}
+
+static void Grid_Fmt(char *Line, unsigned Seed)
+{
+	char *Next = Fmt_Text(Line, "X: ", 0);
+
+	Next = Fmt_Signed(Next, (int)(Seed % 200) - 100, 4);
+	Next = Fmt_Text(Next, "  Y: ", 0);
+	Next = Fmt_Signed(Next, (int)(Seed % 37) - 18, 4);
+	*Next = '\0';
+}
+
+static void Grid_Printf(char *Line, unsigned Seed)
+{
+	sprintf(Line, "X: %4d  Y: %4d", (int)(Seed % 200) - 100, (int)(Seed % 37) - 18);
+}
+
+static void Load_Fmt(char *Line, unsigned Seed)
+{
+	char *Next = Fmt_Text(Line, "EINT3", 6);
+
+	*Next++ = ' ';
+	Next = Fmt_Fixed(Next, (int)(Seed % 1000), 1, 5);
+	*Next++ = '%';
+	*Next = '\0';
+}
+
+static void Load_Printf(char *Line, unsigned Seed)
+{
+	sprintf(Line, "%-6s %3u.%u%%", "EINT3", (Seed % 1000) / 10, (Seed % 1000) % 10);
+}
+
+static const FmtBench_Case_t Cases[] = {
+	{"clock", Clock_Fmt, Clock_Printf},
+	{"grid", Grid_Fmt, Grid_Printf},
+	{"load", Load_Fmt, Load_Printf},
+};
+
+static double FmtBench_Seconds(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (double)Now.tv_sec + ((double)Now.tv_nsec * 1e-9);
+}
+
+static void FmtBench_Nothing(char *Line, unsigned Seed)
+{
+	(void)Line;
+	(void)Seed;
+}
+
+static void* FmtBench_Run(void *Parameter)
+{
+	FmtBench_Line_t Line = (FmtBench_Line_t)Parameter;
+	char Buffer[FMTBENCH_LINE + 16];
+	unsigned Seed;
+
+	for (Seed = 0; Seed < 1000; ++Seed)
+		Line(Buffer, Seed * 7919U);
+	return 0;
+}
+
+// Deepest stack reached running Line 1000 times on a thread of its own
+static size_t FmtBench_Depth(FmtBench_Line_t Line)
+{
+	unsigned char *Stack = malloc(FMTBENCH_STACK_PROBE);
+	pthread_attr_t Attributes;
+	pthread_t Thread;
+	size_t i;
+
+	// Stacks grow down, so the untouched pattern is left at the bottom
+	memset(Stack, FMTBENCH_PATTERN, FMTBENCH_STACK_PROBE);
+	pthread_attr_init(&Attributes);
+	pthread_attr_setstack(&Attributes, Stack, FMTBENCH_STACK_PROBE);
+	pthread_create(&Thread, &Attributes, FmtBench_Run, (void*)Line);
+	pthread_join(Thread, 0);
+	pthread_attr_destroy(&Attributes);
+
+	for (i = 0; (i < FMTBENCH_STACK_PROBE) && (Stack[i] == FMTBENCH_PATTERN); ++i)
+		;
+	free(Stack);
+	return FMTBENCH_STACK_PROBE - i;
+}
+
+// Stack used by Line itself, over what the thread needs anyway
+static size_t FmtBench_Stack(FmtBench_Line_t Line)
+{
+	return FmtBench_Depth(Line) - FmtBench_Depth(FmtBench_Nothing);
+}
+
+static double FmtBench_Time(FmtBench_Line_t Line, unsigned long Iterations)
+{
+	char Buffer[FMTBENCH_LINE + 16];
+	volatile char Sink = 0;
+	unsigned long i;
+	double Start = FmtBench_Seconds();
+
+	for (i = 0; i < Iterations; ++i)
+	{
+		Line(Buffer, (unsigned)i * 7919U);
+		Sink ^= Buffer[5];
+	}
+	(void)Sink;
+	return ((FmtBench_Seconds() - Start) * 1e9) / (double)Iterations;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+int main(int argc, char *argv[])
+{
+	unsigned long Iterations = (argc > 1) ? strtoul(argv[1], 0, 10) : FMTBENCH_ITERATIONS;
+	char Expected[FMTBENCH_LINE + 16];
+	char Actual[FMTBENCH_LINE + 16];
+	unsigned Seed;
+	size_t c;
+
+	// Both must produce the same text before their speed means anything
+	for (c = 0; c < sizeof(Cases) / sizeof(Cases[0]); ++c)
+	{
+		for (Seed = 0; Seed < 400000; Seed += 7)
+		{
+			Cases[c].Printf(Expected, Seed);
+			Cases[c].Fmt(Actual, Seed);
+			if (strcmp(Expected, Actual) != 0)
+			{
+				fprintf(stderr, "%s: \"%s\" from sprintf, \"%s\" from Fmt\n", Cases[c].Name, Expected, Actual);
+				return 1;
+			}
+		}
+	}
+
+	printf("%-6s %12s %12s %12s %12s\n", "line", "Fmt ns", "sprintf ns", "Fmt stack", "sprintf stack");
+	for (c = 0; c < sizeof(Cases) / sizeof(Cases[0]); ++c)
+	{
+		printf("%-6s %12.1f %12.1f %12zu %12zu\n", Cases[c].Name,
+			FmtBench_Time(Cases[c].Fmt, Iterations), FmtBench_Time(Cases[c].Printf, Iterations),
+			FmtBench_Stack(Cases[c].Fmt), FmtBench_Stack(Cases[c].Printf));
+	}
+	return 0;
+}
@@ -0,0 +1,221 @@
+/**************************************************************************//**
+ *
+ * @file		glyphbench.c
+ * @brief		Host tool: check and time Framebuffer's two glyph paths
+ * @version		1.0
+ *
+ * Usage:	glyphbench [glyphs]
+ *
+ * Framebuffer_Char copies a pre-rendered cell from Font5x7Cells for dark text
+ * on a page boundary and draws any other text column by column from Font5x7.
+ * This fills the display with every character both ways, flushes each to a
+ * copy of the controller's memory through a stand-in SPI driver, and checks
+ * the column path drew the exact inverse of the cells. Then it times each
+ * path over a full screen of text in millions of glyphs per second, both
+ * redrawing what is already there and changing every glyph, plus the column
+ * path off a page boundary, where each column spans two pages.
+ *
+ * The times are for the host CPU, so they are for comparing the paths, not
+ * for the board; there Display_Report's DrawCycles over CellsDrawn gives the
+ * cycles per glyph.
+ *
+ * Build:	gcc -O2 -I../sim/kernel -I../sim/include -I.. -o glyphbench glyphbench.c ../Framebuffer.c ../Font5x7.c
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_Semaphore.h"
+
+#include "OLED.h"
+#include "Spi.h"
+#include "Framebuffer.h"
+#include "Font5x7.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define GLYPHBENCH_GLYPHS		20000000UL
+#define GLYPHBENCH_COLUMNS		(FRAMEBUFFER_WIDTH / FRAMEBUFFER_CHAR_WIDTH)
+#define GLYPHBENCH_ROWS			(FRAMEBUFFER_HEIGHT / FRAMEBUFFER_CHAR_HEIGHT)
+#define GLYPHBENCH_SCREEN		(GLYPHBENCH_COLUMNS * GLYPHBENCH_ROWS)
+#define GLYPHBENCH_X_OFFSET		18				// FRAMEBUFFER_X_OFFSET
+
+typedef struct {
+	const char *Name;
+	uint8_t Y;									// Top row of the first line
+	uint8_t Foreground;
+	uint8_t Background;
+	uint8_t Change;								// Alternate two texts so every glyph differs
+} GlyphBench_Case_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static uint8_t Screen[FRAMEBUFFER_PAGES][FRAMEBUFFER_WIDTH];	// The controller's memory, as flushed
+static Spi_Client_t Client;
+static uint8_t Semaphore;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Stand-ins for the SPI driver and the kernel: a transfer lands in Screen at once
+Spi_Client_t* Spi_AddClient(const char *Name, uint8_t Priority, uint32_t ByteRate)
+{
+	Client.Name = Name;
+	Client.Priority = Priority;
+	Client.ByteRate = ByteRate;
+	return &Client;
+}
+
+uint8_t Spi_Transfer(Spi_Transaction_t *Transaction)
+{
+	uint8_t Page = Transaction->Command[0] & 0x0F;
+	uint8_t Column = (uint8_t)(((Transaction->Command[2] & 0x0F) << 4) | (Transaction->Command[1] & 0x0F)) - GLYPHBENCH_X_OFFSET;
+
+	if ((Page >= FRAMEBUFFER_PAGES) || (Column + Transaction->DataLength > FRAMEBUFFER_WIDTH))
+	{
+		fprintf(stderr, "Span of %u at page %u, column %u is off the display\n", (unsigned)Transaction->DataLength, (unsigned)Page,
+			(unsigned)Column);
+		exit(1);
+	}
+	memcpy(&Screen[Page][Column], Transaction->Data, Transaction->DataLength);
+	return 1;
+}
+
+SemaphoreHandle_t xQueueCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+	(void)uxMaxCount;
+	(void)uxInitialCount;
+	return (SemaphoreHandle_t)(void *)&Semaphore;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+	(void)xQueue;
+	(void)pvBuffer;
+	(void)xTicksToWait;
+	return 1;
+}
+
+static double GlyphBench_Seconds(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (double)Now.tv_sec + ((double)Now.tv_nsec * 1e-9);
+}
+
+// The character for one cell of a screenful; Text 0 and 1 differ in every cell
+static uint8_t GlyphBench_Character(uint32_t Cell, uint8_t Text)
+{
+	return (uint8_t)(FONT5X7_FIRST + ((Cell * 7 + Text * 48) % FONT5X7_COUNT));
+}
+
+// Draw one screenful of text, starting the lines at row Y, returning the glyphs that fitted
+static uint32_t GlyphBench_Screen(uint8_t Y, uint8_t Text, uint8_t Foreground, uint8_t Background)
+{
+	uint32_t Cell;
+	uint32_t Drawn = 0;
+
+	for (Cell = 0; Cell < GLYPHBENCH_SCREEN; ++Cell)
+	{
+		Drawn += Framebuffer_Char((uint8_t)((Cell % GLYPHBENCH_COLUMNS) * FRAMEBUFFER_CHAR_WIDTH),
+			(uint8_t)(Y + (Cell / GLYPHBENCH_COLUMNS) * FRAMEBUFFER_CHAR_HEIGHT), GlyphBench_Character(Cell, Text), Foreground,
+			Background);
+	}
+	return Drawn;
+}
+
+// Every character, in dark on light through the cells and light on dark
+// through the columns, must come out as exact inverses once flushed
+static uint8_t GlyphBench_Check(void)
+{
+	static uint8_t Cells[FRAMEBUFFER_PAGES][FRAMEBUFFER_WIDTH];
+	uint8_t Page;
+	uint8_t Column;
+	uint8_t Text;
+
+	for (Text = 0; Text < 2; ++Text)
+	{
+		Framebuffer_Clear(OLED_COLOR_WHITE);
+		GlyphBench_Screen(0, Text, OLED_COLOR_BLACK, OLED_COLOR_WHITE);
+		Framebuffer_Flush();
+		memcpy(Cells, Screen, sizeof(Screen));
+
+		Framebuffer_Clear(OLED_COLOR_BLACK);
+		GlyphBench_Screen(0, Text, OLED_COLOR_WHITE, OLED_COLOR_BLACK);
+		Framebuffer_Flush();
+
+		for (Page = 0; Page < FRAMEBUFFER_PAGES; ++Page)
+		{
+			for (Column = 0; Column < GLYPHBENCH_COLUMNS * FRAMEBUFFER_CHAR_WIDTH; ++Column)
+			{
+				if ((Cells[Page][Column] ^ Screen[Page][Column]) != 0xFF)
+				{
+					fprintf(stderr, "Page %u, column %u: cell 0x%02X, columns 0x%02X\n", (unsigned)Page, (unsigned)Column,
+						(unsigned)Cells[Page][Column], (unsigned)Screen[Page][Column]);
+					return 0;
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+int main(int argc, char *argv[])
+{
+	static const GlyphBench_Case_t Cases[] = {
+		{"cells, unchanged",		0, OLED_COLOR_BLACK, OLED_COLOR_WHITE, 0},
+		{"cells, changed",			0, OLED_COLOR_BLACK, OLED_COLOR_WHITE, 1},
+		{"columns, unchanged",		0, OLED_COLOR_WHITE, OLED_COLOR_BLACK, 0},
+		{"columns, changed",		0, OLED_COLOR_WHITE, OLED_COLOR_BLACK, 1},
+		{"off page, changed",		4, OLED_COLOR_BLACK, OLED_COLOR_WHITE, 1}
+	};
+	unsigned long Glyphs = (argc > 1) ? strtoul(argv[1], 0, 10) : GLYPHBENCH_GLYPHS;
+	unsigned long Screens;
+	unsigned long s;
+	unsigned long Drawn;
+	uint32_t i;
+	uint8_t Y;
+	double Start;
+
+	if (Glyphs < GLYPHBENCH_SCREEN)
+	{
+		fprintf(stderr, "Usage: %s [glyphs, at least %u]\n", argv[0], (unsigned)GLYPHBENCH_SCREEN);
+		return 2;
+	}
+
+	Framebuffer_Init();
+	if (!GlyphBench_Check())
+		return 1;
+
+	Screens = Glyphs / GLYPHBENCH_SCREEN;
+	printf("%-20s %10s %10s\n", "path", "ns/glyph", "Mglyph/s");
+	for (i = 0; i < sizeof(Cases) / sizeof(Cases[0]); ++i)
+	{
+		Y = Cases[i].Y;
+		Framebuffer_Clear(Cases[i].Background);
+		Framebuffer_Flush();
+
+		// Off a page boundary the last line does not fit, so those screens are a line short
+		Drawn = 0;
+		Start = GlyphBench_Seconds();
+		for (s = 0; s < Screens; ++s)
+			Drawn += GlyphBench_Screen(Y, (uint8_t)(Cases[i].Change ? (s & 1) : 0), Cases[i].Foreground, Cases[i].Background);
+		Start = GlyphBench_Seconds() - Start;
+
+		Framebuffer_Flush();
+		printf("%-20s %10.2f %10.1f\n", Cases[i].Name, (Start * 1e9) / (double)Drawn, (double)Drawn / (Start * 1e6));
+	}
+	return 0;
+}
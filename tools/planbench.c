@@ -0,0 +1,294 @@
+/**************************************************************************//**
+ *
+ * @file		planbench.c
+ * @brief		Host tool: check GridPlanner and time it against grid size
+ * @version		1.0
+ *
+ * Usage:	planbench [plans per size] [percent blocked]
+ *
+ * For each square map size up to GRIDPLANNER_MAX_WIDTH, makes random maps
+ * with the given share of cells blocked and plans between random open cells
+ * from a random heading. Every plan is driven through on the map to check it
+ * stays on open cells, ends at the target and costs what it says, and the
+ * first few at each size are checked against a plain Dijkstra search for
+ * being the cheapest. Then it prints the time per plan and how many search
+ * states each one took off the open list.
+ *
+ * The times are for the host CPU. The states taken are the same on the
+ * board, where the firmware keeps the cycles its last plan took in
+ * PlanCycles, so cycles per state from there scales these counts to the
+ * LPC1769.
+ *
+ * Build:	gcc -O2 -o planbench planbench.c ../GridPlanner.c
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../GridPlanner.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define PLANBENCH_PLANS			2000
+#define PLANBENCH_BLOCKED		20				// Percent of cells
+#define PLANBENCH_CHECKED		25				// Plans at each size checked against Dijkstra
+#define PLANBENCH_STATES		(GRIDPLANNER_MAX_WIDTH * GRIDPLANNER_MAX_HEIGHT * GRIDPLANNER_HEADINGS)
+#define PLANBENCH_FAR			0xFFFFFFFFUL
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static char Rows[GRIDPLANNER_MAX_HEIGHT][GRIDPLANNER_MAX_WIDTH + 1];
+static const char *RowPointers[GRIDPLANNER_MAX_HEIGHT];
+static uint32_t Seed = 12345;
+
+static const int StepX[GRIDPLANNER_HEADINGS] = {0, 1, 0, -1};
+static const int StepY[GRIDPLANNER_HEADINGS] = {1, 0, -1, 0};
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// A fixed generator, so every run plans the same maps
+static uint32_t PlanBench_Random(uint32_t Range)
+{
+	Seed = (Seed * 1103515245UL) + 12345UL;
+	return ((Seed >> 8) & 0xFFFFFF) % Range;
+}
+
+static double PlanBench_Seconds(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (double)Now.tv_sec + ((double)Now.tv_nsec * 1e-9);
+}
+
+static void PlanBench_Map(int Size, unsigned Percent)
+{
+	int Row;
+	int Column;
+
+	for (Row = 0; Row < Size; ++Row)
+	{
+		for (Column = 0; Column < Size; ++Column)
+			Rows[Row][Column] = (PlanBench_Random(100) < Percent) ? GRIDPLANNER_BLOCKED : '.';
+		Rows[Row][Size] = '\0';
+		RowPointers[Row] = Rows[Row];
+	}
+	GridPlanner_Load(RowPointers, (uint8_t)Size, (uint8_t)Size, 0, 0);
+}
+
+static void PlanBench_OpenCell(int Size, int *X, int *Y)
+{
+	do
+	{
+		*X = (int)PlanBench_Random((uint32_t)Size);
+		*Y = (int)PlanBench_Random((uint32_t)Size);
+	} while (GridPlanner_IsBlocked(*X, *Y));
+}
+
+// Drive Plan from the start, returning its cost, or PLANBENCH_FAR if it
+// leaves the open cells or does not end at the target
+static uint32_t PlanBench_Drive(const GridPlanner_Plan_t *Plan, int X, int Y, int Heading, int ToX, int ToY)
+{
+	uint32_t Cost = 0;
+	uint8_t s;
+	uint8_t c;
+	int Sign;
+
+	for (s = 0; s < Plan->Length; ++s)
+	{
+		switch (Plan->Steps[s].Action)
+		{
+			case GRIDPLANNER_FORWARD:
+			case GRIDPLANNER_BACKWARD:
+				Sign = (Plan->Steps[s].Action == GRIDPLANNER_FORWARD) ? 1 : -1;
+				for (c = 0; c < Plan->Steps[s].Count; ++c)
+				{
+					X += Sign * StepX[Heading];
+					Y += Sign * StepY[Heading];
+					if (GridPlanner_IsBlocked(X, Y))
+						return PLANBENCH_FAR;
+					Cost += GRIDPLANNER_MOVE_COST;
+				}
+				break;
+			case GRIDPLANNER_CLOCKWISE:
+				Heading = (Heading + 1) % GRIDPLANNER_HEADINGS;
+				Cost += GRIDPLANNER_TURN_COST;
+				break;
+			case GRIDPLANNER_ANTICLOCKWISE:
+				Heading = (Heading + 3) % GRIDPLANNER_HEADINGS;
+				Cost += GRIDPLANNER_TURN_COST;
+				break;
+			default:
+				return PLANBENCH_FAR;
+		}
+	}
+	return ((X == ToX) && (Y == ToY) && (Heading == Plan->Heading)) ? Cost : PLANBENCH_FAR;
+}
+
+// The cheapest cost by Dijkstra with a linear search for the next state, or PLANBENCH_FAR
+static uint32_t PlanBench_Cheapest(int Size, int X, int Y, int Heading, int ToX, int ToY)
+{
+	static uint32_t Cost[PLANBENCH_STATES];
+	static uint8_t Done[PLANBENCH_STATES];
+	int States = Size * Size * GRIDPLANNER_HEADINGS;
+	int Best;
+	int State;
+	int Next[4];
+	uint32_t Step[4];
+	int n;
+	int i;
+
+	for (i = 0; i < States; ++i)
+	{
+		Cost[i] = PLANBENCH_FAR;
+		Done[i] = 0;
+	}
+	Cost[(((Y * Size) + X) * GRIDPLANNER_HEADINGS) + Heading] = 0;
+
+	for (;;)
+	{
+		Best = -1;
+		for (i = 0; i < States; ++i)
+		{
+			if (!Done[i] && (Cost[i] != PLANBENCH_FAR) && ((Best < 0) || (Cost[i] < Cost[Best])))
+				Best = i;
+		}
+		if (Best < 0)
+			return PLANBENCH_FAR;
+
+		Done[Best] = 1;
+		Heading = Best % GRIDPLANNER_HEADINGS;
+		X = (Best / GRIDPLANNER_HEADINGS) % Size;
+		Y = (Best / GRIDPLANNER_HEADINGS) / Size;
+		if ((X == ToX) && (Y == ToY))
+			return Cost[Best];
+
+		n = 0;
+		if (!GridPlanner_IsBlocked(X + StepX[Heading], Y + StepY[Heading]))
+		{
+			Next[n] = ((((Y + StepY[Heading]) * Size) + X + StepX[Heading]) * GRIDPLANNER_HEADINGS) + Heading;
+			Step[n++] = GRIDPLANNER_MOVE_COST;
+		}
+		if (!GridPlanner_IsBlocked(X - StepX[Heading], Y - StepY[Heading]))
+		{
+			Next[n] = ((((Y - StepY[Heading]) * Size) + X - StepX[Heading]) * GRIDPLANNER_HEADINGS) + Heading;
+			Step[n++] = GRIDPLANNER_MOVE_COST;
+		}
+		Next[n] = Best - Heading + ((Heading + 1) % GRIDPLANNER_HEADINGS);
+		Step[n++] = GRIDPLANNER_TURN_COST;
+		Next[n] = Best - Heading + ((Heading + 3) % GRIDPLANNER_HEADINGS);
+		Step[n++] = GRIDPLANNER_TURN_COST;
+
+		for (i = 0; i < n; ++i)
+		{
+			State = Next[i];
+			if (!Done[State] && ((Cost[Best] + Step[i]) < Cost[State]))
+				Cost[State] = Cost[Best] + Step[i];
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+int main(int argc, char *argv[])
+{
+	unsigned long Plans = (argc > 1) ? strtoul(argv[1], 0, 10) : PLANBENCH_PLANS;
+	unsigned Percent = (argc > 2) ? (unsigned)strtoul(argv[2], 0, 10) : PLANBENCH_BLOCKED;
+	GridPlanner_Plan_t Plan;
+	int Size;
+	int FromX;
+	int FromY;
+	int ToX;
+	int ToY;
+	int Heading;
+	unsigned long Found;
+	unsigned long TooLong;
+	unsigned long Expanded;
+	unsigned long MostExpanded;
+	unsigned long p;
+	uint32_t Cheapest;
+	uint8_t Planned;
+	double Start;
+	double Seconds;
+	double Slowest;
+
+	if ((Plans == 0) || (Percent > 60))
+	{
+		fprintf(stderr, "Usage: %s [plans per size] [percent blocked, up to 60]\n", argv[0]);
+		return 2;
+	}
+
+	printf("%-6s %8s %8s %10s %10s %10s %10s\n", "grid", "found", "too long", "us mean", "us max", "states", "states max");
+	for (Size = 4; Size <= GRIDPLANNER_MAX_WIDTH; Size += 2)
+	{
+		Found = 0;
+		TooLong = 0;
+		Expanded = 0;
+		MostExpanded = 0;
+		Seconds = 0;
+		Slowest = 0;
+
+		for (p = 0; p < Plans; ++p)
+		{
+			// A new map every 50 plans
+			if ((p % 50) == 0)
+				PlanBench_Map(Size, Percent);
+
+			PlanBench_OpenCell(Size, &FromX, &FromY);
+			PlanBench_OpenCell(Size, &ToX, &ToY);
+			Heading = (int)PlanBench_Random(GRIDPLANNER_HEADINGS);
+
+			Start = PlanBench_Seconds();
+			Planned = GridPlanner_Plan(FromX, FromY, (uint8_t)Heading, ToX, ToY, &Plan);
+			Start = PlanBench_Seconds() - Start;
+			Seconds += Start;
+			if (Start > Slowest)
+				Slowest = Start;
+
+			Expanded += Plan.Expanded;
+			if (Plan.Expanded > MostExpanded)
+				MostExpanded = Plan.Expanded;
+
+			if (p < PLANBENCH_CHECKED)
+			{
+				Cheapest = PlanBench_Cheapest(Size, FromX, FromY, Heading, ToX, ToY);
+				if (Planned && (Cheapest != Plan.Cost))
+				{
+					fprintf(stderr, "%dx%d: (%d, %d) to (%d, %d) cost %u, Dijkstra %u\n", Size, Size, FromX, FromY, ToX, ToY,
+						(unsigned)Plan.Cost, (unsigned)Cheapest);
+					return 1;
+				}
+				if (!Planned && (Plan.Cost == 0) && (Cheapest != PLANBENCH_FAR))
+				{
+					fprintf(stderr, "%dx%d: (%d, %d) to (%d, %d) not found, Dijkstra %u\n", Size, Size, FromX, FromY, ToX, ToY, (unsigned)Cheapest);
+					return 1;
+				}
+			}
+
+			// A way was found but has too many steps for the motor queue
+			if (!Planned && (Plan.Cost != 0))
+				++TooLong;
+			if (!Planned)
+				continue;
+			++Found;
+			if (PlanBench_Drive(&Plan, FromX, FromY, Heading, ToX, ToY) != Plan.Cost)
+			{
+				fprintf(stderr, "%dx%d: (%d, %d) to (%d, %d) does not drive as planned\n", Size, Size, FromX, FromY, ToX, ToY);
+				return 1;
+			}
+		}
+
+		printf("%2dx%-3d %8lu %8lu %10.2f %10.2f %10.1f %10lu\n", Size, Size, Found, TooLong, (Seconds * 1e6) / (double)Plans,
+			Slowest * 1e6, (double)Expanded / (double)Plans, MostExpanded);
+	}
+	return 0;
+}
@@ -0,0 +1,230 @@
+/**************************************************************************//**
+ *
+ * @file		tune2c.c
+ * @brief		Host tool: compile text tunes into Synth tune arrays for WavPlayer
+ * @version		1.0
+ *
+ * Usage:	tune2c [-n name] input.txt output.h
+ *
+ * The input is whitespace separated; a word starting with '#' begins a comment:
+ *
+ *		wave square			sine, square, saw or triangle
+ *		tick 60				length of one tick in ms
+ *		adsr 2 40 160 50	attack ms, decay ms, sustain (0-255), release ms
+ *		C5:2 E5 G5:4 -:2	notes (A-G, optional # or b, octave 0-9) or rests
+ *		loop				optional, repeats the notes instead of ending
+ *
+ * Notes and rests last one tick unless given a length after ':'. The output
+ * is two bytes per note plus a six byte header (see Synth.h), for
+ * WavPlayer_PlayTune.
+ *
+ * Build:	gcc -O2 -o tune2c tune2c.c WavTool.c
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "WavTool.h"
+#include "../Synth.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define TUNE2C_MAX_BYTES	4096			// Largest tune accepted
+#define TUNE2C_LINE			256
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static const char *WaveNames[] = {"sine", "square", "saw", "triangle"};
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// Parse "C#5:3", "Bb4", "-:2" or "r" into a note byte and a length in ticks
+static int ParseNote(const char *Token, uint8_t *Note, uint8_t *Ticks)
+{
+	static const int Semitones[7] = {9, 11, 0, 2, 4, 5, 7};	// A to G
+	const char *Length = strchr(Token, ':');
+	int Value;
+	int Octave;
+
+	*Ticks = 1;
+	if (Length != NULL)
+	{
+		Value = atoi(Length + 1);
+		if ((Value < 1) || (Value > 255))
+			return 0;
+		*Ticks = (uint8_t)Value;
+	}
+
+	if ((Token[0] == '-') || (tolower((unsigned char)Token[0]) == 'r'))
+	{
+		*Note = SYNTH_REST;
+		return 1;
+	}
+
+	if ((toupper((unsigned char)Token[0]) < 'A') || (toupper((unsigned char)Token[0]) > 'G'))
+		return 0;
+	Value = Semitones[toupper((unsigned char)Token[0]) - 'A'];
+	++Token;
+	if (*Token == '#')
+	{
+		++Value;
+		++Token;
+	}
+	else if (*Token == 'b')
+	{
+		--Value;
+		++Token;
+	}
+
+	if (!isdigit((unsigned char)*Token))
+		return 0;
+	Octave = *Token - '0';
+	Value += (Octave + 1) * 12;
+	if ((Value < 0) || (Value > 127))
+		return 0;
+	*Note = (uint8_t)Value;
+	return 1;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	static uint8_t Tune[TUNE2C_MAX_BYTES];
+	char Line[TUNE2C_LINE];
+	char Name[64] = "";
+	char *Token;
+	uint32_t Length = SYNTH_TUNE_HEADER;
+	uint32_t Notes = 0;
+	uint32_t Ticks = 0;
+	uint32_t LineNumber = 0;
+	uint8_t Loop = 0;
+	uint8_t Note;
+	uint8_t NoteTicks;
+	FILE *File;
+	int Arg = 1;
+	int i;
+
+	if ((argc > 2) && (strcmp(argv[1], "-n") == 0))
+	{
+		strncpy(Name, argv[2], sizeof(Name) - 1);
+		Arg = 3;
+	}
+	if (argc - Arg != 2)
+	{
+		fprintf(stderr, "usage: %s [-n name] input.txt output.h\n", argv[0]);
+		return 1;
+	}
+	if (Name[0] == '\0')
+		WavTool_NameFromPath(argv[Arg], Name, sizeof(Name));
+
+	File = fopen(argv[Arg], "r");
+	if (File == NULL)
+	{
+		fprintf(stderr, "%s: cannot read input\n", argv[Arg]);
+		return 1;
+	}
+
+	// Defaults: a plain sine with a short envelope
+	Tune[0] = SYNTH_SINE;
+	Tune[1] = 100;
+	Tune[2] = 5;
+	Tune[3] = 50;
+	Tune[4] = 200;
+	Tune[5] = 30;
+
+	while (fgets(Line, sizeof(Line), File) != NULL)
+	{
+		++LineNumber;
+
+		for (Token = strtok(Line, " \t\r\n"); Token != NULL; Token = strtok(NULL, " \t\r\n"))
+		{
+			// A comment runs to the end of the line (C#5 is a note, not a comment)
+			if (Token[0] == '#')
+				break;
+
+			if (strcmp(Token, "wave") == 0)
+			{
+				Token = strtok(NULL, " \t\r\n");
+				for (i = 0; (Token != NULL) && (i < 4); ++i)
+				{
+					if (strcmp(Token, WaveNames[i]) == 0)
+						break;
+				}
+				if ((Token == NULL) || (i == 4))
+				{
+					fprintf(stderr, "%s:%u: unknown waveform\n", argv[Arg], (unsigned)LineNumber);
+					return 1;
+				}
+				Tune[0] = (uint8_t)i;
+			}
+			else if ((strcmp(Token, "tick") == 0) || (strcmp(Token, "adsr") == 0))
+			{
+				int First = (Token[0] == 't') ? 1 : 2;
+				int Count = (Token[0] == 't') ? 1 : 4;
+				for (i = 0; i < Count; ++i)
+				{
+					Token = strtok(NULL, " \t\r\n");
+					if ((Token == NULL) || (atoi(Token) < 0) || (atoi(Token) > 255))
+					{
+						fprintf(stderr, "%s:%u: expected a value from 0 to 255\n", argv[Arg], (unsigned)LineNumber);
+						return 1;
+					}
+					Tune[First + i] = (uint8_t)atoi(Token);
+				}
+			}
+			else if (strcmp(Token, "loop") == 0)
+			{
+				Loop = 1;
+			}
+			else
+			{
+				if (!ParseNote(Token, &Note, &NoteTicks))
+				{
+					fprintf(stderr, "%s:%u: bad note '%s'\n", argv[Arg], (unsigned)LineNumber, Token);
+					return 1;
+				}
+				if (Length + 3 > TUNE2C_MAX_BYTES)
+				{
+					fprintf(stderr, "%s: tune too long\n", argv[Arg]);
+					return 1;
+				}
+				Tune[Length++] = Note;
+				Tune[Length++] = NoteTicks;
+				Ticks += NoteTicks;
+				++Notes;
+			}
+		}
+	}
+	fclose(File);
+
+	if (Notes == 0)
+	{
+		fprintf(stderr, "%s: no notes\n", argv[Arg]);
+		return 1;
+	}
+	Tune[Length++] = Loop ? SYNTH_LOOP : SYNTH_END;
+
+	File = fopen(argv[Arg + 1], "w");
+	if (File == NULL)
+	{
+		fprintf(stderr, "%s: cannot write output\n", argv[Arg + 1]);
+		return 1;
+	}
+
+	fprintf(File, "/*\n*\n*  %s - %s synth tune, %u notes, %u ms%s\n*  %u bytes (generated by tools/tune2c)\n*/\n\n",
+		Name, WaveNames[Tune[0]], (unsigned)Notes, (unsigned)(Ticks * Tune[1]), Loop ? ", looped" : "", (unsigned)Length);
+	WavTool_WriteArray(File, Name, Tune, Length);
+	fclose(File);
+
+	printf("%s: %u notes in %u bytes\n", Name, (unsigned)Notes, (unsigned)Length);
+	return 0;
+}
@@ -0,0 +1,355 @@
+/**************************************************************************//**
+ *
+ * @file		wav2c.c
+ * @brief		Host tool: compile WAV files into pre-parsed WavPlayer assets
+ * @version		1.0
+ *
+ * Usage:	wav2c [-r rate] [-f pcm8|adpcm] [-o dir] [-p playlist.h] input.wav ...
+ *
+ * Each input is mixed to mono, resampled to the target rate (default 12000 Hz)
+ * with a polyphase windowed-sinc filter and reduced to the output format:
+ *	pcm8	unsigned 8-bit with triangular (TPDF) dither
+ *	adpcm	4-bit IMA-ADPCM, as tools/adpcm2c
+ * For every input, dir/<name>.h holds the raw sample bytes (no RIFF header)
+ * and a WavFormat_Descriptor_t called <name>, ready for
+ * WavPlayer_PlayDescriptor, so the target never parses RIFF at run time.
+ * With -p, a playlist header including all of them is written as well.
+ *
+ * Build:	gcc -O2 -o wav2c wav2c.c ImaAdpcmEncoder.c WavTool.c ../ImaAdpcm.c ../WavFormat.c -lm
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ImaAdpcmEncoder.h"
+#include "WavTool.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define WAV2C_DEFAULT_RATE		12000
+#define WAV2C_TAPS_PER_PHASE	32			// Filter length at the lower of the input and output rates
+#define WAV2C_KAISER_BETA		8.0			// About 80 dB stopband
+#define WAV2C_CUTOFF			0.90		// Half-amplitude point as a fraction of the lower Nyquist rate
+#define WAV2C_MAX_INPUTS		64
+
+typedef enum {WAV2C_PCM8, WAV2C_ADPCM} Wav2c_Format_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static uint32_t DitherState = 0x12345678;	// Fixed seed so regenerated assets are identical
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+static uint32_t Gcd(uint32_t a, uint32_t b)
+{
+	while (b != 0)
+	{
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+// Zeroth order modified Bessel function, for the Kaiser window
+static double BesselI0(double x)
+{
+	double Sum = 1.0;
+	double Term = 1.0;
+	int k;
+
+	for (k = 1; k < 50; ++k)
+	{
+		Term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		Sum += Term;
+		if (Term < Sum * 1e-12)
+			break;
+	}
+	return Sum;
+}
+
+// Uniform in [0, 1), xorshift32
+static double Random(void)
+{
+	DitherState ^= DitherState << 13;
+	DitherState ^= DitherState >> 17;
+	DitherState ^= DitherState << 5;
+	return (double)DitherState / 4294967296.0;
+}
+
+// Resample by Up/Down with a polyphase FIR. Prototype filter runs at Up * input rate.
+// When decimating the filter is lengthened by Down/Up, so its transition band
+// is as narrow against the output's Nyquist rate as against the input's when
+// interpolating; otherwise everything just above the output's Nyquist rate aliases.
+static double* Resample(const int16_t *Input, uint32_t Count, uint32_t InRate, uint32_t OutRate, uint32_t *OutCount)
+{
+	uint32_t Divisor = Gcd(InRate, OutRate);
+	uint32_t Up = OutRate / Divisor;
+	uint32_t Down = InRate / Divisor;
+	uint32_t Decimation = (Down > Up) ? ((Down + Up - 1) / Up) : 1;
+	uint32_t Taps = WAV2C_TAPS_PER_PHASE * Decimation * Up;
+	double Cutoff = WAV2C_CUTOFF * 0.5 * ((InRate < OutRate) ? InRate : OutRate) / ((double)InRate * Up);
+	double Centre = (Taps - 1) / 2.0;
+	double *Filter;
+	double *Output;
+	uint32_t Outputs = (uint32_t)(((uint64_t)Count * Up) / Down);
+	uint32_t n;
+	uint32_t i;
+
+	Filter = malloc(Taps * sizeof(double));
+	Output = malloc(((size_t)Outputs + 1) * sizeof(double));
+	if ((Filter == NULL) || (Output == NULL))
+		return NULL;
+
+	// Kaiser windowed sinc, gain Up so each phase sums to about one
+	for (i = 0; i < Taps; ++i)
+	{
+		double x = i - Centre;
+		double Ratio = x / (Centre + 1.0);
+		double Sinc = (x == 0.0) ? 2.0 * Cutoff : sin(2.0 * M_PI * Cutoff * x) / (M_PI * x);
+		Filter[i] = Up * Sinc * BesselI0(WAV2C_KAISER_BETA * sqrt(1.0 - Ratio * Ratio)) / BesselI0(WAV2C_KAISER_BETA);
+	}
+
+	// Output n sits at Up-rate position n * Down; centre the filter on it
+	for (n = 0; n < Outputs; ++n)
+	{
+		uint64_t Position = ((uint64_t)n * Down) + (uint64_t)Centre;
+		uint32_t Phase = (uint32_t)(Position % Up);
+		int64_t Base = (int64_t)(Position / Up);
+		double Sum = 0.0;
+
+		for (i = Phase; i < Taps; i += Up)
+		{
+			int64_t k = Base - (int64_t)(i / Up);
+			if ((k >= 0) && (k < (int64_t)Count))
+				Sum += Filter[i] * Input[k];
+		}
+		Output[n] = Sum;
+	}
+
+	free(Filter);
+	*OutCount = Outputs;
+	return Output;
+}
+
+// Round to unsigned 8-bit with TPDF dither of one 8-bit LSB
+static uint8_t* DitherTo8(const double *Samples, uint32_t Count)
+{
+	uint8_t *Output = malloc(Count ? Count : 1);
+	uint32_t i;
+
+	if (Output == NULL)
+		return NULL;
+
+	for (i = 0; i < Count; ++i)
+	{
+		double Value = (Samples[i] / 256.0) + (Random() - Random()) + 128.0;
+		long Rounded = lround(Value);
+
+		if (Rounded < 0) Rounded = 0;
+		if (Rounded > 255) Rounded = 255;
+		Output[i] = (uint8_t)Rounded;
+	}
+	return Output;
+}
+
+static int16_t* Saturate16(const double *Samples, uint32_t Count)
+{
+	int16_t *Output = malloc((Count ? Count : 1) * sizeof(int16_t));
+	uint32_t i;
+
+	if (Output == NULL)
+		return NULL;
+
+	for (i = 0; i < Count; ++i)
+	{
+		long Rounded = lround(Samples[i]);
+
+		if (Rounded < -32768) Rounded = -32768;
+		if (Rounded > 32767) Rounded = 32767;
+		Output[i] = (int16_t)Rounded;
+	}
+	return Output;
+}
+
+// Convert one file, returning 0 on success
+static int Convert(const char *InputPath, const char *Directory, const char *Name, uint32_t Rate, Wav2c_Format_t Format)
+{
+	WavFormat_Descriptor_t Descriptor;
+	char OutputPath[512];
+	char DataName[80];
+	uint8_t *Input;
+	int16_t *Mono;
+	double *Resampled;
+	uint8_t *Data = NULL;
+	uint32_t InputLength;
+	uint32_t Count;
+	uint32_t Outputs;
+	uint32_t DataLength = 0;
+	FILE *File;
+
+	Input = WavTool_ReadFile(InputPath, &InputLength);
+	if ((Input == NULL) || !WavFormat_Parse(Input, InputLength, &Descriptor))
+	{
+		fprintf(stderr, "%s: not a readable WAV file\n", InputPath);
+		return 1;
+	}
+
+	Mono = WavTool_ToMono16(&Descriptor, &Count);
+	if ((Mono == NULL) || (Count == 0))
+	{
+		fprintf(stderr, "%s: only non-empty PCM input is supported\n", InputPath);
+		return 1;
+	}
+
+	Resampled = Resample(Mono, Count, Descriptor.SampleRate, Rate, &Outputs);
+	if ((Resampled == NULL) || (Outputs == 0))
+	{
+		fprintf(stderr, "%s: resampling failed\n", InputPath);
+		return 1;
+	}
+
+	if (Format == WAV2C_PCM8)
+	{
+		Data = DitherTo8(Resampled, Outputs);
+		DataLength = Outputs;
+	}
+	else
+	{
+		int16_t *Samples = Saturate16(Resampled, Outputs);
+		if (Samples != NULL)
+		{
+			DataLength = ImaAdpcmEncoder_Size(Outputs, IMAADPCMENCODER_BLOCK_ALIGN);
+			Data = malloc(DataLength);
+			if (Data != NULL)
+				ImaAdpcmEncoder_Encode(Samples, Outputs, IMAADPCMENCODER_BLOCK_ALIGN, Data);
+			free(Samples);
+		}
+	}
+
+	snprintf(OutputPath, sizeof(OutputPath), "%s/%s.h", Directory, Name);
+	snprintf(DataName, sizeof(DataName), "%sData", Name);
+	File = fopen(OutputPath, "w");
+	if ((Data == NULL) || (File == NULL))
+	{
+		fprintf(stderr, "%s: cannot write output\n", OutputPath);
+		return 1;
+	}
+
+	fprintf(File, "/*\n*\n*  %s - %s, mono, %u Hz\n*  %u samples in %u bytes (generated by tools/wav2c from %s)\n*/\n\n",
+		Name, (Format == WAV2C_PCM8) ? "8-bit PCM" : "IMA-ADPCM", (unsigned)Rate, (unsigned)Outputs, (unsigned)DataLength, InputPath);
+	fprintf(File, "#include \"WavFormat.h\"\n\n");
+	WavTool_WriteArray(File, DataName, Data, DataLength);
+	fprintf(File, "\nconst WavFormat_Descriptor_t %s = {\n", Name);
+	fprintf(File, "\t.Data = %s,\n", DataName);
+	fprintf(File, "\t.DataLength = sizeof(%s),\n", DataName);
+	fprintf(File, "\t.SampleRate = %u,\n", (unsigned)Rate);
+	if (Format == WAV2C_PCM8)
+	{
+		fprintf(File, "\t.Format = WAVFORMAT_PCM,\n");
+		fprintf(File, "\t.Channels = 1,\n");
+		fprintf(File, "\t.BitsPerSample = 8,\n");
+		fprintf(File, "\t.BlockAlign = 1,\n");
+	}
+	else
+	{
+		fprintf(File, "\t.Format = WAVFORMAT_IMA_ADPCM,\n");
+		fprintf(File, "\t.Channels = 1,\n");
+		fprintf(File, "\t.BitsPerSample = 4,\n");
+		fprintf(File, "\t.BlockAlign = %u,\n", IMAADPCMENCODER_BLOCK_ALIGN);
+	}
+	fprintf(File, "};\n");
+	fclose(File);
+
+	printf("%s: %u Hz x %u ch -> %u Hz mono, %u bytes\n", Name, (unsigned)Descriptor.SampleRate,
+		(unsigned)Descriptor.Channels, (unsigned)Rate, (unsigned)DataLength);
+
+	free(Data);
+	free(Resampled);
+	free(Mono);
+	free(Input);
+	return 0;
+}
+
+static int WritePlaylist(const char *Path, char Names[][64], int Count)
+{
+	char Name[64];
+	FILE *File = fopen(Path, "w");
+	int i;
+
+	if (File == NULL)
+	{
+		fprintf(stderr, "%s: cannot write playlist\n", Path);
+		return 1;
+	}
+
+	WavTool_NameFromPath(Path, Name, sizeof(Name));
+	fprintf(File, "/*\n*\n*  %s - %d tracks (generated by tools/wav2c)\n*/\n\n", Name, Count);
+	for (i = 0; i < Count; ++i)
+		fprintf(File, "#include \"%s.h\"\n", Names[i]);
+	fprintf(File, "\nconst WavFormat_Descriptor_t* const %s[] = {\n", Name);
+	for (i = 0; i < Count; ++i)
+		fprintf(File, "\t&%s,\n", Names[i]);
+	fprintf(File, "};\n\nconst uint32_t %sLength = %d;\n", Name, Count);
+	fclose(File);
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+	static char Names[WAV2C_MAX_INPUTS][64];
+	Wav2c_Format_t Format = WAV2C_PCM8;
+	const char *Directory = ".";
+	const char *Playlist = NULL;
+	uint32_t Rate = WAV2C_DEFAULT_RATE;
+	int Inputs = 0;
+	int Failures = 0;
+	int Arg;
+
+	for (Arg = 1; (Arg < argc) && (argv[Arg][0] == '-'); Arg += 2)
+	{
+		if (Arg + 1 >= argc)
+			break;
+		if (strcmp(argv[Arg], "-r") == 0)
+			Rate = (uint32_t)strtoul(argv[Arg + 1], NULL, 10);
+		else if (strcmp(argv[Arg], "-o") == 0)
+			Directory = argv[Arg + 1];
+		else if (strcmp(argv[Arg], "-p") == 0)
+			Playlist = argv[Arg + 1];
+		else if ((strcmp(argv[Arg], "-f") == 0) && (strcmp(argv[Arg + 1], "pcm8") == 0))
+			Format = WAV2C_PCM8;
+		else if ((strcmp(argv[Arg], "-f") == 0) && (strcmp(argv[Arg + 1], "adpcm") == 0))
+			Format = WAV2C_ADPCM;
+		else
+			break;
+	}
+
+	if ((Arg >= argc) || (Rate == 0) || (argc - Arg > WAV2C_MAX_INPUTS))
+	{
+		fprintf(stderr, "usage: %s [-r rate] [-f pcm8|adpcm] [-o dir] [-p playlist.h] input.wav ...\n", argv[0]);
+		return 1;
+	}
+
+	for (; Arg < argc; ++Arg)
+	{
+		WavTool_NameFromPath(argv[Arg], Names[Inputs], sizeof(Names[Inputs]));
+		if (Convert(argv[Arg], Directory, Names[Inputs], Rate, Format) == 0)
+			++Inputs;
+		else
+			++Failures;
+	}
+
+	if ((Playlist != NULL) && (Inputs > 0))
+		Failures += WritePlaylist(Playlist, Names, Inputs);
+
+	return (Failures == 0) ? 0 : 1;
+}
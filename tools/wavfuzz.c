@@ -0,0 +1,378 @@
+/**************************************************************************//**
+ *
+ * @file		wavfuzz.c
+ * @brief		Host tool: test WavFormat_Parse on the bundled assets and on damaged ones
+ * @version		1.0
+ *
+ * Usage:	wavfuzz [mutations]
+ *
+ * Parses the bundled cantina band clips and WavPlayer_Sample and checks the
+ * descriptors against what their headers say. Then it feeds the parser every
+ * truncation of each asset's header, hand-made files with the awkward
+ * layouts the parser promises to handle, and the given number of copies of
+ * each asset with random bytes of the header overwritten. Whatever the
+ * input, a descriptor that is accepted must describe data that lies inside
+ * the array and holds whole frames.
+ *
+ * Every input is copied into a buffer of exactly its length, so building
+ * with the sanitizers, as below, also catches any read past the end.
+ *
+ * Build:	gcc -O1 -g -fsanitize=address,undefined -o wavfuzz wavfuzz.c ../WavFormat.c
+ *
+******************************************************************************/
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../WavFormat.h"
+
+// Both cantina clips use the same names, so each is renamed as it is included
+#define cantinaBandSample					Cantina12kHz
+#define WavPlayer_CantinaBandSampleLenth	Cantina12kHzLength
+#include "../cantina_band_12kHz.h"
+#undef cantinaBandSample
+#undef WavPlayer_CantinaBandSampleLenth
+
+#define cantinaBandSample					Cantina24kHz
+#define WavPlayer_CantinaBandSampleLenth	Cantina24kHzLength
+#include "../cantina_band_24kHz.h"
+#undef cantinaBandSample
+#undef WavPlayer_CantinaBandSampleLenth
+
+#include "../WavPlayer_Sample.h"
+
+//------------------------------------------------------------------------------
+
+// Defines and typedefs
+#define WAVFUZZ_MUTATIONS		200000UL
+#define WAVFUZZ_HEADER			96				// Bytes at the front that truncation and mutation work on
+#define WAVFUZZ_BUILT			128				// Largest hand-made file
+
+typedef struct {
+	const char *Name;
+	const uint8_t *WavArray;
+	uint32_t Length;
+} WavFuzz_Asset_t;
+
+typedef struct {
+	const char *Name;
+	uint8_t Accept;								// Expected result of WavFormat_Parse
+	uint32_t DataOffset;						// Expected descriptor when accepted
+	uint32_t DataLength;
+} WavFuzz_Case_t;
+
+//------------------------------------------------------------------------------
+
+// Local variables
+static const WavFuzz_Asset_t Assets[] = {
+	{"cantina_band_12kHz", Cantina12kHz, sizeof(Cantina12kHz)},
+	{"cantina_band_24kHz", Cantina24kHz, sizeof(Cantina24kHz)},
+	{"WavPlayer_Sample", WavPlayer_Sample, sizeof(WavPlayer_Sample)},
+};
+
+static uint32_t Seed = 12345;
+static unsigned long Failures = 0;
+
+//------------------------------------------------------------------------------
+
+// Local Functions
+
+// A fixed generator, so every run makes the same inputs
+static uint32_t WavFuzz_Random(uint32_t Range)
+{
+	Seed = (Seed * 1103515245UL) + 12345UL;
+	return ((Seed >> 8) & 0xFFFFFF) % Range;
+}
+
+static uint32_t WavFuzz_ReadU32(const uint8_t *Bytes)
+{
+	return ((uint32_t)Bytes[0] | ((uint32_t)Bytes[1] << 8) | ((uint32_t)Bytes[2] << 16) | ((uint32_t)Bytes[3] << 24));
+}
+
+static uint8_t *WavFuzz_PutU32(uint8_t *Bytes, uint32_t Value)
+{
+	Bytes[0] = (uint8_t)Value;
+	Bytes[1] = (uint8_t)(Value >> 8);
+	Bytes[2] = (uint8_t)(Value >> 16);
+	Bytes[3] = (uint8_t)(Value >> 24);
+	return Bytes + 4;
+}
+
+static uint8_t *WavFuzz_PutU16(uint8_t *Bytes, uint16_t Value)
+{
+	Bytes[0] = (uint8_t)Value;
+	Bytes[1] = (uint8_t)(Value >> 8);
+	return Bytes + 2;
+}
+
+static uint8_t *WavFuzz_PutChunk(uint8_t *Bytes, const char *ID, uint32_t Size)
+{
+	memcpy(Bytes, ID, 4);
+	return WavFuzz_PutU32(Bytes + 4, Size);
+}
+
+static void WavFuzz_Fail(const char *Name, const char *Format, unsigned long Value)
+{
+	fprintf(stderr, "%s: ", Name);
+	fprintf(stderr, Format, Value);
+	fputc('\n', stderr);
+	++Failures;
+}
+
+// Parse a copy of exactly Length bytes, checking what any accepted descriptor says
+static uint8_t WavFuzz_Parse(const char *Name, const uint8_t *WavArray, uint32_t Length, WavFormat_Descriptor_t *Descriptor)
+{
+	uint8_t *Copy = malloc(Length ? Length : 1);
+	uint32_t Offset;
+	uint8_t Accepted;
+
+	memcpy(Copy, WavArray, Length);
+	memset(Descriptor, 0, sizeof(*Descriptor));
+	Accepted = WavFormat_Parse(Copy, Length, Descriptor);
+
+	if (Accepted)
+	{
+		Offset = (uint32_t)(Descriptor->Data - Copy);
+		if ((Descriptor->Data < Copy) || (Offset > Length) || (Descriptor->DataLength > Length - Offset))
+			WavFuzz_Fail(Name, "data outside the %lu byte array", Length);
+		if ((Descriptor->Channels == 0) || (Descriptor->SampleRate == 0) || (Descriptor->BlockAlign == 0))
+			WavFuzz_Fail(Name, "accepted with a zero field, format %lu", Descriptor->Format);
+		if ((Descriptor->Format == WAVFORMAT_PCM) && ((Descriptor->DataLength % Descriptor->BlockAlign) != 0))
+			WavFuzz_Fail(Name, "PCM data of %lu bytes is not whole frames", Descriptor->DataLength);
+
+		// Keep the offset rather than a pointer into the copy about to be freed
+		Descriptor->Data = WavArray + Offset;
+	}
+	free(Copy);
+	return Accepted;
+}
+
+// Build a small file, returning its length. Layout is one of the cases below.
+static uint32_t WavFuzz_Build(uint8_t *Bytes, uint8_t Layout)
+{
+	uint8_t *Next = Bytes + 12;
+	uint32_t i;
+
+	switch (Layout)
+	{
+		case 0:
+		case 1:
+		case 2:
+		case 3:
+		case 4:
+			// 0: plain 16 byte fmt; 1: 18 bytes with cbSize; 2: a LIST chunk of odd
+			// size before data; 3: data declared longer than the file;
+			// 4: 8-bit stereo data of an odd length
+			Next = WavFuzz_PutChunk(Next, "fmt ", (Layout == 1) ? 18 : 16);
+			Next = WavFuzz_PutU16(Next, WAVFORMAT_PCM);
+			Next = WavFuzz_PutU16(Next, (Layout == 4) ? 2 : 1);
+			Next = WavFuzz_PutU32(Next, 12000);
+			Next = WavFuzz_PutU32(Next, (Layout == 4) ? 24000 : 12000);
+			Next = WavFuzz_PutU16(Next, (Layout == 4) ? 2 : 1);
+			Next = WavFuzz_PutU16(Next, 8);
+			if (Layout == 1)
+				Next = WavFuzz_PutU16(Next, 0);
+			if (Layout == 2)
+			{
+				Next = WavFuzz_PutChunk(Next, "LIST", 5);
+				memcpy(Next, "INFOx", 5);
+				Next += 6;
+			}
+			Next = WavFuzz_PutChunk(Next, "data", (Layout == 3) ? 1000 : ((Layout == 4) ? 31 : 32));
+			for (i = 0; i < 32; ++i)
+				*Next++ = (uint8_t)(128 + i);
+			break;
+		case 5:
+			// 18 byte fmt declared but only the 16 PCM bytes stored, as WavPlayer_Sample does
+			Next = WavFuzz_PutChunk(Next, "fmt ", 18);
+			Next = WavFuzz_PutU16(Next, WAVFORMAT_PCM);
+			Next = WavFuzz_PutU16(Next, 1);
+			Next = WavFuzz_PutU32(Next, 8000);
+			Next = WavFuzz_PutU32(Next, 16000);
+			Next = WavFuzz_PutU16(Next, 2);
+			Next = WavFuzz_PutU16(Next, 16);
+			Next = WavFuzz_PutChunk(Next, "data", 32);
+			for (i = 0; i < 32; ++i)
+				*Next++ = (uint8_t)i;
+			break;
+		case 6:
+			// data before fmt
+			Next = WavFuzz_PutChunk(Next, "data", 4);
+			Next = WavFuzz_PutU32(Next, 0);
+			Next = WavFuzz_PutChunk(Next, "fmt ", 16);
+			Next = WavFuzz_PutU16(Next, WAVFORMAT_PCM);
+			Next = WavFuzz_PutU16(Next, 1);
+			Next = WavFuzz_PutU32(Next, 12000);
+			Next = WavFuzz_PutU32(Next, 12000);
+			Next = WavFuzz_PutU16(Next, 1);
+			Next = WavFuzz_PutU16(Next, 8);
+			break;
+		case 7:
+			// A chunk size that would wrap the walk round
+			Next = WavFuzz_PutChunk(Next, "JUNK", 0xFFFFFFF8UL);
+			Next = WavFuzz_PutU32(Next, 0);
+			break;
+		default:
+			// 12-bit PCM
+			Next = WavFuzz_PutChunk(Next, "fmt ", 16);
+			Next = WavFuzz_PutU16(Next, WAVFORMAT_PCM);
+			Next = WavFuzz_PutU16(Next, 1);
+			Next = WavFuzz_PutU32(Next, 12000);
+			Next = WavFuzz_PutU32(Next, 18000);
+			Next = WavFuzz_PutU16(Next, 2);
+			Next = WavFuzz_PutU16(Next, 12);
+			Next = WavFuzz_PutChunk(Next, "data", 4);
+			Next = WavFuzz_PutU32(Next, 0);
+			break;
+	}
+
+	memcpy(Bytes, "RIFF", 4);
+	WavFuzz_PutU32(Bytes + 4, (uint32_t)(Next - Bytes) - 8);
+	memcpy(Bytes + 8, "WAVE", 4);
+	return (uint32_t)(Next - Bytes);
+}
+
+//------------------------------------------------------------------------------
+
+// Public Functions
+int main(int argc, char *argv[])
+{
+	static const WavFuzz_Case_t Cases[] = {
+		{"16 byte fmt",					1, 44, 32},
+		{"18 byte fmt with cbSize",		1, 46, 32},
+		{"odd LIST chunk",				1, 58, 32},
+		{"data past the end",			1, 44, 32},
+		{"odd stereo data",				1, 44, 30},
+		{"18 byte fmt stored short",	1, 44, 32},
+		{"data before fmt",				0, 0, 0},
+		{"wrapping chunk size",			0, 0, 0},
+		{"12-bit PCM",					0, 0, 0},
+	};
+	unsigned long Mutations = (argc > 1) ? strtoul(argv[1], 0, 10) : WAVFUZZ_MUTATIONS;
+	uint8_t Built[WAVFUZZ_BUILT];
+	uint8_t Header[WAVFUZZ_HEADER];
+	WavFormat_Descriptor_t Descriptor;
+	WavFormat_Descriptor_t Whole;
+	const WavFuzz_Asset_t *Asset;
+	unsigned long Accepted;
+	unsigned long m;
+	uint32_t Length;
+	uint32_t Shortest;
+	uint32_t Offset;
+	uint32_t Bytes;
+	uint32_t a;
+	uint32_t i;
+
+	// The bundled assets, with what their own headers say
+	printf("%-20s %6s %6s %4s %4s %5s %8s %8s\n", "asset", "format", "rate", "ch", "bits", "align", "offset", "data");
+	for (a = 0; a < sizeof(Assets) / sizeof(Assets[0]); ++a)
+	{
+		Asset = &Assets[a];
+		if (!WavFuzz_Parse(Asset->Name, Asset->WavArray, Asset->Length, &Whole))
+		{
+			WavFuzz_Fail(Asset->Name, "rejected, %lu bytes", Asset->Length);
+			continue;
+		}
+		Offset = (uint32_t)(Whole.Data - Asset->WavArray);
+		printf("%-20s %6u %6u %4u %4u %5u %8u %8u\n", Asset->Name, (unsigned)Whole.Format, (unsigned)Whole.SampleRate,
+			(unsigned)Whole.Channels, (unsigned)Whole.BitsPerSample, (unsigned)Whole.BlockAlign, (unsigned)Offset, (unsigned)Whole.DataLength);
+
+		if (Whole.SampleRate != WavFuzz_ReadU32(&Asset->WavArray[24]))
+			WavFuzz_Fail(Asset->Name, "sample rate %lu does not match the header", Whole.SampleRate);
+		if ((Whole.Format != WAVFORMAT_PCM) || (Whole.BlockAlign != Whole.Channels * (Whole.BitsPerSample / 8)))
+			WavFuzz_Fail(Asset->Name, "block align %lu does not match the PCM fields", Whole.BlockAlign);
+		if (memcmp(Whole.Data - 8, "data", 4) != 0)
+			WavFuzz_Fail(Asset->Name, "data at offset %lu is not after a data chunk ID", Offset);
+
+		// Every truncation of the header and of the first data: rejected, or still inside the shorter array
+		Accepted = 0;
+		Shortest = 0;
+		for (Length = 0; (Length < Offset + WAVFUZZ_HEADER) && (Length <= Asset->Length); ++Length)
+		{
+			if (!WavFuzz_Parse(Asset->Name, Asset->WavArray, Length, &Descriptor))
+				continue;
+			if (Accepted++ == 0)
+				Shortest = Length;
+			if ((Descriptor.Data != Whole.Data) || (Descriptor.Format != Whole.Format))
+				WavFuzz_Fail(Asset->Name, "truncated to %lu bytes it parses differently", Length);
+		}
+		printf("  %lu of %u truncations accepted, the shortest %u bytes\n", Accepted, (unsigned)Length, (unsigned)Shortest);
+	}
+
+	// Hand-made layouts
+	for (i = 0; i < sizeof(Cases) / sizeof(Cases[0]); ++i)
+	{
+		Length = WavFuzz_Build(Built, (uint8_t)i);
+		if (WavFuzz_Parse(Cases[i].Name, Built, Length, &Descriptor) != Cases[i].Accept)
+		{
+			WavFuzz_Fail(Cases[i].Name, "expected a result of %lu", (unsigned long)Cases[i].Accept);
+			continue;
+		}
+		if (Cases[i].Accept && (((uint32_t)(Descriptor.Data - Built) != Cases[i].DataOffset) || (Descriptor.DataLength != Cases[i].DataLength)))
+			WavFuzz_Fail(Cases[i].Name, "data found at offset %lu", (unsigned long)(Descriptor.Data - Built));
+	}
+	printf("%u hand-made layouts checked\n", (unsigned)(sizeof(Cases) / sizeof(Cases[0])));
+
+	// Random bytes over each asset's header, at its full length and cut short
+	for (a = 0; a < sizeof(Assets) / sizeof(Assets[0]); ++a)
+	{
+		Asset = &Assets[a];
+		Accepted = 0;
+		for (m = 0; m < Mutations; ++m)
+		{
+			memcpy(Header, Asset->WavArray, WAVFUZZ_HEADER);
+			Bytes = 1 + WavFuzz_Random(4);
+			for (i = 0; i < Bytes; ++i)
+				Header[WavFuzz_Random(WAVFUZZ_HEADER)] = (uint8_t)WavFuzz_Random(256);
+
+			// Half the time the whole header, half the time cut short as well
+			Length = (m & 1) ? WavFuzz_Random(WAVFUZZ_HEADER + 1) : WAVFUZZ_HEADER;
+			Accepted += WavFuzz_Parse(Asset->Name, Header, Length, &Descriptor);
+		}
+		printf("%-20s %lu mutations, %lu accepted\n", Asset->Name, Mutations, Accepted);
+	}
+
+	// Chunks of random size and content after RIFF....WAVE, mostly with the IDs the parser looks for
+	Accepted = 0;
+	for (m = 0; m < Mutations; ++m)
+	{
+		Length = 12 + WavFuzz_Random(WAVFUZZ_BUILT - 11);
+		for (i = 0; i < Length; ++i)
+			Built[i] = (uint8_t)WavFuzz_Random(256);
+		memcpy(Built, "RIFF", 4);
+		memcpy(Built + 8, "WAVE", 4);
+		for (i = 12; i + 8 <= Length; i += 8 + Bytes + (Bytes & 1))
+		{
+			Bytes = WavFuzz_Random(8) ? WavFuzz_Random(24) : WavFuzz_ReadU32(&Built[i + 4]);
+			switch (WavFuzz_Random(4))
+			{
+				case 0:		memcpy(&Built[i], "fmt ", 4);	break;
+				case 1:		memcpy(&Built[i], "data", 4);	break;
+				case 2:		memcpy(&Built[i], "LIST", 4);	break;
+				default:	break;
+			}
+			WavFuzz_PutU32(&Built[i + 4], Bytes);
+			// A PCM format code and a size it takes, often enough for data chunks to be reached
+			if ((memcmp(&Built[i], "fmt ", 4) == 0) && (i + 24 <= Length) && WavFuzz_Random(2))
+			{
+				WavFuzz_PutU16(&Built[i + 8], WAVFORMAT_PCM);
+				WavFuzz_PutU16(&Built[i + 22], WavFuzz_Random(2) ? 8 : 16);
+			}
+			if (Bytes > Length)
+				break;
+		}
+		Accepted += WavFuzz_Parse("random", Built, Length, &Descriptor);
+	}
+	printf("%-20s %lu files, %lu accepted\n", "random", Mutations, Accepted);
+
+	if (Failures != 0)
+	{
+		printf("%lu failures\n", Failures);
+		return 1;
+	}
+	printf("All passed\n");
+	return 0;
+}